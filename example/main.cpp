@@ -11,6 +11,7 @@
 
 #include "analytic.h"
 #include "derivative.h"
+#include "antiderivative.h"
 
 #define trace()
 class arbitrary_functor : public math::function<double(double, double)> {
@@ -70,6 +71,13 @@ int main(int argc, const char * argv[])
 		<< "    " << D<multiply<rational<3,2>, x, complex<3,1,1,1>, x, x, x, exp<y>, sin<z>, exp<x>>, x>() << std::endl << std::endl
 	;
 	
+	std::cout
+		<< "EXACT COMPILE TIME INTEGRATION" << std::endl
+		<< "    " << integral<multiply<x, exp<multiply<rational<2>, x>>>, x>() << std::endl
+		<< "    " << integral<multiply<pow<x,rational<2>>, sin<x>, exp<y>>, x>() << std::endl
+		<< "    " << integral<multiply<exp<x>, cos<multiply<rational<3>, x>>>, x>() << std::endl << std::endl
+	;
+	
 	std::cout
 		<< "MIXING ARBITRARY FUNCTORS WITH COMPILE TIME ANALYTIC FUNCTORS" << std::endl
 		<< "    " << multiply<add<x,x,x>, arbitrary_functor>() << std::endl
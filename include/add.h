@@ -9,6 +9,7 @@
 #ifndef math_add_h
 #define math_add_h
 
+#include <type_traits>
 #include <pat/tmp.h>
 #include <pat/tuple.h>
 #include "setup.h"
@@ -100,48 +101,46 @@ namespace math {
 			};
 			
 			// SIMPLIFY
-			template <std::intmax_t N1, std::intmax_t D1, std::intmax_t iN1, std::intmax_t iD1,
-			          std::intmax_t N2, std::intmax_t D2, std::intmax_t iN2, std::intmax_t iD2>
-			struct __add<complex<N1,D1,iN1,iD1>, complex<N2,D2,iN2,iD2>, ap_simplify> {
-				typedef complex_add<complex<N1,D1,iN1,iD1>, complex<N2,D2,iN2,iD2>> type;
-			};
+			// like terms c1 T + c2 T, where a term without a leading complex number has coefficient 1.
 			template <typename T>
-			struct __add<T, T, ap_simplify> {
-				typedef multiply<rational<2>, T> type;
-			};
-			template <typename T, typename U>
-			struct __add<T, ___add<T, U>, ap_simplify> {
-				typedef add<multiply<rational<2>, T>, U> type;
+			struct _add_term {
+				typedef rational<1> coefficient;
+				typedef T rest;
 			};
 			template <std::intmax_t N1, std::intmax_t D1, std::intmax_t iN1, std::intmax_t iD1, typename T>
-			struct __add<T, ___multiply<complex<N1,D1,iN1,iD1>,T>, ap_simplify> {
-				typedef multiply<complex_add<complex<N1,D1,iN1,iD1>,rational<1>>, T> type;
-			};
-			template <std::intmax_t N1, std::intmax_t D1, std::intmax_t iN1, std::intmax_t iD1, typename T, typename U>
-			struct __add<T, ___add<___multiply<complex<N1,D1,iN1,iD1>,T>, U>, ap_simplify> {
-				typedef add<multiply<complex_add<complex<N1,D1,iN1,iD1>,rational<1>>, T>, U> type;
-			};
-			template <std::intmax_t N1, std::intmax_t D1, std::intmax_t iN1, std::intmax_t iD1, typename T>
-			struct __add<___multiply<complex<N1,D1,iN1,iD1>,T>, T, ap_simplify> {
-				typedef multiply<complex_add<complex<N1,D1,iN1,iD1>,rational<1>>, T> type;
-			};
-			template <std::intmax_t N1, std::intmax_t D1, std::intmax_t iN1, std::intmax_t iD1, typename T, typename U>
-			struct __add<___multiply<complex<N1,D1,iN1,iD1>,T>, ___add<T, U>, ap_simplify> {
-				typedef add<multiply<complex_add<complex<N1,D1,iN1,iD1>,rational<1>>, T>, U> type;
+			struct _add_term<___multiply<complex<N1,D1,iN1,iD1>,T>> {
+				typedef complex<N1,D1,iN1,iD1> coefficient;
+				typedef T rest;
 			};
+			
+			template <typename T, typename U>
+			using _add_like = std::integral_constant<bool,
+				!is_complex<T>::value && std::is_same<typename _add_term<T>::rest, typename _add_term<U>::rest>::value
+			>;
+			
+			template <typename T, typename U>
+			using _add_like_sum = multiply<complex_add<typename _add_term<T>::coefficient, typename _add_term<U>::coefficient>, typename _add_term<T>::rest>;
+			
+			template <typename T, typename U, typename = void>
+			struct _add_simplify { };
+			
 			template <std::intmax_t N1, std::intmax_t D1, std::intmax_t iN1, std::intmax_t iD1,
-					  std::intmax_t N2, std::intmax_t D2, std::intmax_t iN2, std::intmax_t iD2,
-					  typename T>
-			struct __add<___multiply<complex<N1,D1,iN1,iD1>,T>, ___multiply<complex<N2,D2,iN2,iD2>,T>, ap_simplify> {
-				typedef multiply<complex_add<complex<N1,D1,iN1,iD1>,rational<1>>, T> type;
+			          std::intmax_t N2, std::intmax_t D2, std::intmax_t iN2, std::intmax_t iD2>
+			struct _add_simplify<complex<N1,D1,iN1,iD1>, complex<N2,D2,iN2,iD2>> {
+				typedef complex_add<complex<N1,D1,iN1,iD1>, complex<N2,D2,iN2,iD2>> type;
 			};
-			template <std::intmax_t N1, std::intmax_t D1, std::intmax_t iN1, std::intmax_t iD1,
-					  std::intmax_t N2, std::intmax_t D2, std::intmax_t iN2, std::intmax_t iD2,
-					  typename T, typename U>
-			struct __add<___multiply<complex<N1,D1,iN1,iD1>,T>, ___add<___multiply<complex<N2,D2,iN2,iD2>,T>, U>, ap_simplify> {
-				typedef multiply<complex_add<complex<N1,D1,iN1,iD1>,rational<1>>, T> type;
+			template <typename T, typename U>
+			struct _add_simplify<T, U, typename std::enable_if<_add_like<T, U>::value>::type> {
+				typedef _add_like_sum<T, U> type;
+			};
+			template <typename T, typename U, typename V>
+			struct _add_simplify<T, ___add<U, V>, typename std::enable_if<_add_like<T, U>::value>::type> {
+				typedef add<_add_like_sum<T, U>, V> type;
 			};
 			
+			template <typename T, typename U>
+			struct __add<T, U, ap_simplify> : _add_simplify<T, U> { };
+			
 			// SORTER STRUCT, USED FOR SORTING STAGE BELOW!
 			template <typename T1, typename T2, int S>
 			struct __add_sorter {
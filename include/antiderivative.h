@@ -0,0 +1,396 @@
+//
+//  antiderivative.h
+//  math
+//
+//  Created by Patrick Sauter on 10/19/26.
+//  Copyright (c) 2026 Patrick Sauter. All rights reserved.
+//
+
+#ifndef math_antiderivative_h
+#define math_antiderivative_h
+
+// compile time indefinite integrals of analytic functors, the counterpart of D<F, dx> in derivative.h
+//
+//		integral<multiply<x, exp<multiply<rational<2>, x>>>, x>
+//
+// is ((1/2) * x * exp(2x) - (1/4) * exp(2x)), worked out and simplified entirely at compile time.
+// not everything has a closed form, and we only know the common patterns:
+//	- anything not depending on dx, and dx itself
+//	- sums, and products with factors not depending on dx
+//	- powers, exp, ln, sin and cos of a linear function of dx, and single argument compositions of a linear function
+//	- products of sin and cos (rewritten as sums), and exp times sin or cos
+//	- polynomials times any of the above, by parts, and x^n ln(x)
+// has_integral<F, dx> says whether integral<F, dx> exists, so callers can fall back to numeric integration.
+//
+// like D, the rules are partial specializations of __I at different priorities.  _I tries them from the
+// highest priority down and takes the first one that applies.  a rule only applies if the integrals it
+// is built from exist, so a missing closed form is a substitution failure rather than a compile error.
+// the rules look for those with integral<> itself, never with has_integral<>.  has_integral<T> is fixed
+// the first time it is asked for, and asking while _I<T> is still being worked out would fix it at false.
+
+#include <cstdint>
+#include <type_traits>
+
+#include "analytic.h"
+#include "derivative.h"
+#include "dependency.h"
+
+namespace math {
+	namespace analytic {
+		namespace detail {
+			constexpr int integral_max_stage		= 8;
+			constexpr int integral_constant_stage	= integral_max_stage;
+			constexpr int integral_linear_stage		= integral_constant_stage - 1;
+			constexpr int integral_factor_stage		= integral_linear_stage - 1;
+			constexpr int integral_function_stage	= integral_factor_stage - 1;
+			constexpr int integral_product_stage	= integral_function_stage - 1;
+			constexpr int integral_parts_stage		= integral_product_stage - 1;
+			constexpr int integral_rewrite_stage	= integral_parts_stage - 1;
+			
+			template <typename...>
+			struct _void { typedef void type; };
+			
+			template <typename T, typename dx, int Stage, typename = void>
+			struct __I;
+			
+			template <typename T, typename dx, int Stage, typename = void>
+			struct _I : _I<T, dx, Stage - 1> { };
+			
+			template <typename T, typename dx, int Stage>
+			struct _I<T, dx, Stage, typename _void<typename __I<T, dx, Stage>::type>::type> : __I<T, dx, Stage> { };
+			
+			// ran out of rules, no closed form.
+			template <typename T, typename dx>
+			struct _I<T, dx, 0> { };
+			
+			template <typename T, typename dx, typename = void>
+			struct _has_integral : std::false_type { };
+			
+			template <typename T, typename dx>
+			struct _has_integral<T, dx, typename _void<typename _I<T, dx, integral_max_stage>::type>::type> : std::true_type { };
+			
+			template <typename T, std::uint64_t Mask, typename = void>
+			struct _antiderivative { };
+			
+			template <typename T, std::uint64_t Mask, typename = void>
+			struct _has_antiderivative : std::false_type { };
+		}
+		
+		template <typename T, typename dx>
+		using integral = typename detail::_I<T, dx, detail::integral_max_stage>::type;
+		
+		template <typename T, typename dx>
+		using has_integral = detail::_has_integral<T, dx>;
+		
+		// integrated once in each argument whose bit is set in Mask
+		template <typename T, std::uint64_t Mask>
+		using antiderivative = typename detail::_antiderivative<T, Mask>::type;
+		
+		template <typename T, std::uint64_t Mask>
+		using has_antiderivative = detail::_has_antiderivative<T, Mask>;
+		
+		namespace detail {
+			// U = a * dx + b for constants a != 0 and b
+			template <typename U, typename dx, typename = void>
+			struct _linear : std::false_type { };
+			
+			template <typename U, std::size_t A>
+			struct _linear<U, pat::select<A>, typename std::enable_if<depends_on<U, A>::value && is_complex<D<U, pat::select<A>>>::value>::type> : std::true_type {
+				typedef D<U, pat::select<A>>	slope;
+			};
+			
+			template <typename U, typename dx>
+			using slope_inverse = complex_divide<rational<1>, typename _linear<U, dx>::slope>;
+			
+			// dx or dx^n for a positive integer n, the part of a product we differentiate when integrating by parts
+			template <typename P, typename dx>
+			struct _monomial : std::false_type { };
+			
+			template <std::size_t A>
+			struct _monomial<pat::select<A>, pat::select<A>> : std::true_type { };
+			
+			template <std::size_t A, std::intmax_t N, std::intmax_t iD>
+			struct _monomial<___pow<pat::select<A>, complex<N, 1, 0, iD>>, pat::select<A>> : std::integral_constant<bool, (N > 0)> { };
+			
+			// the other part, functions whose integrals don't get any harder to integrate again
+			template <typename G, typename dx>
+			struct _parts_friendly : std::false_type { };
+			
+			template <typename U, typename dx>
+			struct _parts_friendly<__exp<U>, dx> : _linear<U, dx> { };
+			template <typename U, typename dx>
+			struct _parts_friendly<__sin<U>, dx> : _linear<U, dx> { };
+			template <typename U, typename dx>
+			struct _parts_friendly<__cos<U>, dx> : _linear<U, dx> { };
+			
+			template <typename U, typename V, typename dx>
+			struct _parts_friendly<___multiply<__exp<U>, __sin<V>>, dx> : std::integral_constant<bool, _linear<U, dx>::value && _linear<V, dx>::value> { };
+			template <typename U, typename V, typename dx>
+			struct _parts_friendly<___multiply<__exp<U>, __cos<V>>, dx> : std::integral_constant<bool, _linear<U, dx>::value && _linear<V, dx>::value> { };
+			
+			
+			
+			// CONSTANTS, ANYTHING NOT DEPENDING ON dx
+			template <typename T, std::size_t A>
+			struct __I<T, pat::select<A>, integral_constant_stage, typename std::enable_if<!depends_on<T, A>::value>::type> {
+				typedef multiply<T, pat::select<A>> type;
+			};
+			
+			// LINEARITY
+			template <typename F, typename G, typename dx>
+			struct __I<___add<F,G>, dx, integral_linear_stage, typename _void<integral<F, dx>, integral<G, dx>>::type> {
+				typedef add<integral<F, dx>, integral<G, dx>> type;
+			};
+			
+			// the factors of a product that don't depend on dx come out front
+			template <typename T, std::size_t A>
+			struct _split {
+				typedef typename std::conditional<depends_on<T, A>::value, rational<1>, T>::type	constant;
+				typedef typename std::conditional<depends_on<T, A>::value, T, rational<1>>::type	variable;
+			};
+			template <typename F, typename G, std::size_t A>
+			struct _split<___multiply<F,G>, A> {
+				typedef multiply<typename _split<F, A>::constant, typename _split<G, A>::constant>	constant;
+				typedef multiply<typename _split<F, A>::variable, typename _split<G, A>::variable>	variable;
+			};
+			
+			template <typename C, typename V, typename dx, typename = void>
+			struct _constant_times { };
+			
+			template <typename C, typename V, typename dx>
+			struct _constant_times<C, V, dx, typename _void<integral<V, dx>>::type> {
+				typedef multiply<C, integral<V, dx>> type;
+			};
+			
+			// only when there is a constant, otherwise the variable part is the product itself
+			template <typename F, typename G, std::size_t A>
+			struct __I<___multiply<F,G>, pat::select<A>, integral_factor_stage, typename std::enable_if<
+				!std::is_same<typename _split<___multiply<F,G>, A>::constant, rational<1>>::value
+			>::type> : _constant_times<
+				typename _split<___multiply<F,G>, A>::constant,
+				typename _split<___multiply<F,G>, A>::variable,
+				pat::select<A>
+			> { };
+			
+			// FUNCTIONS OF A LINEAR ARGUMENT, x included
+			template <std::size_t A>
+			struct __I<pat::select<A>, pat::select<A>, integral_function_stage> {
+				typedef multiply<rational<1,2>, pow<pat::select<A>, rational<2>>> type;
+			};
+			
+			template <typename U, typename N, typename dx>
+			struct __I<___pow<U, N>, dx, integral_function_stage, typename std::enable_if<
+				_linear<U, dx>::value && is_complex<N>::value && !std::is_same<complex_add<N, rational<1>>, rational<0>>::value
+			>::type> {
+				typedef multiply<slope_inverse<U, dx>, complex_divide<rational<1>, complex_add<N, rational<1>>>, pow<U, complex_add<N, rational<1>>>> type;
+			};
+			
+			template <typename U, typename N, typename dx>
+			struct __I<___pow<U, N>, dx, integral_function_stage, typename std::enable_if<
+				_linear<U, dx>::value && is_complex<N>::value && std::is_same<complex_add<N, rational<1>>, rational<0>>::value
+			>::type> {
+				typedef multiply<slope_inverse<U, dx>, ln<U>> type;
+			};
+			
+			template <typename U, typename dx>
+			struct __I<__exp<U>, dx, integral_function_stage, typename std::enable_if<_linear<U, dx>::value>::type> {
+				typedef multiply<slope_inverse<U, dx>, exp<U>> type;
+			};
+			
+			template <typename U, typename dx>
+			struct __I<__ln<U>, dx, integral_function_stage, typename std::enable_if<_linear<U, dx>::value>::type> {
+				typedef multiply<slope_inverse<U, dx>, sub<multiply<U, ln<U>>, U>> type;
+			};
+			
+			template <typename U, typename dx>
+			struct __I<__sin<U>, dx, integral_function_stage, typename std::enable_if<_linear<U, dx>::value>::type> {
+				typedef multiply<rational<-1>, slope_inverse<U, dx>, cos<U>> type;
+			};
+			
+			template <typename U, typename dx>
+			struct __I<__cos<U>, dx, integral_function_stage, typename std::enable_if<_linear<U, dx>::value>::type> {
+				typedef multiply<slope_inverse<U, dx>, sin<U>> type;
+			};
+			
+			// substitution u = a * dx + b into a one argument functor we can integrate
+			template <typename F, typename U, typename dx>
+			struct __I<pat::compose<F, U>, dx, integral_function_stage, typename std::enable_if<
+				_linear<U, dx>::value, typename _void<integral<F, pat::select<0>>>::type
+			>::type> {
+				typedef multiply<slope_inverse<U, dx>, pat::compose<integral<F, pat::select<0>>, U>> type;
+			};
+			
+			// x^n ln(x), n != -1.  integrating by parts the usual way around would go in circles.
+			template <std::size_t A, typename N>
+			struct __I<___multiply<___pow<pat::select<A>, N>, __ln<pat::select<A>>>, pat::select<A>, integral_function_stage, typename std::enable_if<
+				is_complex<N>::value && !std::is_same<complex_add<N, rational<1>>, rational<0>>::value
+			>::type> {
+			private:
+				typedef complex_add<N, rational<1>>		n1;
+			public:
+				typedef multiply<
+					complex_divide<rational<1>, n1>,
+					pow<pat::select<A>, n1>,
+					sub<ln<pat::select<A>>, complex_divide<rational<1>, n1>>
+				> type;
+			};
+			template <std::size_t A>
+			struct __I<___multiply<pat::select<A>, __ln<pat::select<A>>>, pat::select<A>, integral_function_stage> {
+				typedef multiply<rational<1,2>, pow<pat::select<A>, rational<2>>, sub<ln<pat::select<A>>, rational<1,2>>> type;
+			};
+			
+			// EXP TIMES SIN OR COS
+			// with U = a x + ..., V = b x + ...
+			//		exp(U) sin(V) -> exp(U) (a sin(V) - b cos(V)) / (a^2 + b^2)
+			//		exp(U) cos(V) -> exp(U) (a cos(V) + b sin(V)) / (a^2 + b^2)
+			template <typename U, typename V, typename dx>
+			struct _exp_trig {
+			private:
+				typedef typename _linear<U, dx>::slope		a;
+				typedef typename _linear<V, dx>::slope		b;
+			public:
+				typedef complex_divide<rational<1>, complex_add<complex_multiply<a, a>, complex_multiply<b, b>>> scale;
+				
+				typedef complex_multiply<scale, a>		a_scaled;
+				typedef complex_multiply<scale, b>		b_scaled;
+			};
+			
+			template <typename U, typename V, typename dx>
+			struct __I<___multiply<__exp<U>, __sin<V>>, dx, integral_product_stage, typename std::enable_if<
+				_linear<U, dx>::value && _linear<V, dx>::value
+			>::type> {
+				typedef multiply<exp<U>, sub<
+					multiply<typename _exp_trig<U, V, dx>::a_scaled, sin<V>>,
+					multiply<typename _exp_trig<U, V, dx>::b_scaled, cos<V>>
+				>> type;
+			};
+			
+			template <typename U, typename V, typename dx>
+			struct __I<___multiply<__exp<U>, __cos<V>>, dx, integral_product_stage, typename std::enable_if<
+				_linear<U, dx>::value && _linear<V, dx>::value
+			>::type> {
+				typedef multiply<exp<U>, add<
+					multiply<typename _exp_trig<U, V, dx>::a_scaled, cos<V>>,
+					multiply<typename _exp_trig<U, V, dx>::b_scaled, sin<V>>
+				>> type;
+			};
+			
+			// BY PARTS, polynomial times something we can keep integrating
+			//		P G -> P I(G) - I(P' I(G))
+			template <typename P, typename G, typename dx, typename = void>
+			struct _by_parts { };
+			
+			template <typename P, typename G, typename dx>
+			struct _by_parts<P, G, dx, typename _void<integral<multiply<D<P, dx>, integral<G, dx>>, dx>>::type> {
+				typedef sub<multiply<P, integral<G, dx>>, integral<multiply<D<P, dx>, integral<G, dx>>, dx>> type;
+			};
+			
+			template <typename P, typename G, typename dx>
+			struct __I<___multiply<P, G>, dx, integral_parts_stage, typename std::enable_if<
+				_monomial<P, dx>::value && _parts_friendly<G, dx>::value
+			>::type> : _by_parts<P, G, dx> { };
+			
+			// REWRITE PRODUCTS AND POWERS OF SIN AND COS AS SUMS
+			//		sin U sin V = (cos(U - V) - cos(U + V)) / 2
+			//		cos U cos V = (cos(U - V) + cos(U + V)) / 2
+			//		sin U cos V = (sin(U + V) + sin(U - V)) / 2
+			template <typename T>
+			struct _trig_product {
+				typedef T type;
+				static constexpr bool value = false;
+			};
+			
+			template <typename U, typename V>
+			struct _trig_product<___multiply<__sin<U>, __sin<V>>> : std::true_type {
+				typedef multiply<rational<1,2>, sub<cos<sub<U, V>>, cos<add<U, V>>>> type;
+			};
+			template <typename U, typename V>
+			struct _trig_product<___multiply<__cos<U>, __cos<V>>> : std::true_type {
+				typedef multiply<rational<1,2>, add<cos<sub<U, V>>, cos<add<U, V>>>> type;
+			};
+			template <typename U, typename V>
+			struct _trig_product<___multiply<__sin<U>, __cos<V>>> : std::true_type {
+				typedef multiply<rational<1,2>, add<sin<add<U, V>>, sin<sub<U, V>>>> type;
+			};
+			
+			// powers are products of a factor with itself, peel off two at a time.
+			template <typename U, std::intmax_t N, std::intmax_t iD>
+			struct _trig_product<___pow<__sin<U>, complex<N, 1, 0, iD>>> : std::integral_constant<bool, (N >= 2)> {
+				typedef multiply<rational<1,2>, sub<rational<1>, cos<multiply<rational<2>, U>>>, pow<sin<U>, rational<N - 2>>> type;
+			};
+			template <typename U, std::intmax_t N, std::intmax_t iD>
+			struct _trig_product<___pow<__cos<U>, complex<N, 1, 0, iD>>> : std::integral_constant<bool, (N >= 2)> {
+				typedef multiply<rational<1,2>, add<rational<1>, cos<multiply<rational<2>, U>>>, pow<cos<U>, rational<N - 2>>> type;
+			};
+			
+			// the pair can be at the front of a longer product, or after something else
+			template <typename F, typename G>
+			struct _trig_rewrite {
+				typedef _trig_product<___multiply<F, G>> pair;
+				
+				static constexpr bool value = pair::value;
+				typedef typename pair::type type;
+			};
+			template <typename F, typename G, typename H>
+			struct _trig_rewrite<F, ___multiply<G, H>> {
+				typedef _trig_product<___multiply<F, G>>	pair;
+				typedef _trig_rewrite<G, H>					rest;
+				typedef _trig_product<F>					power;
+				
+				static constexpr bool value = pair::value || rest::value || power::value;
+				typedef typename std::conditional<pair::value,
+					multiply<typename pair::type, H>,
+					typename std::conditional<power::value,
+						multiply<typename power::type, ___multiply<G, H>>,
+						multiply<F, typename rest::type>
+					>::type
+				>::type type;
+			};
+			
+			template <typename T, typename dx>
+			struct _trig_expand {
+				typedef _trig_product<T>	single;
+				
+				static constexpr bool value = single::value;
+				typedef typename single::type type;
+			};
+			template <typename F, typename G, typename dx>
+			struct _trig_expand<___multiply<F, G>, dx> {
+				typedef _trig_rewrite<F, G>	rewrite;
+				typedef _trig_product<F>	power;
+				
+				static constexpr bool value = rewrite::value || power::value;
+				typedef typename std::conditional<power::value,
+					multiply<typename power::type, G>,
+					typename rewrite::type
+				>::type type;
+			};
+			
+			// only when something was rewritten, otherwise the expansion is T again
+			template <typename T, typename dx>
+			struct __I<T, dx, integral_rewrite_stage, typename std::enable_if<_trig_expand<T, dx>::value>::type>
+				: _I<typename _trig_expand<T, dx>::type, dx, integral_max_stage> { };
+			
+			
+			
+			// ITERATED INTEGRALS, in every argument of Mask, lowest argument first
+			constexpr std::size_t lowest_argument(std::uint64_t m) {
+				return (m & 1 ? 0 : 1 + lowest_argument(m >> 1));
+			}
+			
+			template <typename T>
+			struct _antiderivative<T, 0> {
+				typedef T type;
+			};
+			
+			template <typename T, std::uint64_t Mask>
+			struct _antiderivative<T, Mask, typename std::enable_if<(Mask != 0) && has_integral<T, pat::select<lowest_argument(Mask)>>::value>::type>
+				: _antiderivative<integral<T, pat::select<lowest_argument(Mask)>>, Mask & (Mask - 1)> { };
+			
+			template <typename T, std::uint64_t Mask>
+			struct _has_antiderivative<T, Mask, typename _void<typename _antiderivative<T, Mask>::type>::type> : std::true_type { };
+		}
+	}
+}
+
+#endif
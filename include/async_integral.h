@@ -0,0 +1,274 @@
+//
+//  async_integral.h
+//  math
+//
+//  Created by Patrick Sauter on 10/19/26.
+//  Copyright (c) 2026 Patrick Sauter. All rights reserved.
+//
+
+#ifndef math_async_integral_h
+#define math_async_integral_h
+
+// numeric_integral in the background,
+//
+//		auto h = async_integral(f, measure::cartesian<reals_t,3>, region / steps);
+//		...
+//		h.progress();		// fraction of the cells done
+//		h.partial();		// sum over the cells done so far
+//		h.cancel();
+//		h.get();			// waits, then the integral or math::cancelled
+//
+// the cells are cut into chunks that run as separate tasks on shared_pool(), so many integrals can be in flight at
+// once and share the cores.  chunk sums are added in order at the end, the result is the same every run.
+// chunks check for a cancel or the deadline every few cells and give up, so cancelling frees the pool almost at once.
+// dropping the last handle cancels too, nobody is left to read the answer.
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <vector>
+#include <algorithm>
+#include <exception>
+#include <condition_variable>
+
+#include "core.h"
+#include "exceptions.h"
+#include "box.h"
+#include "numeric_integral.h"
+#include "parallel.h"
+
+namespace math {
+	struct async_options {
+		typedef std::chrono::steady_clock		clock;
+		
+		clock::time_point	deadline	= clock::time_point::max();
+		std::size_t			chunk		= 4096;		// cells per task
+		worker_pool *		pool		= nullptr;	// shared_pool() if null
+	};
+	
+	namespace detail {
+		// cells between progress updates and cancel checks
+		constexpr std::size_t async_block = 64;
+		
+		template <typename T>
+		struct async_state {
+			typedef async_options::clock	clock;
+			
+			std::size_t					total = 0, chunk = 1;
+			clock::time_point			deadline;
+			
+			std::atomic<std::size_t>	done{0};
+			std::atomic<std::size_t>	remaining{0};
+			std::atomic<bool>			stop{false};
+			
+			std::mutex					mutex;
+			std::condition_variable		finished_signal;
+			bool						finished = false;
+			bool						cancelled = false;
+			std::exception_ptr			error;
+			
+			std::vector<T>				sums;
+			std::vector<char>			complete;
+			
+			// one chunk finished, skipped or failed
+			void chunk_done() {
+				if (--remaining == 0) {
+					{
+						std::lock_guard<std::mutex> lock(mutex);
+						finished = true;
+					}
+					
+					finished_signal.notify_all();
+				}
+			}
+		};
+	}
+	
+	template <typename T>
+	class integral_handle {
+	public:
+		typedef T								value_type;
+		typedef async_options::clock			clock;
+		
+		integral_handle() = default;
+		explicit integral_handle(std::shared_ptr<detail::async_state<T>> state) : _state(std::move(state)) { }
+		
+		integral_handle(integral_handle &&) = default;
+		integral_handle & operator=(integral_handle && other) {
+			release();
+			_state = std::move(other._state);
+			
+			return *this;
+		}
+		
+		integral_handle(integral_handle const &) = delete;
+		integral_handle & operator=(integral_handle const &) = delete;
+		
+		~integral_handle() { release(); }
+		
+		bool valid() const { return bool(_state); }
+		
+		// cells evaluated so far, out of total()
+		std::size_t done() const { return _state->done; }
+		std::size_t total() const { return _state->total; }
+		
+		reals_t progress() const {
+			return (total() > 0 ? reals_t(done()) / reals_t(total()) : reals_t(1));
+		}
+		
+		// sum over the chunks finished so far, in order
+		T partial() const {
+			std::lock_guard<std::mutex> lock(_state->mutex);
+			
+			T sum{};
+			
+			for (std::size_t c = 0; c < _state->sums.size(); ++c) {
+				if (_state->complete[c])
+					sum += _state->sums[c];
+			}
+			
+			return sum;
+		}
+		
+		// chunks already running finish, the rest are skipped
+		void cancel() { _state->stop = true; }
+		
+		bool ready() const {
+			std::lock_guard<std::mutex> lock(_state->mutex);
+			
+			return _state->finished;
+		}
+		
+		void wait() const {
+			std::unique_lock<std::mutex> lock(_state->mutex);
+			_state->finished_signal.wait(lock, [&]() { return _state->finished; });
+		}
+		
+		template <typename Rep, typename Period>
+		bool wait_for(std::chrono::duration<Rep, Period> const & d) const {
+			std::unique_lock<std::mutex> lock(_state->mutex);
+			
+			return _state->finished_signal.wait_for(lock, d, [&]() { return _state->finished; });
+		}
+		
+		// the integral, rethrowing what the integrand threw, or math::cancelled if it didn't run to the end
+		T get() const {
+			wait();
+			
+			std::lock_guard<std::mutex> lock(_state->mutex);
+			
+			if (_state->error)
+				std::rethrow_exception(_state->error);
+			
+			if (_state->cancelled)
+				throw cancelled();
+			
+			T sum{};
+			
+			for (auto const & s : _state->sums)
+				sum += s;
+			
+			return sum;
+		}
+	private:
+		void release() {
+			if (_state)
+				_state->stop = true;
+			
+			_state.reset();
+		}
+		
+		std::shared_ptr<detail::async_state<T>>	_state;
+	};
+	
+	// numeric_integral(f, mu, d) on the worker pool, returns at once
+	template <typename Function, typename Measure, typename Box>
+	auto async_integral(Function f, Measure mu, box_divider<Box> const & d, async_options const & options = {})
+		-> integral_handle<decltype(f(d[0]))>
+	{
+		typedef decltype(f(d[0])) result_t;
+		
+		static_assert(check::vector_space<result_t, reals_t>::value,
+					  "Assertion failed, return type not a vector space over the reals.");
+		
+		auto state = std::make_shared<detail::async_state<result_t>>();
+		
+		state->total	= d.size_total();
+		state->chunk	= std::max<std::size_t>(1, options.chunk);
+		state->deadline	= options.deadline;
+		
+		std::size_t const chunks = (state->total + state->chunk - 1) / state->chunk;
+		
+		state->sums.assign(chunks, result_t{});
+		state->complete.assign(chunks, 0);
+		state->remaining = chunks;
+		
+		if (chunks == 0) {
+			state->finished = true;
+			
+			return integral_handle<result_t>(state);
+		}
+		
+		// the tasks share one copy of the integrand, measure and cells.  they run concurrently, so f and mu are
+		// called through const references
+		auto work = std::make_shared<std::tuple<Function, Measure, box_divider<Box>>>(std::move(f), std::move(mu), d);
+		
+		worker_pool & pool = (options.pool ? *options.pool : shared_pool());
+		
+		for (std::size_t c = 0; c < chunks; ++c) {
+			pool.submit([state, work, c]() {
+				auto & s = *state;
+				
+				auto late = [&s]() { return s.stop || detail::async_state<result_t>::clock::now() > s.deadline; };
+				
+				try {
+					auto const & f = std::get<0>(*work);
+					auto const & mu = std::get<1>(*work);
+					auto const & cells = std::get<2>(*work);
+					
+					std::size_t first = c * s.chunk;
+					std::size_t last = std::min(s.total, first + s.chunk);
+					
+					result_t sum{};
+					bool running = !late();
+					
+					// progress and the cancel flag are looked at every few cells, so slow integrands still respond
+					for (std::size_t i = first; i < last && running; ) {
+						std::size_t begin = i, stop = std::min(last, i + detail::async_block);
+						
+						for (; i < stop; ++i) {
+							auto cell = cells[i];
+							sum += f(cell) * mu(cell);
+						}
+						
+						s.done += stop - begin;
+						running = (i == last || !late());
+					}
+					
+					std::lock_guard<std::mutex> lock(s.mutex);
+					
+					if (running) {
+						s.sums[c] = sum;
+						s.complete[c] = 1;
+					} else
+						s.cancelled = true;
+				} catch (...) {
+					std::lock_guard<std::mutex> lock(s.mutex);
+					
+					if (!s.error)
+						s.error = std::current_exception();
+					
+					s.stop = true;
+				}
+				
+				s.chunk_done();
+			});
+		}
+		
+		return integral_handle<result_t>(state);
+	}
+}
+
+#endif
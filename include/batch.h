@@ -0,0 +1,567 @@
+//
+//  batch.h
+//  math
+//
+//  Created by Patrick Sauter on 10/19/26.
+//  Copyright (c) 2026 Patrick Sauter. All rights reserved.
+//
+
+#ifndef math_batch_h
+#define math_batch_h
+
+// batches of small fixed size matrices, for millions of independent 3x3 and 4x4 transforms and solves.  one
+// matrix<double,3,3> is 9 numbers, too few for the vector units to do anything with, so a batch turns the layout
+// around.  the matrices go in tiles of batch_lanes, and inside a tile entry (i, j) of all of them is stored together,
+//
+//		batch.entries(k, i * M + j)[l] == batch(k + l, i, j)
+//
+// and the kernels below load a vector register's worth of matrices at a time, lane l of every instruction belonging
+// to matrix k + l.  each formula is written once, as straight line code on packs, so a batch of 3x3 products runs at
+// the full width of the machine.  whole planes, each entry of every matrix together, would do the same but put N M
+// streams a power of two apart, which the caches can't hold.
+//
+//		matrix_batch<reals_t,4,4> T(n);
+//		vector_batch<reals_t,4> x(n);
+//		T.set(k, m);
+//		auto y = T * x;					// y[k] = T[k] x[k]
+//		auto z = m * x;					// the same transform for all of them
+//		inverse(T); determinant(T); solve(T, x);
+//		cross(a, b); norm(a); inner_product(a, b);
+//
+// determinant, inverse and solve use cofactors up to 4x4, no pivoting and nothing to branch on per lane, and fall
+// back to lu() one matrix at a time above that.  inverse and solve throw math::singular if any matrix in the batch
+// is.  big batches are split over threads in blocks of batch_block matrices.
+
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <complex>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <type_traits>
+
+#include "core.h"
+#include "exceptions.h"
+#include "matrix.h"
+#include "vector.h"
+#include "dmatrix.h"
+#include "parallel.h"
+#include "lu.h"
+
+namespace math {
+	namespace detail {
+		// matrices worked on together, a cache line of doubles and the width of AVX-512
+		constexpr std::size_t batch_lanes = 8;
+		
+		// matrices per parallel block
+		constexpr std::size_t batch_block = 1024;
+		
+		// bytes in a vector register
+#if defined(__AVX512F__)
+		constexpr std::size_t simd_bytes = 64;
+#elif defined(__AVX__)
+		constexpr std::size_t simd_bytes = 32;
+#else
+		constexpr std::size_t simd_bytes = 16;
+#endif
+
+		// one entry of width matrices, + - * / working lane by lane.  for plain numbers it is a vector type of the
+		// compiler's, a register wide, so it stays in registers and each operation is one instruction.  anything
+		// else, complex_t say, goes a lane at a time
+		template <typename T, typename = void>
+		struct simd {
+			static constexpr std::size_t width = 1;
+			
+			typedef T type;
+		};
+
+#if defined(__GNUC__)
+		template <typename T>
+		struct simd<T, typename std::enable_if<std::is_arithmetic<T>::value && !std::is_same<T, bool>::value && !std::is_same<T, long double>::value>::type> {
+			static constexpr std::size_t width = std::min(simd_bytes / sizeof(T), batch_lanes);
+			
+			typedef T type __attribute__((vector_size(sizeof(T) * width)));
+		};
+#endif
+
+		template <typename T>
+		using pack = typename simd<T>::type;
+		
+		template <typename T>
+		pack<T> load_pack(T const * p) {
+			pack<T> r;
+			std::memcpy(&r, p, sizeof(r));
+			
+			return r;
+		}
+		template <typename T>
+		void store_pack(T * p, pack<T> const & r) {
+			std::memcpy(p, &r, sizeof(r));
+		}
+		template <typename T>
+		pack<T> fill_pack(T const & x) {
+			T v[simd<T>::width];
+			std::fill(v, v + simd<T>::width, x);
+			
+			return load_pack<T>(v);
+		}
+		
+		// determinant and adjugate, adj(A) A = det(A) I, on row major entries of any type with + - *.  the same code
+		// runs on packs of lanes
+		template <std::size_t N>
+		struct cofactors : std::false_type { };
+		
+		template <>
+		struct cofactors<2> : std::true_type {
+			template <typename P>
+			static P adjugate(P const * a, P * b) {
+				b[0] = a[3];
+				b[1] = -a[1];
+				b[2] = -a[2];
+				b[3] = a[0];
+				
+				return a[0] * a[3] - a[1] * a[2];
+			}
+		};
+		
+		template <>
+		struct cofactors<3> : std::true_type {
+			template <typename P>
+			static P adjugate(P const * a, P * b) {
+				b[0] = a[4] * a[8] - a[5] * a[7];
+				b[1] = a[2] * a[7] - a[1] * a[8];
+				b[2] = a[1] * a[5] - a[2] * a[4];
+				b[3] = a[5] * a[6] - a[3] * a[8];
+				b[4] = a[0] * a[8] - a[2] * a[6];
+				b[5] = a[2] * a[3] - a[0] * a[5];
+				b[6] = a[3] * a[7] - a[4] * a[6];
+				b[7] = a[1] * a[6] - a[0] * a[7];
+				b[8] = a[0] * a[4] - a[1] * a[3];
+				
+				return a[0] * b[0] + a[1] * b[3] + a[2] * b[6];
+			}
+		};
+		
+		// through the 2x2 minors of the top two rows (s) and the bottom two (c)
+		template <>
+		struct cofactors<4> : std::true_type {
+			template <typename P>
+			static P adjugate(P const * a, P * b) {
+				P const s0 = a[0] * a[5] - a[4] * a[1], s1 = a[0] * a[6] - a[4] * a[2], s2 = a[0] * a[7] - a[4] * a[3];
+				P const s3 = a[1] * a[6] - a[5] * a[2], s4 = a[1] * a[7] - a[5] * a[3], s5 = a[2] * a[7] - a[6] * a[3];
+				
+				P const c5 = a[10] * a[15] - a[14] * a[11], c4 = a[9] * a[15] - a[13] * a[11], c3 = a[9] * a[14] - a[13] * a[10];
+				P const c2 = a[8] * a[15] - a[12] * a[11], c1 = a[8] * a[14] - a[12] * a[10], c0 = a[8] * a[13] - a[12] * a[9];
+				
+				b[0] = a[5] * c5 - a[6] * c4 + a[7] * c3;
+				b[1] = a[2] * c4 - a[1] * c5 - a[3] * c3;
+				b[2] = a[13] * s5 - a[14] * s4 + a[15] * s3;
+				b[3] = a[10] * s4 - a[9] * s5 - a[11] * s3;
+				
+				b[4] = a[6] * c2 - a[4] * c5 - a[7] * c1;
+				b[5] = a[0] * c5 - a[2] * c2 + a[3] * c1;
+				b[6] = a[14] * s2 - a[12] * s5 - a[15] * s1;
+				b[7] = a[8] * s5 - a[10] * s2 + a[11] * s1;
+				
+				b[8] = a[4] * c4 - a[5] * c2 + a[7] * c0;
+				b[9] = a[1] * c2 - a[0] * c4 - a[3] * c0;
+				b[10] = a[12] * s4 - a[13] * s2 + a[15] * s0;
+				b[11] = a[9] * s2 - a[8] * s4 - a[11] * s0;
+				
+				b[12] = a[5] * c1 - a[4] * c3 - a[6] * c0;
+				b[13] = a[0] * c3 - a[1] * c1 + a[2] * c0;
+				b[14] = a[13] * s1 - a[12] * s3 - a[14] * s0;
+				b[15] = a[8] * s3 - a[9] * s1 + a[10] * s0;
+				
+				return s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+			}
+		};
+		
+		// f(k) for every k in [0, padded) a multiple of step, in parallel over blocks once there are enough entries to
+		// be worth it
+		template <typename Function>
+		void batch_for(std::size_t padded, std::size_t entries, std::size_t step, Function f) {
+			auto run = [&](std::size_t first, std::size_t last) {
+				for (std::size_t k = first; k < last; k += step)
+					f(k);
+			};
+			
+			if (padded * entries < parallel_entries)
+				return run(0, padded);
+			
+			stealing_for((padded + batch_block - 1) / batch_block, [&](std::size_t b) {
+				run(b * batch_block, std::min(padded, (b + 1) * batch_block));
+			});
+		}
+	}
+	
+	template <typename Type = reals_t, std::size_t N = 3, std::size_t M = 3>
+	class matrix_batch {
+	public:
+		static_assert(check::ring<Type>::value,
+					  "Assertion failed, matrix type not a Ring.");
+		
+		typedef Type											value_type;
+		typedef matrix<Type, N, M>								matrix_type;
+		typedef std::vector<Type, detail::aligned_allocator<Type>>	storage_type;
+		
+		static constexpr std::size_t tile = N * M * detail::batch_lanes;
+		
+		matrix_batch() = default;
+		
+		// count zero matrices, or count copies of m
+		explicit matrix_batch(std::size_t count) : _count(count), _data(padded(count) * N * M, Type(math::additive_identity)) { }
+		matrix_batch(std::size_t count, matrix_type const & m) : matrix_batch(count) {
+			for (std::size_t k = 0; k < count; ++k)
+				set(k, m);
+		}
+		
+		static constexpr std::size_t rows() { return N; }
+		static constexpr std::size_t cols() { return M; }
+		
+		// number of matrices, and the number rounded up to whole tiles
+		std::size_t size() const { return _count; }
+		std::size_t padded_size() const { return padded(_count); }
+		
+		// entry e, row major, of matrix k and the ones after it to the end of its tile.  matrices past size() are
+		// padding and stay zero
+		Type * entries(std::size_t k, std::size_t e) { return _data.data() + offset(k, e); }
+		Type const * entries(std::size_t k, std::size_t e) const { return _data.data() + offset(k, e); }
+		
+		Type & operator()(std::size_t k, std::size_t i, std::size_t j) {
+			assert(k < _count && i < N && j < M);
+			
+			return entries(k, i * M + j)[0];
+		}
+		Type const & operator()(std::size_t k, std::size_t i, std::size_t j) const {
+			assert(k < _count && i < N && j < M);
+			
+			return entries(k, i * M + j)[0];
+		}
+		
+		// matrix k, copied in or out of its tile
+		matrix_type operator[](std::size_t k) const {
+			assert(k < _count);
+			
+			matrix_type m;
+			
+			for (std::size_t e = 0; e < N * M; ++e)
+				m[e] = entries(k, e)[0];
+			
+			return m;
+		}
+		void set(std::size_t k, matrix_type const & m) {
+			assert(k < _count);
+			
+			for (std::size_t e = 0; e < N * M; ++e)
+				entries(k, e)[0] = m[e];
+		}
+		
+		void push_back(matrix_type const & m) {
+			resize(_count + 1);
+			set(_count - 1, m);
+		}
+		
+		// zero matrices added at the end, or the last ones dropped
+		void resize(std::size_t count) {
+			for (std::size_t k = count; k < std::min(_count, padded(count)); ++k)
+				set(k, matrix_type(Type(math::additive_identity)));
+			
+			_data.resize(padded(count) * N * M, Type(math::additive_identity));
+			_count = count;
+		}
+		void reserve(std::size_t count) {
+			_data.reserve(padded(count) * N * M);
+		}
+	private:
+		static std::size_t offset(std::size_t k, std::size_t e) {
+			return k / detail::batch_lanes * tile + e * detail::batch_lanes + k % detail::batch_lanes;
+		}
+		
+		static std::size_t padded(std::size_t count) {
+			return (count + detail::batch_lanes - 1) / detail::batch_lanes * detail::batch_lanes;
+		}
+		
+		std::size_t		_count = 0;
+		storage_type	_data;
+	};
+	
+	template <typename Type = reals_t, std::size_t N = 3>
+	using vector_batch = matrix_batch<Type, N, 1>;
+	
+	namespace detail {
+		// the entries of matrices k to k + simd<T>::width, loaded or stored all at once
+		template <typename T, std::size_t N, std::size_t M>
+		void load(matrix_batch<T,N,M> const & a, std::size_t k, pack<T> * p) {
+			for (std::size_t e = 0; e < N * M; ++e)
+				p[e] = load_pack(a.entries(k, e));
+		}
+		template <typename T, std::size_t N, std::size_t M>
+		void store(matrix_batch<T,N,M> & a, std::size_t k, pack<T> const * p) {
+			for (std::size_t e = 0; e < N * M; ++e)
+				store_pack(a.entries(k, e), p[e]);
+		}
+		
+		// A_k B_k with the entries of A given as packs
+		template <typename T, std::size_t N, std::size_t M, std::size_t P>
+		void batch_multiply(pack<T> const * a, matrix_batch<T,M,P> const & b, std::size_t k, matrix_batch<T,N,P> & c) {
+			pack<T> x[M * P];
+			
+			load(b, k, x);
+			
+			for (std::size_t i = 0; i < N; ++i) {
+				for (std::size_t j = 0; j < P; ++j) {
+					pack<T> s = a[i * M] * x[j];
+					
+					for (std::size_t t = 1; t < M; ++t)
+						s = s + a[i * M + t] * x[t * P + j];
+					
+					store_pack(c.entries(k, i * P + j), s);
+				}
+			}
+		}
+		
+		template <typename T>
+		void check_regular(std::vector<T> const & d) {
+			for (auto const & x : d) {
+				if (x == T(math::additive_identity))
+					throw math::singular();
+			}
+		}
+	}
+	
+	// ------------------------------------------------------
+	// products, matrix by matrix and one matrix for the whole batch
+	
+	template <typename T, std::size_t N, std::size_t M, std::size_t P>
+	matrix_batch<T,N,P> operator*(matrix_batch<T,N,M> const & a, matrix_batch<T,M,P> const & b) {
+		detail::check_size(a.size() == b.size(), "Batch sizes don't match.");
+		
+		matrix_batch<T,N,P> c(a.size());
+		
+		detail::batch_for(c.padded_size(), N * M + M * P, detail::simd<T>::width, [&](std::size_t k) {
+			detail::pack<T> x[N * M];
+			
+			detail::load(a, k, x);
+			detail::batch_multiply(x, b, k, c);
+		});
+		
+		return c;
+	}
+	
+	template <typename T, std::size_t N, std::size_t M, std::size_t P>
+	matrix_batch<T,N,P> operator*(matrix<T,N,M> const & a, matrix_batch<T,M,P> const & b) {
+		matrix_batch<T,N,P> c(b.size());
+		detail::pack<T> x[N * M];
+		
+		for (std::size_t e = 0; e < N * M; ++e)
+			x[e] = detail::fill_pack(a[e]);
+		
+		detail::batch_for(c.padded_size(), M * P, detail::simd<T>::width, [&](std::size_t k) {
+			detail::batch_multiply(x, b, k, c);
+		});
+		
+		return c;
+	}
+	
+	// ------------------------------------------------------
+	// determinant, inverse and solve for every matrix
+	
+	namespace detail {
+		// cofactors a lane pack at a time, det(A_k) stored to d[k].  f sees a determinant of 1 in the padding lanes,
+		// where the adjugate is zero, so dividing by it keeps the padding zero
+		template <typename T, std::size_t N, typename Function>
+		void batch_adjugate(matrix_batch<T,N,N> const & a, std::vector<T> & d, std::size_t entries, Function f) {
+			d.resize(a.padded_size());
+			
+			batch_for(a.padded_size(), entries, simd<T>::width, [&](std::size_t k) {
+				pack<T> x[N * N], y[N * N];
+				
+				load(a, k, x);
+				
+				pack<T> det = cofactors<N>::adjugate(x, y);
+				
+				store_pack(d.data() + k, det);
+				
+				if (k + simd<T>::width > a.size()) {
+					for (std::size_t l = std::max(k, a.size()); l < k + simd<T>::width; ++l)
+						d[l] = T(math::multiplicative_identity);
+					
+					det = load_pack(d.data() + k);
+				}
+				
+				f(k, y, det);
+			});
+			
+			d.resize(a.size());
+		}
+		
+		// lu() for one matrix at a time
+		template <typename T, std::size_t N, typename Function>
+		void batch_each(matrix_batch<T,N,N> const & a, Function f) {
+			batch_for(a.padded_size(), N * N, batch_lanes, [&](std::size_t k) {
+				for (std::size_t l = k; l < std::min(k + batch_lanes, a.size()); ++l)
+					f(l);
+			});
+		}
+		
+		template <typename T, std::size_t N>
+		std::vector<T> batch_determinant(matrix_batch<T,N,N> const & a, std::true_type) {
+			std::vector<T> d;
+			
+			batch_adjugate(a, d, N * N, [](std::size_t, pack<T> const *, pack<T> const &) { });
+			
+			return d;
+		}
+		template <typename T, std::size_t N>
+		std::vector<T> batch_determinant(matrix_batch<T,N,N> const & a, std::false_type) {
+			std::vector<T> d(a.size());
+			
+			batch_each(a, [&](std::size_t l) { d[l] = determinant(a[l]); });
+			
+			return d;
+		}
+		
+		template <typename T, std::size_t N>
+		matrix_batch<T,N,N> batch_inverse(matrix_batch<T,N,N> const & a, std::true_type) {
+			matrix_batch<T,N,N> b(a.size());
+			std::vector<T> d;
+			
+			batch_adjugate(a, d, 2 * N * N, [&](std::size_t k, pack<T> * y, pack<T> const & det) {
+				pack<T> const r = fill_pack(T(math::multiplicative_identity)) / det;
+				
+				for (std::size_t e = 0; e < N * N; ++e)
+					store_pack(b.entries(k, e), y[e] * r);
+			});
+			
+			check_regular(d);
+			
+			return b;
+		}
+		template <typename T, std::size_t N>
+		matrix_batch<T,N,N> batch_inverse(matrix_batch<T,N,N> const & a, std::false_type) {
+			matrix_batch<T,N,N> b(a.size());
+			
+			batch_each(a, [&](std::size_t l) { b.set(l, inverse(a[l])); });
+			
+			return b;
+		}
+		
+		// adj(A) B / det(A), with the division last
+		template <typename T, std::size_t N, std::size_t K>
+		matrix_batch<T,N,K> batch_solve(matrix_batch<T,N,N> const & a, matrix_batch<T,N,K> const & b, std::true_type) {
+			matrix_batch<T,N,K> x(a.size());
+			std::vector<T> d;
+			
+			batch_adjugate(a, d, N * N + 2 * N * K, [&](std::size_t k, pack<T> * y, pack<T> const & det) {
+				batch_multiply(y, b, k, x);
+				
+				for (std::size_t e = 0; e < N * K; ++e)
+					store_pack(x.entries(k, e), load_pack(x.entries(k, e)) / det);
+			});
+			
+			check_regular(d);
+			
+			return x;
+		}
+		template <typename T, std::size_t N, std::size_t K>
+		matrix_batch<T,N,K> batch_solve(matrix_batch<T,N,N> const & a, matrix_batch<T,N,K> const & b, std::false_type) {
+			matrix_batch<T,N,K> x(a.size());
+			
+			batch_each(a, [&](std::size_t l) { x.set(l, solve(a[l], b[l])); });
+			
+			return x;
+		}
+	}
+	
+	template <typename T, std::size_t N>
+	std::vector<T> determinant(matrix_batch<T,N,N> const & a) {
+		return detail::batch_determinant(a, detail::cofactors<N>{});
+	}
+	
+	template <typename T, std::size_t N, typename = typename std::enable_if<check::field<T>::value>::type>
+	matrix_batch<T,N,N> inverse(matrix_batch<T,N,N> const & a) {
+		return detail::batch_inverse(a, detail::cofactors<N>{});
+	}
+	
+	// X_k with A_k X_k = B_k, for any number of columns
+	template <typename T, std::size_t N, std::size_t K, typename = typename std::enable_if<check::field<T>::value>::type>
+	matrix_batch<T,N,K> solve(matrix_batch<T,N,N> const & a, matrix_batch<T,N,K> const & b) {
+		detail::check_size(a.size() == b.size(), "Batch sizes don't match.");
+		
+		return detail::batch_solve(a, b, detail::cofactors<N>{});
+	}
+	
+	// ------------------------------------------------------
+	// vector batches
+	
+	template <typename T>
+	vector_batch<T,3> cross(vector_batch<T,3> const & a, vector_batch<T,3> const & b) {
+		detail::check_size(a.size() == b.size(), "Batch sizes don't match.");
+		
+		vector_batch<T,3> c(a.size());
+		
+		detail::batch_for(c.padded_size(), 9, detail::simd<T>::width, [&](std::size_t k) {
+			detail::pack<T> x[3], y[3];
+			
+			detail::load(a, k, x);
+			detail::load(b, k, y);
+			
+			detail::store_pack(c.entries(k, 0), x[1] * y[2] - x[2] * y[1]);
+			detail::store_pack(c.entries(k, 1), x[2] * y[0] - x[0] * y[2]);
+			detail::store_pack(c.entries(k, 2), x[0] * y[1] - x[1] * y[0]);
+		});
+		
+		return c;
+	}
+	
+	// a_k . conj(b_k)
+	template <typename T, std::size_t N>
+	std::vector<T> inner_product(vector_batch<T,N> const & a, vector_batch<T,N> const & b) {
+		detail::check_size(a.size() == b.size(), "Batch sizes don't match.");
+		
+		std::vector<T> s(a.padded_size(), T(math::additive_identity));
+		
+		detail::batch_for(a.padded_size(), 2 * N, detail::batch_lanes, [&](std::size_t k) {
+			for (std::size_t e = 0; e < N; ++e) {
+				T const * x = a.entries(k, e);
+				T const * y = b.entries(k, e);
+				
+				for (std::size_t l = 0; l < detail::batch_lanes; ++l)
+					s[k + l] = s[k + l] + x[l] * detail::conjugate(y[l]);
+			}
+		});
+		
+		s.resize(a.size());
+		
+		return s;
+	}
+	
+	template <typename T, std::size_t N>
+	std::vector<reals_t> norm(vector_batch<T,N> const & a) {
+		typedef typename std::decay<decltype(detail::abs2(std::declval<T>()))>::type R;
+		
+		std::vector<reals_t> s(a.padded_size());
+		
+		detail::batch_for(a.padded_size(), N, detail::batch_lanes, [&](std::size_t k) {
+			R t[detail::batch_lanes] = { };
+			
+			for (std::size_t e = 0; e < N; ++e) {
+				T const * x = a.entries(k, e);
+				
+				for (std::size_t l = 0; l < detail::batch_lanes; ++l)
+					t[l] += detail::abs2(x[l]);
+			}
+			
+			for (std::size_t l = 0; l < detail::batch_lanes; ++l)
+				s[k + l] = reals_t(std::sqrt(t[l]));
+		});
+		
+		s.resize(a.size());
+		
+		return s;
+	}
+}
+
+#endif
@@ -13,6 +13,10 @@
 #include <utility>
 #include <numeric>
 #include <functional>
+#include <stdexcept>
+#include <cmath>
+#include <array>
+#include <vector>
 
 #include "vector.h"
 
@@ -62,6 +66,68 @@ namespace math {
 	
 	
 	
+	// breakpoints on [0, 1] for grading the cells along one axis of a box_divider, see box_divider::grade.
+	namespace grading {
+		// n equal cells
+		inline std::vector<reals_t> uniform(std::size_t n) {
+			std::vector<reals_t> u(n + 1);
+			
+			for (std::size_t k = 0; k <= n; ++k)
+				u[k] = reals_t(k) / reals_t(n);
+			
+			return u;
+		}
+		
+		// n cells, each ratio times as wide as the one before.  ratio < 1 clusters them at the high end,
+		// ratio > 1 at the low end.
+		inline std::vector<reals_t> geometric(std::size_t n, reals_t ratio) {
+			if (ratio == 1)
+				return uniform(n);
+			
+			std::vector<reals_t> u(n + 1);
+			
+			reals_t total = (1 - std::pow(ratio, reals_t(n))) / (1 - ratio);
+			reals_t width = 1 / total;
+			
+			u[0] = 0;
+			
+			for (std::size_t k = 1; k < n; ++k, width *= ratio)
+				u[k] = u[k - 1] + width;
+			
+			u[n] = 1;
+			
+			return u;
+		}
+		
+		// n cells clustered at both ends, the extrema of the chebyshev polynomial T_n
+		inline std::vector<reals_t> chebyshev(std::size_t n) {
+			std::vector<reals_t> u(n + 1);
+			
+			for (std::size_t k = 0; k <= n; ++k)
+				u[k] = (1 - std::cos(M_PI * reals_t(k) / reals_t(n))) / 2;
+			
+			u[0] = 0;
+			u[n] = 1;
+			
+			return u;
+		}
+		
+		// n cells with breakpoints map(k / n), for an increasing map of [0, 1] onto itself
+		template <typename Map>
+		std::vector<reals_t> mapped(std::size_t n, Map map) {
+			std::vector<reals_t> u(n + 1);
+			
+			for (std::size_t k = 0; k <= n; ++k)
+				u[k] = map(reals_t(k) / reals_t(n));
+			
+			u[0] = 0;
+			u[n] = 1;
+			
+			return u;
+		}
+	}
+	
+	
 	template <typename Box>
 	class box_divider_iterator;
 	
@@ -71,6 +137,7 @@ namespace math {
 		typedef Box										value_type;
 		
 		typedef typename value_type::vector_type		vector_type;
+		typedef typename vector_type::value_type		scalar_type;
 		typedef typename vector_type::template convert_type<std::size_t> step_vector_type;
 		
 		typedef step_vector_type						size_type;
@@ -80,10 +147,10 @@ namespace math {
 		
 		virtual ~box_divider()	= default;
 		
-		box_divider() : _box{}, _size{} { }
+		box_divider() : _size{}, _box{}, _total(0) { }
 		
 		template <typename V>
-		box_divider(box_divider<V> const & v) : _box(v._box), _size(v._size), _divide(v._divide) { }
+		box_divider(box_divider<V> const & v) : _edges(v._edges), _divide(v._divide), _size(v._size), _box(v._box), _total(v._total) { }
 		
 		box_divider(value_type box, step_vector_type steps) : _box(std::move(box)) {
 			resize(steps);
@@ -105,29 +172,75 @@ namespace math {
 		
 		bool empty() { return size() == 0; }
 		
+		// uniform cells, s[i] along axis i
 		void resize(size_type const & s) {
-			_size = s;
-	
-			// setup our index_mod vector from the step vector.  used to divide the 1D index into the appropriate n dimensinoal index.
-			for (std::size_t i = 0; i < _size.size(); i++) {
-				_divide[i] = (i > 0 ? _size[i - 1] * _divide[i - 1] : 1);
+			auto diagonal = _box.diagonal();
+			
+			for (std::size_t i = 0; i < vector_type::rows(); i++) {
+				auto d = diagonal[i] / s[i];
+				
+				_edges[i].resize(s[i] + 1);
+				
+				for (std::size_t k = 0; k <= s[i]; ++k)
+					_edges[i][k] = _box.a()[i] + d * k;
 			}
 			
-			_total		= std::accumulate(_size.begin(), _size.end(), 1, std::multiplies<typename size_type::value_type>());
+			update();
+		}
+		
+		// cells along axis at the given breakpoints in [0, 1] (see the grading namespace), scaled to the box.
+		// they have to run from exactly 0 to exactly 1, so the cells cover the box and nothing outside it.
+		void grade(std::size_t axis, std::vector<reals_t> const & unit) {
+			check(unit);
+			
+			if (unit.front() != 0 || unit.back() != 1)
+				throw std::invalid_argument("Box divider grading must run from 0 to 1.");
+			
+			auto a = _box.a()[axis];
+			auto d = _box.b()[axis] - a;
+			
+			_edges[axis].resize(unit.size());
+			
+			for (std::size_t k = 0; k < unit.size(); ++k)
+				_edges[axis][k] = a + d * unit[k];
+			
+			_edges[axis].front() = _box.a()[axis];
+			_edges[axis].back() = _box.b()[axis];
+			
+			update();
+		}
+		
+		// cells along axis between explicit breakpoints, which become the extent of the box along that axis
+		void breakpoints(std::size_t axis, std::vector<scalar_type> points) {
+			check(points);
 			
-			_diagonal	= _box.diagonal();
+			auto a = _box.a();
+			auto b = _box.b();
 			
-			{
-				auto i = _diagonal.begin();
-				auto j = _size.begin();
+			a[axis] = points.front();
+			b[axis] = points.back();
+			
+			_box.a(a);
+			_box.b(b);
+			_edges[axis] = std::move(points);
+			
+			update();
+		}
+		
+		std::vector<scalar_type> const & breakpoints(std::size_t axis) const { return _edges[axis]; }
+		
+		value_type		operator[](std::size_t index) const {
+			vector_type lo, hi;
+			
+			for (std::size_t i = 0; i < vector_type::rows(); i++) {
+				auto k = (index / _divide[i]) % _size[i];
 				
-				for (; i != _diagonal.end(); ++i, ++j) {
-					*i /= *j;
-				}
+				lo[i] = _edges[i][k];
+				hi[i] = _edges[i][k + 1];
 			}
+			
+			return value_type(lo, hi);
 		}
-		
-		value_type		operator[](std::size_t index) const { auto t = r(index); return value_type(t, t + _diagonal); }
 		value_type		at(std::size_t index) const {
 			if (index >= _total)
 				throw std::out_of_range("Index out of range of box divider.");
@@ -141,18 +254,48 @@ namespace math {
 		// returns all the dimensions of size multiplied together.
 		typename size_type::value_type
 		size_total() const { return _total; }
+		
+		// the k-th cell boundary along axis, for k from 0 to size()[axis]
+		scalar_type		edge(std::size_t axis, std::size_t k) const { return _edges[axis][k]; }
+		
+		// the per axis position of the cell at a 1D index, axis 0 changes fastest.
+		step_vector_type	indices(std::size_t index) const {
+			step_vector_type	I;
+			
+			for (std::size_t i = 0; i < _size.size(); i++) {
+				I[i] = (index / _divide[i]) % _size[i];
+			}
+			
+			return I;
+		}
+		
+		value_type const &	region() const { return _box; }
 	private:
-		vector_type r(std::size_t index) const {
-			vector_type		R = _box.a();
+		template <typename T>
+		static void check(std::vector<T> const & points) {
+			if (points.size() < 2)
+				throw std::invalid_argument("Box divider needs at least two breakpoints per axis.");
 			
-			for (int i = 0; i < _size.size(); i++) {
-				R[i] += (_box.b()[i] - R[i]) / _size[i] * ((index / _divide[i]) % _size[i]);
+			for (std::size_t k = 1; k < points.size(); ++k) {
+				if (!(points[k - 1] < points[k]))
+					throw std::invalid_argument("Box divider breakpoints must be increasing.");
+			}
+		}
+		
+		// sizes and the 1D index divisors from the breakpoints.
+		void update() {
+			for (std::size_t i = 0; i < vector_type::rows(); i++)
+				_size[i] = _edges[i].size() - 1;
+			
+			// setup our index_mod vector from the step vector.  used to divide the 1D index into the appropriate n dimensinoal index.
+			for (std::size_t i = 0; i < _size.size(); i++) {
+				_divide[i] = (i > 0 ? _size[i - 1] * _divide[i - 1] : 1);
 			}
 			
-			return R;
+			_total		= std::accumulate(_size.begin(), _size.end(), 1, std::multiplies<typename size_type::value_type>());
 		}
 		
-		vector_type			_diagonal;
+		std::array<std::vector<scalar_type>, vector_type::rows()>	_edges;		// cell boundaries along each axis, size()[i] + 1 of them
 		step_vector_type	_divide;	// used to break the 1 dimensional index into the N dimensional vector type, calculated from steps.
 		step_vector_type	_size;		// number of subdivisions in each dimension
 		value_type			_box;
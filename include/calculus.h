@@ -7,4 +7,16 @@
 //
 
 #include "numeric_integral.h"
+#include "product_measure.h"
+#include "infinite_integral.h"
 #include "numeric_derivative.h"
+#include "monte_carlo.h"
+#include "sparse_grid.h"
+#include "separable_integral.h"
+#include "grid_evaluator.h"
+#include "oscillatory_integral.h"
+#include "simplex.h"
+#include "mesh.h"
+#include "symmetric_integral.h"
+#include "romberg.h"
+#include "async_integral.h"
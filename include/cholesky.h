@@ -0,0 +1,247 @@
+//
+//  cholesky.h
+//  math
+//
+//  Created by Patrick Sauter on 10/19/26.
+//  Copyright (c) 2026 Patrick Sauter. All rights reserved.
+//
+
+#ifndef math_cholesky_h
+#define math_cholesky_h
+
+// cholesky factorisation of a symmetric (hermitian for complex entries) matrix, for covariance matrices, normal
+// equations and the like.  half the work of LU and no pivoting.
+//
+//		auto c = cholesky(A);		// A = L L^H, A positive definite
+//		auto d = ldlt(A);			// A = L D L^H, L with ones on the diagonal, no square roots
+//		c.solve(B);
+//
+// only the lower triangle of A is read.  the factors replace it, L below the diagonal and its diagonal (or D) on it,
+// and the upper triangle is set to zero.  the matrix is taken by value, so cholesky(std::move(A)) factors in place
+// without a second copy.
+//
+// as in lu.h, double, float and their complex types go lu_block columns at a time, with the update of the rest of
+// the lower triangle done by gemm, one row block at a time so the upper triangle costs nothing.
+//
+// a pivot that isn't positive (or is zero for LDL^H) stops the factorisation, factored() is then false and solve and
+// determinant throw math::not_positive_definite (math::singular for LDL^H).  that doesn't make A singular, an
+// indefinite matrix can stop either one, use lu() for its determinant.
+
+#include <cmath>
+#include <vector>
+#include <complex>
+#include <utility>
+#include <algorithm>
+#include <type_traits>
+
+#include "core.h"
+#include "exceptions.h"
+#include "lu.h"
+
+namespace math {
+	namespace detail {
+		// columns k to k + b of the lower triangle, for every row below k.  the columns before k have already been
+		// subtracted from the rest.  Unit is LDL^H, with D on the diagonal
+		template <bool Unit, typename T>
+		bool cholesky_panel(T * a, std::size_t n, std::size_t k, std::size_t b) {
+			auto weight = [&](std::size_t t) { return (Unit ? a[t * n + t] : T(math::multiplicative_identity)); };
+			
+			for (std::size_t j = k; j < k + b; ++j) {
+				T * rj = a + j * n;
+				T d = rj[j];
+				
+				for (std::size_t t = k; t < j; ++t)
+					d = d - rj[t] * weight(t) * conjugate(rj[t]);
+				
+				if (Unit) {
+					if (d == T(math::additive_identity))
+						return false;
+				} else {
+					using std::real;
+					
+					if (!(real(d) > 0))
+						return false;
+					
+					d = T(std::sqrt(real(d)));
+				}
+				
+				rj[j] = d;
+				
+				for (std::size_t i = j + 1; i < n; ++i) {
+					T * ri = a + i * n;
+					T s = ri[j];
+					
+					for (std::size_t t = k; t < j; ++t)
+						s = s - ri[t] * weight(t) * conjugate(rj[t]);
+					
+					ri[j] = s / d;
+				}
+			}
+			
+			return true;
+		}
+		
+		template <bool Unit, typename T>
+		bool cholesky_factor(T * a, std::size_t n, std::false_type) {
+			return cholesky_panel<Unit>(a, n, 0, n);
+		}
+		
+		template <bool Unit, typename T>
+		bool cholesky_factor(T * a, std::size_t n, std::true_type) {
+			if (n <= 2 * lu_block)
+				return cholesky_factor<Unit>(a, n, std::false_type{});
+			
+			std::vector<T> w;
+			
+			for (std::size_t k = 0; k < n; k += lu_block) {
+				std::size_t const b = std::min(lu_block, n - k), first = k + b, rest = n - first;
+				
+				if (!cholesky_panel<Unit>(a, n, k, b))
+					return false;
+				
+				if (rest == 0)
+					break;
+				
+				// W = D L21^H, then A22 -= L21 W on and below the diagonal, a block of rows at a time
+				w.resize(b * rest);
+				
+				for (std::size_t t = 0; t < b; ++t) {
+					T const d = (Unit ? a[(k + t) * n + k + t] : T(math::multiplicative_identity));
+					
+					for (std::size_t c = 0; c < rest; ++c)
+						w[t * rest + c] = d * conjugate(a[(first + c) * n + k + t]);
+				}
+				
+				for (std::size_t i = first; i < n; i += lu_block) {
+					std::size_t const rows = std::min(lu_block, n - i);
+					
+					gemm(rows, i + rows - first, b, T(-1), a + i * n + k, n, w.data(), rest, T(1), a + i * n + first, n);
+				}
+			}
+			
+			return true;
+		}
+	}
+	
+	template <typename Matrix, bool Unit = false>
+	class cholesky_decomposition {
+	public:
+		typedef detail::square<Matrix>					shape;
+		typedef typename shape::value_type				value_type;
+		
+		static_assert(check::field<value_type>::value,
+					  "Assertion failed, cholesky decomposition needs a matrix over a field.");
+		
+		explicit cholesky_decomposition(Matrix a) : _l(std::move(a)), _n(shape::size(_l)) {
+			value_type * p = _l.data();
+			
+			_factored = detail::cholesky_factor<Unit>(p, _n, detail::has_gemm<value_type>{});
+			
+			for (std::size_t i = 0; i < _n; ++i)
+				std::fill(p + i * _n + i + 1, p + i * _n + _n, value_type(math::additive_identity));
+		}
+		
+		std::size_t size() const { return _n; }
+		bool factored() const { return _factored; }
+		
+		// L below the diagonal, and L's diagonal or D on it
+		Matrix const & factors() const { return _l; }
+		
+		value_type determinant() const {
+			check_factored();
+			
+			value_type d = value_type(math::multiplicative_identity);
+			
+			for (std::size_t i = 0; i < _n; ++i) {
+				value_type const & x = _l[i * _n + i];
+				
+				d = d * (Unit ? x : x * detail::conjugate(x));
+			}
+			
+			return d;
+		}
+		
+		// X with A X = B, B any matrix with size() rows
+		template <typename B>
+		B solve(B b) const {
+			detail::check_size(b.rows() == _n, "Matrix sizes don't match.");
+			check_factored();
+			
+			std::size_t const m = b.cols();
+			value_type * x = b.data();
+			value_type const * l = _l.data();
+			
+			// L Y = B
+			for (std::size_t i = 0; i < _n; ++i) {
+				for (std::size_t k = 0; k < i; ++k) {
+					value_type const v = l[i * _n + k];
+					
+					for (std::size_t c = 0; c < m; ++c)
+						x[i * m + c] = x[i * m + c] - v * x[k * m + c];
+				}
+				
+				if (!Unit) {
+					for (std::size_t c = 0; c < m; ++c)
+						x[i * m + c] = x[i * m + c] / l[i * _n + i];
+				}
+			}
+			
+			// D Z = Y
+			if (Unit) {
+				for (std::size_t i = 0; i < _n; ++i) {
+					for (std::size_t c = 0; c < m; ++c)
+						x[i * m + c] = x[i * m + c] / l[i * _n + i];
+				}
+			}
+			
+			// L^H X = Z
+			for (std::size_t i = _n; i-- > 0; ) {
+				for (std::size_t k = i + 1; k < _n; ++k) {
+					value_type const v = detail::conjugate(l[k * _n + i]);
+					
+					for (std::size_t c = 0; c < m; ++c)
+						x[i * m + c] = x[i * m + c] - v * x[k * m + c];
+				}
+				
+				if (!Unit) {
+					for (std::size_t c = 0; c < m; ++c)
+						x[i * m + c] = x[i * m + c] / l[i * _n + i];
+				}
+			}
+			
+			return b;
+		}
+		
+		Matrix inverse() const {
+			return solve(shape::identity(_n));
+		}
+	private:
+		void check_factored() const {
+			if (!_factored) {
+				if (Unit)
+					throw math::singular();
+				
+				throw not_positive_definite();
+			}
+		}
+		
+		Matrix			_l;
+		std::size_t		_n;
+		bool			_factored = false;
+	};
+	
+	template <typename Matrix>
+	using ldlt_decomposition = cholesky_decomposition<Matrix, true>;
+	
+	template <typename Matrix>
+	cholesky_decomposition<typename std::decay<Matrix>::type> cholesky(Matrix && a) {
+		return cholesky_decomposition<typename std::decay<Matrix>::type>(std::forward<Matrix>(a));
+	}
+	
+	template <typename Matrix>
+	ldlt_decomposition<typename std::decay<Matrix>::type> ldlt(Matrix && a) {
+		return ldlt_decomposition<typename std::decay<Matrix>::type>(std::forward<Matrix>(a));
+	}
+}
+
+#endif
@@ -11,6 +11,7 @@
 #define math_constant_h
 
 #include <ratio>
+#include <type_traits>
 #include "core.h"
 
 namespace math {
@@ -47,6 +48,14 @@ namespace math {
 			};
 		}
 		
+		namespace detail {
+			template <typename T>
+			struct is_complex : std::false_type { };
+			
+			template <typename R, typename I>
+			struct is_complex<_complex<R, I>> : std::true_type { };
+		}
+		
 		template <std::intmax_t N, std::intmax_t D, std::intmax_t iN = 0, std::intmax_t iD = 1>
 		using complex = detail::_complex<std::ratio<N,D>, std::ratio<iN, iD>>;
 		
@@ -94,7 +103,7 @@ namespace math {
 			struct _complex_divide {
 			private:
 				typedef complex_real<complex_multiply<C2, complex_conjugate<C2>>> norm2;
-				typedef complex_multiply<C1, C2> prod;
+				typedef complex_multiply<C1, complex_conjugate<C2>> prod;
 			public:
 				typedef detail::_complex<std::ratio_divide<complex_real<prod>, norm2>, std::ratio_divide<complex_imag<prod>, norm2>> type;
 			};
@@ -31,6 +31,10 @@ namespace math {
 		template <typename T, typename = typename std::enable_if<std::is_floating_point<T>::value>::type>
 		constexpr explicit operator std::complex<T>() const { return std::complex<T>(1); }
 	};
+	
+	// defined in core.cpp
+	extern additive_identity_tag			additive_identity;
+	extern multiplicative_identity_tag		multiplicative_identity;
 		
 	// used to specify an "infinitesimal"
 	// aka, the smallest reasonable value where we don't end up ruining our accuracy because of floating point or any other issue.
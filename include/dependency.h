@@ -0,0 +1,103 @@
+//
+//  dependency.h
+//  math
+//
+//  Created by Patrick Sauter on 10/19/26.
+//  Copyright (c) 2026 Patrick Sauter. All rights reserved.
+//
+
+#ifndef math_dependency_h
+#define math_dependency_h
+
+// compile time record of which arguments an analytic functor actually reads.
+//		dependencies<multiply<exp<x>, sin<z>>>::value == 0b101
+// bit N is set if the functor (or anything inside it) uses pat::select<N>.
+// functors we can't see inside of are assumed to read all of their arguments.
+
+#include <cstdint>
+#include <type_traits>
+
+#include "analytic.h"
+#include "numeric_derivative.h"
+
+namespace math {
+	namespace analytic {
+		namespace detail {
+			constexpr std::uint64_t all_dependencies = ~std::uint64_t(0);
+			
+			// functors inheriting from math::function know how many arguments they take, everything else could take any.
+			template <typename T, typename = void>
+			struct _arity_dependencies {
+				static constexpr std::uint64_t value = all_dependencies;
+			};
+			template <typename T>
+			struct _arity_dependencies<T, typename std::enable_if<(T::arity < 64)>::type> {
+				static constexpr std::uint64_t value = (std::uint64_t(1) << T::arity) - 1;
+			};
+			
+			template <typename T>
+			struct _dependencies : _arity_dependencies<T> { };
+			
+			template <std::intmax_t N, std::intmax_t D, std::intmax_t iN, std::intmax_t iD>
+			struct _dependencies<complex<N,D,iN,iD>> {
+				static constexpr std::uint64_t value = 0;
+			};
+			
+			template <std::size_t N>
+			struct _dependencies<pat::select<N>> {
+				static constexpr std::uint64_t value = (N < 64 ? std::uint64_t(1) << N : all_dependencies);
+			};
+			
+			template <typename F, typename G>
+			struct _binary_dependencies {
+				static constexpr std::uint64_t value = _dependencies<F>::value | _dependencies<G>::value;
+			};
+			
+			template <typename F, typename G> struct _dependencies<___multiply<F,G>>	: _binary_dependencies<F,G> { };
+			template <typename F, typename G> struct _dependencies<___add<F,G>>			: _binary_dependencies<F,G> { };
+			template <typename F, typename G> struct _dependencies<___pow<F,G>>			: _binary_dependencies<F,G> { };
+			
+			template <typename X> struct _dependencies<__exp<X>>	: _dependencies<X> { };
+			template <typename X> struct _dependencies<__ln<X>>		: _dependencies<X> { };
+			template <typename X> struct _dependencies<__sin<X>>	: _dependencies<X> { };
+			template <typename X> struct _dependencies<__cos<X>>	: _dependencies<X> { };
+			template <typename X> struct _dependencies<__tan<X>>	: _dependencies<X> { };
+			template <typename X> struct _dependencies<__asin<X>>	: _dependencies<X> { };
+			template <typename X> struct _dependencies<__acos<X>>	: _dependencies<X> { };
+			template <typename X> struct _dependencies<__atan<X>>	: _dependencies<X> { };
+			template <typename X> struct _dependencies<__gamma<X>>	: _dependencies<X> { };
+			
+			// a numeric derivative reads whatever the functor it differentiates reads.
+			template <typename F, std::size_t N, std::size_t X>
+			struct _dependencies<numeric_derivative<F,N,X>> : _dependencies<F> { };
+			
+			// compose<F, G...> passes the result of G_i as argument i of F, so it reads what the G_i that F reads do.
+			template <typename F, typename ... G>
+			struct _dependencies<pat::compose<F, G...>> {
+			private:
+				static constexpr std::uint64_t compose(std::uint64_t f, std::size_t i) {
+					return 0;
+				}
+				template <typename ... Rest>
+				static constexpr std::uint64_t compose(std::uint64_t f, std::size_t i, std::uint64_t g, Rest ... rest) {
+					return (f >> i & 1 ? g : 0) | compose(f, i + 1, rest ...);
+				}
+			public:
+				static constexpr std::uint64_t value = compose(_dependencies<F>::value, 0, _dependencies<G>::value ...);
+			};
+		}
+		
+		template <typename F>
+		using dependencies = std::integral_constant<std::uint64_t, detail::_dependencies<F>::value>;
+		
+		// true if F reads argument N
+		template <typename F, std::size_t N>
+		using depends_on = std::integral_constant<bool, (N < 64 ? (dependencies<F>::value >> N) & 1 : dependencies<F>::value == detail::all_dependencies)>;
+		
+		// true if F reads none of the arguments in Mask
+		template <typename F, std::uint64_t Mask>
+		using independent_of = std::integral_constant<bool, (dependencies<F>::value & Mask) == 0>;
+	}
+}
+
+#endif
@@ -0,0 +1,754 @@
+//
+//  dmatrix.h
+//  math
+//
+//  Created by Patrick Sauter on 10/19/26.
+//  Copyright (c) 2026 Patrick Sauter. All rights reserved.
+//
+
+#ifndef math_dmatrix_h
+#define math_dmatrix_h
+
+// matrices and vectors whose size is only known at run time.  math::matrix is a std::array, so its size is part of
+// the type and it lives wherever it is declared, usually the stack.  dmatrix keeps the same row major layout on the
+// heap, aligned to 64 bytes so the gemm kernels and vector loads never straddle a cache line at the start of a row.
+//
+// the interface follows matrix, rows(), cols(), row(i) and col(j) ranges, [] on the flat storage, and the same
+// operators.  (i, j) indexes an entry.  sizes that don't fit throw std::invalid_argument.  fixed size matrices convert
+// to dmatrix implicitly, and back explicitly (checking the size), and mixed arithmetic gives a dmatrix.
+
+#include <cstdlib>
+#include <cstddef>
+#include <new>
+#include <cassert>
+#include <complex>
+#include <functional>
+#include <vector>
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+#include <initializer_list>
+
+#include "core.h"
+#include "vector.h"
+#include "gemm.h"
+
+namespace math {
+	namespace detail {
+		// std::allocator with the alignment raised to Align bytes
+		template <typename T, std::size_t Align = 64>
+		struct aligned_allocator {
+			typedef T value_type;
+			
+			template <typename U>
+			struct rebind { typedef aligned_allocator<U, Align> other; };
+			
+			aligned_allocator() = default;
+			
+			template <typename U>
+			aligned_allocator(aligned_allocator<U, Align> const &) { }
+			
+			T * allocate(std::size_t n) {
+				void * p = nullptr;
+				
+				if (n > 0 && ::posix_memalign(&p, Align, n * sizeof(T)) != 0)
+					throw std::bad_alloc();
+				
+				return static_cast<T *>(p);
+			}
+			
+			void deallocate(T * p, std::size_t) { std::free(p); }
+			
+			// default initialisation, so new storage isn't written, and its pages aren't touched, until dmatrix fills it
+			template <typename U>
+			void construct(U * p) { ::new (static_cast<void *>(p)) U; }
+			template <typename U, typename... Args>
+			void construct(U * p, Args &&... args) { ::new (static_cast<void *>(p)) U(std::forward<Args>(args)...); }
+			
+			template <typename U>
+			bool operator==(aligned_allocator<U, Align> const &) const { return true; }
+			template <typename U>
+			bool operator!=(aligned_allocator<U, Align> const &) const { return false; }
+		};
+		
+		inline void check_size(bool ok, char const * what) {
+			if (!ok)
+				throw std::invalid_argument(what);
+		}
+		
+		// base of the elementwise expressions below, E has rows(), cols() and operator[] over the entries, and
+		// aliases(p, q, dense), whether it reads the storage [p, q).  dense means that storage is a row major matrix
+		// the size of E, so operands reading it entry for entry don't count
+		template <typename E>
+		struct dexpr {
+			E const & self() const { return static_cast<E const &>(*this); }
+		};
+		
+		// whether [a, b) and [c, d) share any bytes
+		inline bool overlap(void const * a, void const * b, void const * c, void const * d) {
+			std::less<void const *> less;
+			
+			return less(a, d) && less(c, b);
+		}
+	}
+	
+	template <typename Type = reals_t>
+	class dmatrix {
+	public:
+		static_assert(check::ring<Type>::value,
+					  "Assertion failed, matrix type not a Ring.");
+		
+		typedef Type											value_type;
+		typedef std::vector<Type, detail::aligned_allocator<Type>>	storage_type;
+		
+		typedef typename storage_type::iterator					iterator;
+		typedef typename storage_type::const_iterator			const_iterator;
+		
+		typedef pat::step_iterator<value_type*>					col_iterator;
+		typedef pat::step_iterator<value_type const*>			const_col_iterator;
+		
+		typedef value_type*			row_iterator;
+		typedef value_type const*	const_row_iterator;
+		
+		typedef iterator_range<row_iterator> row_t;
+		typedef iterator_range<const_row_iterator> const_row_t;
+		
+		typedef iterator_range<col_iterator> col_t;
+		typedef iterator_range<const_col_iterator> const_col_t;
+		
+		dmatrix() = default;
+		
+		// large matrices are filled by the threads of for_entries, so on a NUMA machine each part of the storage lands
+		// on the node of the thread that works on it later
+		dmatrix(std::size_t rows, std::size_t cols) : dmatrix(rows, cols, value_type{}) { }
+		dmatrix(std::size_t rows, std::size_t cols, value_type const & f) : _rows(rows), _cols(cols), _data(rows * cols) {
+			fill(f);
+		}
+		
+		// entries row by row
+		dmatrix(std::size_t rows, std::size_t cols, std::initializer_list<value_type> L) : dmatrix(rows, cols) {
+			detail::check_size(L.size() == size(), "Initializer list doesn't match the matrix size.");
+			
+			std::copy(L.begin(), L.end(), _data.begin());
+		}
+		
+		template <std::size_t N, std::size_t M>
+		dmatrix(matrix<Type, N, M> const & m) : _rows(N), _cols(M), _data(m.begin(), m.end()) { }
+		
+		// evaluates an expression like A + B * s in one pass
+		template <typename E>
+		dmatrix(detail::dexpr<E> const & expression);
+		
+		dmatrix(dmatrix const &) = default;
+		dmatrix(dmatrix &&) = default;
+		
+		dmatrix& operator=(dmatrix const &) = default;
+		dmatrix& operator=(dmatrix &&) = default;
+		
+		template <typename E>
+		dmatrix& operator=(detail::dexpr<E> const & expression);
+		
+		template <std::size_t N, std::size_t M>
+		explicit operator matrix<Type, N, M>() const {
+			detail::check_size(_rows == N && _cols == M, "Matrix sizes don't match.");
+			
+			matrix<Type, N, M> m;
+			std::copy(_data.begin(), _data.end(), m.begin());
+			
+			return m;
+		}
+		
+		static dmatrix identity(std::size_t n) {
+			dmatrix m(n, n, value_type(math::additive_identity));
+			
+			for (std::size_t i = 0; i < n; ++i)
+				m(i, i) = value_type(math::multiplicative_identity);
+			
+			return m;
+		}
+		
+		std::size_t rows() const { return _rows; }
+		std::size_t cols() const { return _cols; }
+		std::size_t size() const { return _data.size(); }
+		bool empty() const { return _data.empty(); }
+		
+		// contents are lost
+		void resize(std::size_t rows, std::size_t cols) {
+			_rows = rows;
+			_cols = cols;
+			storage_type(rows * cols).swap(_data);
+			fill(value_type{});
+		}
+		
+		value_type * data() { return _data.data(); }
+		value_type const * data() const { return _data.data(); }
+		
+		iterator begin() { return _data.begin(); }
+		iterator end() { return _data.end(); }
+		const_iterator begin() const { return _data.begin(); }
+		const_iterator end() const { return _data.end(); }
+		
+		value_type & operator[](std::size_t i) { return _data[i]; }
+		value_type const & operator[](std::size_t i) const { return _data[i]; }
+		
+		value_type & operator()(std::size_t i, std::size_t j) { return _data[i * _cols + j]; }
+		value_type const & operator()(std::size_t i, std::size_t j) const { return _data[i * _cols + j]; }
+		
+		row_t row(std::size_t index) {
+			assert(index < rows());
+			
+			row_iterator	r(data() + index * cols());
+			
+			return make_range(r, r + cols());
+		}
+		
+		const_row_t row(std::size_t index) const {
+			assert(index < rows());
+			
+			const_row_iterator	r(data() + index * cols());
+			
+			return make_range(r, r + cols());
+		}
+		
+		col_t col(std::size_t index) {
+			assert(index < cols());
+			
+			col_iterator	c(data() + index, cols());
+			
+			return make_range(c, c + rows());
+		}
+		
+		const_col_t col(std::size_t index) const {
+			assert(index < cols());
+			
+			const_col_iterator	c(data() + index, cols());
+			
+			return make_range(c, c + rows());
+		}
+	private:
+		void fill(value_type const & f) {
+			value_type * p = _data.data();
+			
+			for_entries(_data.size(), [&](std::size_t first, std::size_t last) {
+				std::fill(p + first, p + last, f);
+			});
+		}
+		
+		std::size_t		_rows = 0, _cols = 0;
+		storage_type	_data;
+	};
+	
+	// a column, dmatrix with one column and a size constructor
+	template <typename Type = reals_t>
+	class dvector : public dmatrix<Type> {
+	public:
+		dvector() = default;
+		explicit dvector(std::size_t n) : dmatrix<Type>(n, 1) { }
+		dvector(std::size_t n, Type const & f) : dmatrix<Type>(n, 1, f) { }
+		dvector(std::initializer_list<Type> L) : dmatrix<Type>(L.size(), 1, L) { }
+		
+		dvector(dmatrix<Type> const & m) : dmatrix<Type>(m) {
+			detail::check_size(m.cols() == 1, "A vector has one column.");
+		}
+		
+		template <std::size_t N>
+		dvector(vector<Type, N> const & v) : dmatrix<Type>(v) { }
+		
+		template <typename E>
+		dvector(detail::dexpr<E> const & expression) : dmatrix<Type>(expression) {
+			detail::check_size(this->cols() == 1, "A vector has one column.");
+		}
+		
+		dvector(dvector const &) = default;
+		dvector(dvector &&) = default;
+		
+		dvector& operator=(dvector const &) = default;
+		dvector& operator=(dvector &&) = default;
+		
+		template <typename E>
+		dvector& operator=(detail::dexpr<E> const & expression) {
+			detail::check_size(expression.self().cols() == 1, "A vector has one column.");
+			dmatrix<Type>::operator=(expression);
+			
+			return *this;
+		}
+		
+		void resize(std::size_t n) { dmatrix<Type>::resize(n, 1); }
+	};
+	
+	namespace detail {
+		// any ring, a row of a times b at a time so b is read along its rows
+		template <typename T>
+		void multiply(std::size_t n, std::size_t m, std::size_t p, T const * a, T const * b, T * c, std::false_type) {
+			for (std::size_t i = 0; i < n; ++i) {
+				T * out = c + i * p;
+				
+				std::fill(out, out + p, T{});
+				
+				for (std::size_t k = 0; k < m; ++k) {
+					T aik = a[i * m + k];
+					
+					for (std::size_t j = 0; j < p; ++j)
+						out[j] += aik * b[k * p + j];
+				}
+			}
+		}
+		
+		// c = a b for row major n x m and m x p data, c not overlapping either.  gemm once it pays
+		template <typename T>
+		void multiply(std::size_t n, std::size_t m, std::size_t p, T const * a, T const * b, T * c, std::true_type) {
+			if (n * m * p >= gemm_threshold)
+				gemm(n, p, m, T(1), a, m, b, p, T(0), c, p);
+			else
+				multiply(n, m, p, a, b, c, std::false_type{});
+		}
+		
+		template <typename T>
+		dmatrix<T> multiply(T const * a, std::size_t n, std::size_t m, T const * b, std::size_t m2, std::size_t p) {
+			check_size(m == m2, "Matrix sizes don't match for multiplication.");
+			
+			dmatrix<T> c(n, p);
+			
+			multiply(n, m, p, a, b, c.data(), has_gemm<T>{});
+			
+			return c;
+		}
+	}
+	
+	// ------------------------------------------------------
+	// dmatrix == dmatrix
+	
+	template <typename T>
+	bool operator==(dmatrix<T> const & a, dmatrix<T> const & b) {
+		return a.rows() == b.rows() && a.cols() == b.cols() && std::equal(a.begin(), a.end(), b.begin());
+	}
+	template <typename T>
+	bool operator!=(dmatrix<T> const & a, dmatrix<T> const & b) {
+		return !(a == b);
+	}
+	
+	// ------------------------------------------------------
+	// EXPRESSIONS
+	// elementwise arithmetic with a dmatrix on either side builds an expression instead of a result, and the one
+	// loop over the entries runs when it is assigned, so A + B * s - C makes a single pass and no temporaries.
+	// named matrices are held by pointer, temporaries are moved into the expression, so
+	//		auto e = A + f();
+	// keeps f's result alive, though A must outlive e.  each entry of an expression only reads the same entry of its
+	// operands, so assigning it to one of them (A = A + B, A += A * 2) is safe.  operands that read storage in another
+	// order (the views in view.h) say so through aliases(), and the assignment goes through a temporary instead.
+	// matrix products are not elementwise, so they are worked out into a new dmatrix straight away, which is what
+	// makes A = A * B safe.
+	
+	namespace detail {
+		// a named dmatrix or fixed size matrix
+		template <typename T>
+		struct dref : dexpr<dref<T>> {
+			typedef T value_type;
+			
+			dref(T const * p, std::size_t r, std::size_t c) : p(p), r(r), c(c) { }
+			
+			std::size_t rows() const { return r; }
+			std::size_t cols() const { return c; }
+			
+			T const & operator[](std::size_t i) const { return p[i]; }
+			
+			bool aliases(void const * b, void const * e, bool dense) const {
+				return !dense && overlap(p, p + r * c, b, e);
+			}
+			
+			T const *		p;
+			std::size_t		r, c;
+		};
+		
+		// a temporary dmatrix or fixed size matrix, moved in
+		template <typename Matrix>
+		struct dvalue : dexpr<dvalue<Matrix>> {
+			typedef typename Matrix::value_type value_type;
+			
+			explicit dvalue(Matrix && m) : m(std::move(m)) { }
+			
+			std::size_t rows() const { return m.rows(); }
+			std::size_t cols() const { return m.cols(); }
+			
+			value_type const & operator[](std::size_t i) const { return m[i]; }
+			
+			bool aliases(void const *, void const *, bool) const { return false; }
+			
+			Matrix		m;
+		};
+		
+		template <typename L, typename R, typename Op>
+		struct dbinary : dexpr<dbinary<L,R,Op>> {
+			typedef typename std::decay<decltype(Op()(std::declval<L>()[0], std::declval<R>()[0]))>::type value_type;
+			
+			dbinary(L l, R r) : l(std::move(l)), r(std::move(r)) {
+				check_size(this->l.rows() == this->r.rows() && this->l.cols() == this->r.cols(), "Matrix sizes don't match.");
+			}
+			
+			std::size_t rows() const { return l.rows(); }
+			std::size_t cols() const { return l.cols(); }
+			
+			value_type operator[](std::size_t i) const { return Op()(l[i], r[i]); }
+			
+			bool aliases(void const * b, void const * e, bool dense) const {
+				return l.aliases(b, e, dense) || r.aliases(b, e, dense);
+			}
+			
+			L		l;
+			R		r;
+		};
+		
+		// E op s, or s op E when Left is false
+		template <typename E, typename Scalar, typename Op, bool Left = true>
+		struct dscalar : dexpr<dscalar<E,Scalar,Op,Left>> {
+			typedef typename std::decay<decltype(Op()(std::declval<E>()[0], std::declval<Scalar>()))>::type value_type;
+			
+			dscalar(E e, Scalar s) : e(std::move(e)), s(s) { }
+			
+			std::size_t rows() const { return e.rows(); }
+			std::size_t cols() const { return e.cols(); }
+			
+			value_type operator[](std::size_t i) const { return (Left ? Op()(e[i], s) : Op()(s, e[i])); }
+			
+			bool aliases(void const * b, void const * q, bool dense) const { return e.aliases(b, q, dense); }
+			
+			E			e;
+			Scalar		s;
+		};
+		
+		template <typename E>
+		struct dnegate : dexpr<dnegate<E>> {
+			typedef typename E::value_type value_type;
+			
+			explicit dnegate(E e) : e(std::move(e)) { }
+			
+			std::size_t rows() const { return e.rows(); }
+			std::size_t cols() const { return e.cols(); }
+			
+			value_type operator[](std::size_t i) const { return -e[i]; }
+			
+			bool aliases(void const * b, void const * q, bool dense) const { return e.aliases(b, q, dense); }
+			
+			E		e;
+		};
+		
+		struct dadd { template <typename A, typename B> auto operator()(A const & a, B const & b) const { return a + b; } };
+		struct dsubtract { template <typename A, typename B> auto operator()(A const & a, B const & b) const { return a - b; } };
+		struct dmultiply { template <typename A, typename B> auto operator()(A const & a, B const & b) const { return a * b; } };
+		struct ddivide { template <typename A, typename B> auto operator()(A const & a, B const & b) const { return a / b; } };
+		
+		// the operand of an expression for each kind of argument
+		template <typename T>
+		dref<T> wrap(dmatrix<T> const & m) { return dref<T>(m.data(), m.rows(), m.cols()); }
+		template <typename T>
+		dvalue<dmatrix<T>> wrap(dmatrix<T> && m) { return dvalue<dmatrix<T>>(std::move(m)); }
+		template <typename T, std::size_t N, std::size_t M>
+		dref<T> wrap(matrix<T,N,M> const & m) { return dref<T>(m.data(), N, M); }
+		template <typename T, std::size_t N, std::size_t M>
+		dvalue<matrix<T,N,M>> wrap(matrix<T,N,M> && m) { return dvalue<matrix<T,N,M>>(std::move(m)); }
+		template <typename E>
+		E wrap(dexpr<E> const & e) { return e.self(); }
+		
+		template <typename X>
+		struct is_fixed : std::false_type { };
+		template <typename T, std::size_t N, std::size_t M>
+		struct is_fixed<matrix<T,N,M>> : std::true_type { };
+		
+		template <typename X>
+		struct is_dmatrix : std::false_type { };
+		template <typename T>
+		struct is_dmatrix<dmatrix<T>> : std::true_type { };
+		template <typename T>
+		struct is_dmatrix<dvector<T>> : std::true_type { };
+		
+		template <typename X, typename D = typename std::decay<X>::type>
+		struct is_dynamic : std::integral_constant<bool, is_dmatrix<D>::value || std::is_base_of<dexpr<D>, D>::value> { };
+		
+		template <typename X, typename D = typename std::decay<X>::type, typename = void>
+		struct is_dense : is_fixed<D> { };
+		template <typename X, typename D>
+		struct is_dense<X, D, typename std::enable_if<is_dynamic<D>::value>::type> : std::true_type { };
+		
+		// two matrices, at least one of them dynamic, so fixed size arithmetic is left alone
+		template <typename A, typename B>
+		struct dynamic_pair : std::integral_constant<bool,
+			is_dense<A>::value && is_dense<B>::value && (is_dynamic<A>::value || is_dynamic<B>::value)
+		> { };
+		
+		template <typename A, typename = void>
+		struct dense_value { typedef void type; };
+		template <typename A>
+		struct dense_value<A, typename std::enable_if<is_dense<A>::value>::type> {
+			typedef typename std::decay<A>::type::value_type type;
+		};
+		
+		// a dynamic matrix times a scalar, the scalar type has to work with the entries
+		template <typename T, typename Scalar, typename Op, bool Left>
+		struct scalar_op;
+		template <typename T, typename Scalar>
+		struct scalar_op<T, Scalar, dmultiply, true> : std::integral_constant<bool, pat::traits::has_multiply<T, Scalar, T>::value> { };
+		template <typename T, typename Scalar>
+		struct scalar_op<T, Scalar, dmultiply, false> : std::integral_constant<bool, pat::traits::has_multiply<Scalar, T, T>::value> { };
+		template <typename T, typename Scalar>
+		struct scalar_op<T, Scalar, ddivide, true> : std::integral_constant<bool, pat::traits::has_divide<T, Scalar, T>::value> { };
+		
+		template <typename A, typename Scalar, typename Op, bool Left = true, bool = is_dynamic<A>::value && !is_dense<Scalar>::value>
+		struct dynamic_scalar : std::false_type { };
+		template <typename A, typename Scalar, typename Op, bool Left>
+		struct dynamic_scalar<A, Scalar, Op, Left, true> : scalar_op<typename dense_value<A>::type, Scalar, Op, Left> { };
+		
+		// row major data for a product, expressions are evaluated first
+		template <typename T>
+		struct dense_data {
+			T const *		p;
+			std::size_t		r, c;
+			dmatrix<T>		hold;
+		};
+		
+		template <typename T>
+		dense_data<T> data_of(dmatrix<T> const & m) { return { m.data(), m.rows(), m.cols(), {} }; }
+		template <typename T, std::size_t N, std::size_t M>
+		dense_data<T> data_of(matrix<T,N,M> const & m) { return { m.data(), N, M, {} }; }
+		template <typename E>
+		dense_data<typename E::value_type> data_of(dexpr<E> const & e) {
+			dense_data<typename E::value_type> d{ nullptr, 0, 0, dmatrix<typename E::value_type>(e) };
+			
+			d.p = d.hold.data();
+			d.r = d.hold.rows();
+			d.c = d.hold.cols();
+			
+			return d;
+		}
+	}
+	
+	template <typename Type>
+	template <typename E>
+	dmatrix<Type>::dmatrix(detail::dexpr<E> const & expression) : _rows(expression.self().rows()), _cols(expression.self().cols()), _data(_rows * _cols) {
+		auto const & e = expression.self();
+		value_type * p = _data.data();
+		
+		for_entries(_data.size(), [&](std::size_t first, std::size_t last) {
+			for (std::size_t i = first; i < last; ++i)
+				p[i] = Type(e[i]);
+		});
+	}
+	
+	template <typename Type>
+	template <typename E>
+	dmatrix<Type>& dmatrix<Type>::operator=(detail::dexpr<E> const & expression) {
+		auto const & e = expression.self();
+		
+		// a new size means new storage, which e may still be reading from
+		if (e.rows() != _rows || e.cols() != _cols || e.aliases(data(), data() + size(), true))
+			return *this = dmatrix(expression);
+		
+		value_type * p = _data.data();
+		
+		for_entries(_data.size(), [&](std::size_t first, std::size_t last) {
+			for (std::size_t i = first; i < last; ++i)
+				p[i] = Type(e[i]);
+		});
+		
+		return *this;
+	}
+	
+	// ------------------------------------------------------
+	// dmatrix * dmatrix, and mixed with fixed size matrices, evaluated at once
+	
+	template <typename A, typename B, typename = typename std::enable_if<detail::dynamic_pair<A,B>::value>::type>
+	auto operator*(A && a, B && b) -> dmatrix<typename detail::dense_value<A>::type> {
+		static_assert(std::is_same<typename detail::dense_value<A>::type, typename detail::dense_value<B>::type>::value,
+					  "Assertion failed, matrix entry types differ.");
+		
+		auto x = detail::data_of(a);
+		auto y = detail::data_of(b);
+		
+		return detail::multiply(x.p, x.r, x.c, y.p, y.r, y.c);
+	}
+	
+	// ------------------------------------------------------
+	// dmatrix + dmatrix, dmatrix - dmatrix, -dmatrix, and mixed with fixed size matrices
+	
+	template <typename A, typename B, typename = typename std::enable_if<detail::dynamic_pair<A,B>::value>::type>
+	auto operator+(A && a, B && b) {
+		auto l = detail::wrap(std::forward<A>(a));
+		auto r = detail::wrap(std::forward<B>(b));
+		
+		return detail::dbinary<decltype(l), decltype(r), detail::dadd>(std::move(l), std::move(r));
+	}
+	
+	template <typename A, typename B, typename = typename std::enable_if<detail::dynamic_pair<A,B>::value>::type>
+	auto operator-(A && a, B && b) {
+		auto l = detail::wrap(std::forward<A>(a));
+		auto r = detail::wrap(std::forward<B>(b));
+		
+		return detail::dbinary<decltype(l), decltype(r), detail::dsubtract>(std::move(l), std::move(r));
+	}
+	
+	template <typename A, typename = typename std::enable_if<detail::is_dynamic<A>::value>::type>
+	auto operator-(A && a) {
+		auto e = detail::wrap(std::forward<A>(a));
+		
+		return detail::dnegate<decltype(e)>(std::move(e));
+	}
+	
+	// ------------------------------------------------------
+	// dmatrix * Scalar, Scalar * dmatrix, dmatrix / Scalar
+	
+	template <typename A, typename Scalar, typename = typename std::enable_if<detail::dynamic_scalar<A, Scalar, detail::dmultiply>::value>::type>
+	auto operator*(A && a, Scalar const & s) {
+		auto e = detail::wrap(std::forward<A>(a));
+		
+		return detail::dscalar<decltype(e), Scalar, detail::dmultiply>(std::move(e), s);
+	}
+	
+	template <typename Scalar, typename A, typename = typename std::enable_if<detail::dynamic_scalar<A, Scalar, detail::dmultiply, false>::value>::type>
+	auto operator*(Scalar const & s, A && a) {
+		auto e = detail::wrap(std::forward<A>(a));
+		
+		return detail::dscalar<decltype(e), Scalar, detail::dmultiply, false>(std::move(e), s);
+	}
+	
+	template <typename A, typename Scalar, typename = typename std::enable_if<detail::dynamic_scalar<A, Scalar, detail::ddivide>::value>::type>
+	auto operator/(A && a, Scalar const & s) {
+		auto e = detail::wrap(std::forward<A>(a));
+		
+		return detail::dscalar<decltype(e), Scalar, detail::ddivide>(std::move(e), s);
+	}
+	
+	// ------------------------------------------------------
+	// dmatrix += matrix, dmatrix -= matrix, dmatrix *= Scalar, dmatrix /= Scalar, in place without temporaries
+	
+	template <typename T, typename B, typename = typename std::enable_if<detail::is_dense<B>::value>::type>
+	dmatrix<T>& operator+=(dmatrix<T> & a, B && b) {
+		auto e = detail::wrap(std::forward<B>(b));
+		
+		detail::check_size(a.rows() == e.rows() && a.cols() == e.cols(), "Matrix sizes don't match.");
+		
+		if (e.aliases(a.data(), a.data() + a.size(), true))
+			return a += dmatrix<T>(e);
+		
+		for_entries(a.size(), [&](std::size_t first, std::size_t last) {
+			for (std::size_t i = first; i < last; ++i)
+				a[i] = a[i] + e[i];
+		});
+		
+		return a;
+	}
+	template <typename T, typename B, typename = typename std::enable_if<detail::is_dense<B>::value>::type>
+	dmatrix<T>& operator-=(dmatrix<T> & a, B && b) {
+		auto e = detail::wrap(std::forward<B>(b));
+		
+		detail::check_size(a.rows() == e.rows() && a.cols() == e.cols(), "Matrix sizes don't match.");
+		
+		if (e.aliases(a.data(), a.data() + a.size(), true))
+			return a -= dmatrix<T>(e);
+		
+		for_entries(a.size(), [&](std::size_t first, std::size_t last) {
+			for (std::size_t i = first; i < last; ++i)
+				a[i] = a[i] - e[i];
+		});
+		
+		return a;
+	}
+	
+	template <typename T, typename Scalar,
+		typename = typename std::enable_if<
+			pat::traits::has_multiply<T, Scalar, T>::value
+		>::type>
+	dmatrix<T>& operator*=(dmatrix<T> & a, Scalar const & s) {
+		for_entries(a.size(), [&](std::size_t first, std::size_t last) {
+			for (std::size_t i = first; i < last; ++i)
+				a[i] = a[i] * s;
+		});
+		
+		return a;
+	}
+	template <typename T, typename Scalar,
+		typename = typename std::enable_if<
+			pat::traits::has_divide<T, Scalar, T>::value
+		>::type>
+	dmatrix<T>& operator/=(dmatrix<T> & a, Scalar const & s) {
+		for_entries(a.size(), [&](std::size_t first, std::size_t last) {
+			for (std::size_t i = first; i < last; ++i)
+				a[i] = a[i] / s;
+		});
+		
+		return a;
+	}
+	
+	// --------------------------------------------------
+	// TRANSPOSE, in tiles so both sides stay in cache
+	
+	template <typename T>
+	dmatrix<T> transpose(dmatrix<T> const & a) {
+		constexpr std::size_t tile = 32;
+		
+		dmatrix<T> m(a.cols(), a.rows());
+		
+		for (std::size_t i0 = 0; i0 < a.rows(); i0 += tile) {
+			for (std::size_t j0 = 0; j0 < a.cols(); j0 += tile) {
+				std::size_t i1 = std::min(a.rows(), i0 + tile), j1 = std::min(a.cols(), j0 + tile);
+				
+				for (std::size_t i = i0; i < i1; ++i)
+					for (std::size_t j = j0; j < j1; ++j)
+						m(j, i) = a(i, j);
+			}
+		}
+		
+		return m;
+	}
+	
+	// ------------------------------------------------------
+	// dot product and norm of dvectors
+	
+	template <typename T>
+	reals_t inner_product(dvector<T> const & a, dvector<T> const & b) {
+		detail::check_size(a.size() == b.size(), "Vector sizes don't match.");
+		
+		reals_t sum = 0.0;
+		
+		for (std::size_t i = 0; i < a.size(); ++i)
+			sum += reals_t(a[i] * b[i]);
+		
+		return sum;
+	}
+	
+	inline reals_t inner_product(dvector<complex_t> const & a, dvector<complex_t> const & b) {
+		detail::check_size(a.size() == b.size(), "Vector sizes don't match.");
+		
+		reals_t sum = 0.0;
+		
+		for (std::size_t i = 0; i < a.size(); ++i)
+			sum += std::real(a[i] * std::conj(b[i]));
+		
+		return sum;
+	}
+	
+	template <typename T>
+	reals_t norm(dvector<T> const & a) {
+		return sqrt(inner_product(a,a));
+	}
+}
+
+namespace std {
+	template <typename T>
+	ostream & operator<<(ostream& out, math::dmatrix<T> const & a) {
+		out << "{" << std::endl;
+		
+		for (std::size_t i = 0; i < a.rows(); ++i) {
+			for (auto j : a.row(i)) {
+				out << std::setw(3) << j;
+			}
+			out << std::endl;
+		}
+		
+		out << "}";
+		
+		return out;
+	}
+}
+
+#endif
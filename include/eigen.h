@@ -0,0 +1,542 @@
+//
+//  eigen.h
+//  math
+//
+//  Created by Patrick Sauter on 10/19/26.
+//  Copyright (c) 2026 Patrick Sauter. All rights reserved.
+//
+
+#ifndef math_eigen_h
+#define math_eigen_h
+
+// eigenvalues and eigenvectors of a symmetric (hermitian for complex entries) matrix, A = V diag(w) V^H.
+//
+//		auto e = eigh(A);				// all of them, e.values() ascending, column j of e.vectors() goes with value j
+//		eigh(A, false);					// the values alone
+//		eigh(A, first, count);			// values first to first + count - 1 in ascending order, and their vectors
+//		eigvalsh(A);					// eigh(A, false).values()
+//
+// householder reflections take A to a real tridiagonal T = Q^H A Q (the phases of the complex subdiagonal are scaled
+// into Q), and the whole spectrum comes from implicit QL with wilkinson shifts on T.  the values alone are O(n^2)
+// after the reduction, the vectors rotate Q along and are O(n^3) again.
+//
+// for part of the spectrum each value is found by bisection on sturm counts of T, which goes straight to the k-th
+// smallest, and its vector by inverse iteration on T, reorthogonalised within a cluster of close values, then taken
+// back through the reflections.  that's O(n) per value and O(n) per vector on top of the reduction, the few lowest
+// modes of a large hessian without paying for the rest.  vectors of a part come back as an n x count dmatrix.
+//
+// only the lower triangle of A is read.  A is taken by value, so eigh(std::move(A)) works in place.
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+#include <complex>
+#include <utility>
+#include <numeric>
+#include <algorithm>
+#include <type_traits>
+
+#include "core.h"
+#include "exceptions.h"
+#include "lu.h"
+#include "qr.h"
+
+namespace math {
+	namespace detail {
+		// the iterations of QL for each eigenvalue before giving up
+		constexpr std::size_t ql_iterations = 30;
+		
+		// Q^H A Q = T for the hermitian n x n matrix at a, lower triangle.  d and e get the diagonal and subdiagonal of
+		// T, e[i] joining i and i + 1, the reflection for column k stays below its subdiagonal with tau[k] beside it,
+		// and phase[i] is the unit scaling of column i of Q that made the subdiagonal real
+		template <typename T>
+		void tridiagonalize(T * a, std::size_t n, real_part_t<T> * d, real_part_t<T> * e, T * tau, T * phase) {
+			using std::real;
+			
+			typedef real_part_t<T> R;
+			
+			T const zero = T(math::additive_identity), one = T(math::multiplicative_identity);
+			
+			std::vector<T> v(n), p(n), pc(n), vc(n);
+			
+			for (std::size_t k = 0; k + 2 < n; ++k) {
+				// column k from row k + 1 down to (beta, 0, ..., 0), householder counts rows from the pointer
+				T const t = tau[k] = householder(a + n, n - 1, n, k);
+				
+				if (t == zero)
+					continue;
+				
+				std::size_t const m = n - k - 1;
+				T * b = a + (k + 1) * n + k + 1;
+				
+				v[0] = one;
+				
+				for (std::size_t i = 1; i < m; ++i)
+					v[i] = a[(k + 1 + i) * n + k];
+				
+				// H^H B H = B - v q^H - q v^H, with p = B v and q = tau p - |tau|^2 (v^H p) v / 2.  only the lower
+				// triangle of B is read or written, each entry below the diagonal counts for the one above it too
+				std::fill(p.begin(), p.begin() + m, zero);
+				
+				for (std::size_t i = 0; i < m; ++i) {
+					T const * r = b + i * n;
+					T const vi = v[i];
+					T s = zero;
+					
+					for (std::size_t j = 0; j < i; ++j) {
+						s = s + r[j] * v[j];
+						p[j] = p[j] + conjugate(r[j]) * vi;
+					}
+					
+					p[i] = p[i] + s + r[i] * vi;
+				}
+				
+				T vp = zero;
+				
+				for (std::size_t i = 0; i < m; ++i)
+					vp = vp + conjugate(v[i]) * p[i];
+				
+				T const h = T(abs2(t) * real(vp) / R(2));
+				
+				for (std::size_t i = 0; i < m; ++i) {
+					p[i] = t * p[i] - h * v[i];
+					pc[i] = conjugate(p[i]);
+					vc[i] = conjugate(v[i]);
+				}
+				
+				for (std::size_t i = 0; i < m; ++i) {
+					T const vi = v[i], pi = p[i];
+					T * r = b + i * n;
+					
+					for (std::size_t j = 0; j <= i; ++j)
+						r[j] = r[j] - vi * pc[j] - pi * vc[j];
+				}
+			}
+			
+			for (std::size_t k = (n < 2 ? 0 : n - 2); k < n; ++k)
+				tau[k] = zero;
+			
+			for (std::size_t i = 0; i < n; ++i)
+				d[i] = real(a[i * n + i]);
+			
+			// D^H T D with D = diag(phase) has |t_i+1,i| below the diagonal
+			if (n > 0)
+				phase[0] = one;
+			
+			for (std::size_t i = 0; i + 1 < n; ++i) {
+				T const s = a[(i + 1) * n + i];
+				R const length = std::sqrt(abs2(s));
+				
+				e[i] = length;
+				phase[i + 1] = (length == R(0) ? phase[i] : phase[i] * s / T(length));
+			}
+			
+			if (n > 0)
+				e[n - 1] = 0;
+		}
+		
+		// Q D Z for the n x cols matrix at z, Q the product of the reflections tridiagonalize left in a.  when Z is I
+		// each reflection only meets the columns the ones after it filled in
+		template <typename T>
+		void tridiagonal_back(T const * a, std::size_t n, T const * tau, T const * phase, T * z, std::size_t cols, bool identity) {
+			for (std::size_t i = 0; i < n; ++i)
+				for (std::size_t c = 0; c < cols; ++c)
+					z[i * cols + c] = phase[i] * z[i * cols + c];
+			
+			std::vector<T> w(cols);
+			
+			// H_0 H_1 ... H_n-3, the last first.  reflect applies H^H, conjugate(tau) makes it H
+			for (std::size_t k = (n < 3 ? 0 : n - 2); k-- > 0; )
+				reflect(a + n, n - 1, n, k, conjugate(tau[k]), z + cols, cols, (identity ? k + 1 : 0), (identity ? cols - k - 1 : cols), w.data());
+		}
+		
+		// the eigenvalues of the symmetric tridiagonal d, e by implicit QL, left in d unsorted.  when z isn't null the
+		// rotations go along its n rows, cols long, so row i ends up the vector for d[i].  rows rather than columns
+		// keep every rotation in two contiguous runs
+		template <typename R, typename T>
+		void tridiagonal_ql(R * d, R * e, std::size_t n, T * z, std::size_t cols) {
+			R const eps = std::numeric_limits<R>::epsilon();
+			
+			for (std::size_t l = 0; l < n; ++l) {
+				for (std::size_t iteration = 0; ; ++iteration) {
+					// the first negligible off diagonal from l, T splits there
+					std::size_t m = l;
+					
+					for (; m + 1 < n; ++m) {
+						if (std::abs(e[m]) <= eps * (std::abs(d[m]) + std::abs(d[m + 1])))
+							break;
+					}
+					
+					if (m == l)
+						break;
+					
+					if (iteration == ql_iterations)
+						throw math::not_converged();
+					
+					// shift by the eigenvalue of the leading 2 x 2 closer to d[l]
+					R g = (d[l + 1] - d[l]) / (R(2) * e[l]);
+					R r = std::hypot(g, R(1));
+					
+					g = d[m] - d[l] + e[l] / (g + (g < 0 ? -r : r));
+					
+					R s = 1, c = 1, p = 0;
+					bool underflow = false;
+					
+					// chase the bulge up from m to l
+					for (std::size_t i = m; i-- > l; ) {
+						R const f = s * e[i], b = c * e[i];
+						
+						e[i + 1] = r = std::hypot(f, g);
+						
+						if (r == R(0)) {
+							d[i + 1] -= p;
+							e[m] = 0;
+							underflow = true;
+							break;
+						}
+						
+						s = f / r;
+						c = g / r;
+						g = d[i + 1] - p;
+						r = (d[i] - g) * s + R(2) * c * b;
+						p = s * r;
+						d[i + 1] = g + p;
+						g = c * r - b;
+						
+						if (z) {
+							T * x = z + i * cols;
+							T * y = x + cols;
+							
+							for (std::size_t k = 0; k < cols; ++k) {
+								T const f = y[k];
+								
+								y[k] = T(s) * x[k] + T(c) * f;
+								x[k] = T(c) * x[k] - T(s) * f;
+							}
+						}
+					}
+					
+					if (underflow)
+						continue;
+					
+					d[l] -= p;
+					e[l] = g;
+					e[m] = 0;
+				}
+			}
+		}
+		
+		// eigenvalues of the tridiagonal d, e below x, the negative pivots of T - x I = L D L^T
+		template <typename R>
+		std::size_t sturm_count(R const * d, R const * e, std::size_t n, R x, R pivmin) {
+			std::size_t count = 0;
+			R q = 1;
+			
+			for (std::size_t i = 0; i < n; ++i) {
+				q = d[i] - x - (i > 0 ? e[i - 1] * e[i - 1] / q : R(0));
+				
+				if (std::abs(q) < pivmin)
+					q = -pivmin;
+				
+				count += (q < 0);
+			}
+			
+			return count;
+		}
+		
+		// the k-th smallest eigenvalue of the tridiagonal d, e by bisection between the gershgorin bounds lo and hi
+		template <typename R>
+		R bisect(R const * d, R const * e, std::size_t n, std::size_t k, R lo, R hi, R pivmin) {
+			R const eps = std::numeric_limits<R>::epsilon();
+			
+			while (hi - lo > R(2) * eps * std::max(std::abs(lo), std::abs(hi)) + pivmin) {
+				R const mid = lo + (hi - lo) / R(2);
+				
+				if (mid <= lo || mid >= hi)
+					break;
+				
+				if (sturm_count(d, e, n, mid, pivmin) > k)
+					hi = mid;
+				else
+					lo = mid;
+			}
+			
+			return lo + (hi - lo) / R(2);
+		}
+		
+		// the eigenvector of the tridiagonal d, e for the eigenvalue w by inverse iteration, into column j of z.  the
+		// others columns of z are the vectors already found that it should be orthogonal to
+		template <typename R>
+		void inverse_iteration(R const * d, R const * e, std::size_t n, R w, R norm, R * z, std::size_t ld, std::size_t j,
+							   std::size_t const * others, std::size_t count)
+		{
+			// T is zero, and the unit vectors are as good as any.  the pivots below would be at the underflow floor
+			// and the iterate would overflow
+			if (norm == R(0)) {
+				for (std::size_t i = 0; i < n; ++i)
+					z[i * ld + j] = R(i == j);
+				
+				return;
+			}
+			
+			R const eps = std::numeric_limits<R>::epsilon();
+			R const small = std::max(eps * norm, std::numeric_limits<R>::min());
+			
+			// T - w I = P L U with partial pivoting, U has two superdiagonals
+			std::vector<R> u0(n), u1(n), u2(n), l(n);
+			std::vector<char> swapped(n);
+			
+			R p = (n > 0 ? d[0] - w : R(0)), q = (n > 1 ? e[0] : R(0));
+			
+			for (std::size_t i = 0; i + 1 < n; ++i) {
+				R const s = e[i], t = d[i + 1] - w, r = (i + 2 < n ? e[i + 1] : R(0));
+				
+				if (std::abs(p) >= std::abs(s)) {
+					swapped[i] = 0;
+					l[i] = (p == R(0) ? R(0) : s / p);
+					u0[i] = p;
+					u1[i] = q;
+					u2[i] = 0;
+					p = t - l[i] * q;
+					q = r;
+				} else {
+					swapped[i] = 1;
+					l[i] = p / s;
+					u0[i] = s;
+					u1[i] = t;
+					u2[i] = r;
+					p = q - l[i] * t;
+					q = -l[i] * r;
+				}
+				
+				if (std::abs(u0[i]) < small)
+					u0[i] = small;
+			}
+			
+			if (n > 0)
+				u0[n - 1] = (std::abs(p) < small ? small : p);
+			
+			std::vector<R> y(n);
+			
+			// anything that isn't orthogonal to the vector, the same every time
+			std::uint32_t seed = 2463534242u;
+			
+			for (std::size_t i = 0; i < n; ++i) {
+				seed ^= seed << 13;
+				seed ^= seed >> 17;
+				seed ^= seed << 5;
+				y[i] = R(seed % 1024 + 1) / R(1024);
+			}
+			
+			for (std::size_t iteration = 0; iteration < 3; ++iteration) {
+				for (std::size_t i = 0; i + 1 < n; ++i) {
+					if (swapped[i])
+						std::swap(y[i], y[i + 1]);
+					
+					y[i + 1] -= l[i] * y[i];
+				}
+				
+				for (std::size_t i = n; i-- > 0; ) {
+					R s = y[i];
+					
+					if (i + 1 < n)
+						s -= u1[i] * y[i + 1];
+					
+					if (i + 2 < n)
+						s -= u2[i] * y[i + 2];
+					
+					y[i] = s / u0[i];
+				}
+				
+				for (std::size_t o = 0; o < count; ++o) {
+					R dot = 0;
+					
+					for (std::size_t i = 0; i < n; ++i)
+						dot += y[i] * z[i * ld + others[o]];
+					
+					for (std::size_t i = 0; i < n; ++i)
+						y[i] -= dot * z[i * ld + others[o]];
+				}
+				
+				R length = 0;
+				
+				for (std::size_t i = 0; i < n; ++i)
+					length += y[i] * y[i];
+				
+				length = std::sqrt(length);
+				
+				for (std::size_t i = 0; i < n; ++i)
+					y[i] = (length == R(0) ? R(i == 0) : y[i] / length);
+			}
+			
+			for (std::size_t i = 0; i < n; ++i)
+				z[i * ld + j] = y[i];
+		}
+	}
+	
+	template <typename Vectors>
+	class eigen_decomposition {
+	public:
+		typedef typename Vectors::value_type			value_type;
+		typedef detail::real_part_t<value_type>			real_type;
+		
+		eigen_decomposition(std::vector<real_type> values, Vectors vectors, bool has_vectors)
+			: _values(std::move(values)), _vectors(std::move(vectors)), _has_vectors(has_vectors) { }
+		
+		std::size_t size() const { return _values.size(); }
+		bool has_vectors() const { return _has_vectors; }
+		
+		// ascending
+		std::vector<real_type> const & values() const { return _values; }
+		
+		// unit columns, column j for values()[j]
+		Vectors const & vectors() const { return _vectors; }
+	private:
+		std::vector<real_type>	_values;
+		Vectors					_vectors;
+		bool					_has_vectors;
+	};
+	
+	// ------------------------------------------------------
+	// the whole spectrum, tridiagonal QL
+	
+	template <typename Matrix, typename M = typename std::decay<Matrix>::type>
+	eigen_decomposition<M> eigh(Matrix && m, bool vectors = true) {
+		typedef detail::square<M> shape;
+		typedef typename shape::value_type T;
+		typedef detail::real_part_t<T> R;
+		
+		static_assert(check::field<T>::value,
+					  "Assertion failed, eigenvalues need a matrix over a field.");
+		
+		M a(std::forward<Matrix>(m));
+		std::size_t const n = shape::size(a);
+		
+		std::vector<R> d(n), e(n);
+		std::vector<T> tau(n), phase(n);
+		
+		detail::tridiagonalize(a.data(), n, d.data(), e.data(), tau.data(), phase.data());
+		
+		M z = shape::identity(n);
+		std::vector<T> zt(vectors ? n * n : 0);
+		
+		// Q D, turned so the vectors are rows for QL
+		if (vectors) {
+			detail::tridiagonal_back(a.data(), n, tau.data(), phase.data(), z.data(), n, true);
+			
+			for (std::size_t i = 0; i < n; ++i)
+				for (std::size_t j = 0; j < n; ++j)
+					zt[j * n + i] = z.data()[i * n + j];
+		}
+		
+		detail::tridiagonal_ql(d.data(), e.data(), n, (vectors ? zt.data() : (T *)nullptr), n);
+		
+		// ascending, the vectors along with them
+		std::vector<std::size_t> order(n);
+		std::iota(order.begin(), order.end(), 0);
+		std::sort(order.begin(), order.end(), [&](std::size_t i, std::size_t j) { return d[i] < d[j]; });
+		
+		std::vector<R> w(n);
+		
+		for (std::size_t j = 0; j < n; ++j)
+			w[j] = d[order[j]];
+		
+		if (vectors) {
+			for (std::size_t i = 0; i < n; ++i)
+				for (std::size_t j = 0; j < n; ++j)
+					z.data()[i * n + j] = zt[order[j] * n + i];
+		}
+		
+		return eigen_decomposition<M>(std::move(w), std::move(z), vectors);
+	}
+	
+	// ------------------------------------------------------
+	// part of the spectrum, the eigenvalues first to first + count - 1 counting up from the smallest, by bisection
+	
+	template <typename Matrix, typename M = typename std::decay<Matrix>::type,
+		typename T = typename detail::square<M>::value_type>
+	eigen_decomposition<dmatrix<T>> eigh(Matrix && m, std::size_t first, std::size_t count, bool vectors = true) {
+		typedef detail::square<M> shape;
+		typedef detail::real_part_t<T> R;
+		
+		static_assert(check::field<T>::value,
+					  "Assertion failed, eigenvalues need a matrix over a field.");
+		
+		M a(std::forward<Matrix>(m));
+		std::size_t const n = shape::size(a);
+		
+		detail::check_size(first + count <= n, "Eigenvalues past the size of the matrix.");
+		
+		std::vector<R> d(n), e(n);
+		std::vector<T> tau(n), phase(n);
+		
+		detail::tridiagonalize(a.data(), n, d.data(), e.data(), tau.data(), phase.data());
+		
+		// gershgorin bounds, and the smallest pivot a sturm count lets through
+		R lo = 0, hi = 0, norm = 0, offdiagonal = 0;
+		
+		for (std::size_t i = 0; i < n; ++i) {
+			R const radius = (i > 0 ? e[i - 1] : R(0)) + (i + 1 < n ? e[i] : R(0));
+			
+			lo = (i == 0 ? d[i] - radius : std::min(lo, d[i] - radius));
+			hi = (i == 0 ? d[i] + radius : std::max(hi, d[i] + radius));
+			offdiagonal = std::max(offdiagonal, e[i] * e[i]);
+		}
+		
+		norm = std::max(std::abs(lo), std::abs(hi));
+		
+		R const pivmin = std::numeric_limits<R>::min() * std::max(R(1), offdiagonal);
+		
+		lo -= R(2) * std::numeric_limits<R>::epsilon() * norm + pivmin;
+		hi += R(2) * std::numeric_limits<R>::epsilon() * norm + pivmin;
+		
+		std::vector<R> w(count);
+		
+		for (std::size_t k = 0; k < count; ++k)
+			w[k] = detail::bisect(d.data(), e.data(), n, first + k, lo, hi, pivmin);
+		
+		dmatrix<T> z(n, vectors ? count : 0, T(math::additive_identity));
+		
+		if (vectors && count > 0) {
+			// the real vectors of T first, values within a thousandth of |T| of each other are a cluster
+			R const eps = std::numeric_limits<R>::epsilon();
+			R const separate = norm * R(1e-3);
+			
+			std::vector<R> y(n * count);
+			std::vector<std::size_t> cluster;
+			R previous = 0;
+			
+			for (std::size_t k = 0; k < count; ++k) {
+				R shift = w[k];
+				
+				if (k > 0 && w[k] - w[k - 1] > separate)
+					cluster.clear();
+				
+				// a repeated value would give the same vector twice, nudge it apart
+				if (k > 0 && shift - previous < R(10) * eps * norm)
+					shift = previous + R(10) * eps * norm;
+				
+				detail::inverse_iteration(d.data(), e.data(), n, shift, norm, y.data(), count, k, cluster.data(), cluster.size());
+				
+				cluster.push_back(k);
+				previous = shift;
+			}
+			
+			for (std::size_t i = 0; i < n * count; ++i)
+				z.data()[i] = T(y[i]);
+			
+			detail::tridiagonal_back(a.data(), n, tau.data(), phase.data(), z.data(), count, false);
+		}
+		
+		return eigen_decomposition<dmatrix<T>>(std::move(w), std::move(z), vectors);
+	}
+	
+	// just the eigenvalues, ascending
+	template <typename Matrix>
+	auto eigvalsh(Matrix && m) {
+		return eigh(std::forward<Matrix>(m), false).values();
+	}
+}
+
+#endif
@@ -25,6 +25,47 @@ namespace math {
 			return "math::none";
 		}
 	};
+	
+	// thrown by symmetric_integral when the integrand turns out not to have the symmetry it was promised
+	class not_invariant : public std::exception {
+	public:
+		virtual char const * what() const noexcept {
+			return "math::not_invariant";
+		}
+	};
+	
+	// thrown when asking for the result of a computation that was cancelled or ran past its deadline
+	class cancelled : public std::exception {
+	public:
+		virtual char const * what() const noexcept {
+			return "math::cancelled";
+		}
+	};
+	
+	// thrown when solving with or inverting a singular matrix
+	class singular : public std::exception {
+	public:
+		virtual char const * what() const noexcept {
+			return "math::singular";
+		}
+	};
+	
+	// thrown when solving with the cholesky factors of a matrix that turned out not to be positive definite
+	class not_positive_definite : public std::exception {
+	public:
+		virtual char const * what() const noexcept {
+			return "math::not_positive_definite";
+		}
+	};
+	
+	// thrown by iterations that should settle down and didn't, the QR iteration of a schur form or a matrix square root
+	// of a real matrix with negative eigenvalues, say
+	class not_converged : public std::exception {
+	public:
+		virtual char const * what() const noexcept {
+			return "math::not_converged";
+		}
+	};
 }
 
 #endif
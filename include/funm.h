@@ -0,0 +1,800 @@
+//
+//  funm.h
+//  math
+//
+//  Created by Patrick Sauter on 10/19/26.
+//  Copyright (c) 2026 Patrick Sauter. All rights reserved.
+//
+
+#ifndef math_funm_h
+#define math_funm_h
+
+// functions of square matrices, for matrix or dmatrix over a field.  dmatrix expressions like A * s are evaluated
+// to a dmatrix first.
+//
+//		expm(A)						e^A, scaling and squaring with a pade approximant
+//		logm(A)						the principal logarithm, inverse scaling and squaring
+//		sqrtm(A)					the principal square root, denman-beavers
+//		funm(analytic::cos<x>(), A)	any analytic functor, or anything callable on std::complex, by schur-parlett
+//
+// the taylor series of e^A needs more and more terms as |A| grows and loses everything to cancellation when A has
+// large negative eigenvalues.  expm instead halves A until its norm is below a bound, where a pade approximant of
+// degree 3 to 13 is good to machine precision, and squares the result back up.  that's a handful of products and one
+// solve whatever the size of A.
+//
+// logm takes square roots until A is close to I, uses the pade approximant of log(I + X), and doubles back.  sqrtm
+// iterates Y -> (Y + Z^-1) / 2, Z -> (Z + Y^-1) / 2 from Y = A, Z = I, which goes to sqrt(A) and its inverse, with
+// the steps scaled by the determinants at the start.  both need A without eigenvalues on the closed negative real
+// axis.  the square root of a real matrix with negative eigenvalues isn't real, the iteration never settles and
+// throws math::not_converged, use complex_t entries for those.
+//
+// funm brings A to schur form Q T Q^H with complex entries, groups eigenvalues closer than funm_cluster together
+// and moves each group next to each other along the diagonal.  a chain of close eigenvalues is cut into groups no
+// wider than funm_spread, so the circle below stays small.  f of a diagonal block is a taylor series about the
+// mean of its eigenvalues, with the coefficients from f on a circle around them so no derivatives are needed, and
+// the blocks above the diagonal follow from F T = T F one sylvester equation at a time.  a series that hasn't
+// settled by the last coefficient throws math::not_converged.  for real A the result is
+// the real part, right for functors real on the real line.  funm on analytic::exp<x>, ln<x> or sqrt<x> goes to
+// expm, logm and sqrtm.
+
+#include <cmath>
+#include <ratio>
+#include <limits>
+#include <vector>
+#include <complex>
+#include <utility>
+#include <numeric>
+#include <algorithm>
+#include <type_traits>
+
+#include <pat/select.h>
+
+#include "core.h"
+#include "exceptions.h"
+#include "dmatrix.h"
+#include "lu.h"
+
+namespace math {
+	namespace analytic {
+		namespace detail {
+			template <typename X>
+			struct __exp;
+			template <typename X>
+			struct __ln;
+			template <typename X, typename N>
+			struct ___pow;
+			template <typename R1, typename R2>
+			struct _complex;
+		}
+	}
+	
+	namespace detail {
+		// eigenvalues closer than this share a block in funm, as long as the block stays within funm_spread
+		constexpr double funm_cluster = 0.1;
+		constexpr double funm_spread = 0.2;
+		
+		// samples of f around each block, and the most square roots or steps the iterations take
+		constexpr std::size_t funm_samples = 64;
+		constexpr std::size_t funm_iterations = 100;
+		
+		// the matrix type an argument is worked on as, and returned as.  expressions like A * s are evaluated to a dmatrix
+		template <typename X, typename D = typename std::decay<X>::type, typename = void>
+		struct funm_matrix {
+			typedef D type;
+		};
+		template <typename X, typename D>
+		struct funm_matrix<X, D, typename std::enable_if<std::is_base_of<dexpr<D>, D>::value>::type> {
+			typedef dmatrix<typename D::value_type> type;
+		};
+		
+		template <typename X>
+		using funm_matrix_t = typename funm_matrix<X>::type;
+		
+		template <typename T>
+		real_part_t<T> norm1(T const * a, std::size_t n) {
+			using std::abs;
+			
+			real_part_t<T> largest = 0;
+			
+			for (std::size_t j = 0; j < n; ++j) {
+				real_part_t<T> s = 0;
+				
+				for (std::size_t i = 0; i < n; ++i)
+					s += abs(a[i * n + j]);
+				
+				largest = std::max(largest, s);
+			}
+			
+			return largest;
+		}
+		
+		template <typename Matrix>
+		real_part_t<typename square<Matrix>::value_type> norm1(Matrix const & a) {
+			return norm1(a.data(), square<Matrix>::size(a));
+		}
+		
+		// log |det A| from the LU factors, which doesn't overflow for large matrices
+		template <typename Matrix>
+		real_part_t<typename square<Matrix>::value_type> log_determinant(lu_decomposition<Matrix> const & f) {
+			using std::abs;
+			
+			real_part_t<typename square<Matrix>::value_type> s = 0;
+			std::size_t const n = f.size();
+			
+			for (std::size_t i = 0; i < n; ++i)
+				s += std::log(abs(f.factors().data()[i * n + i]));
+			
+			return s;
+		}
+		
+		// ------------------------------------------------------
+		// pade approximants of e^A, A already scaled down
+		
+		// the largest |A| each degree is good to double precision for, higham 2005
+		constexpr double expm_theta[] = { 1.495585217958292e-2, 2.539398330063230e-1, 9.504178996162932e-1, 2.097847961257068, 5.371920351148152 };
+		constexpr std::size_t expm_degree[] = { 3, 5, 7, 9, 13 };
+		
+		constexpr double expm_b3[] = { 120, 60, 12, 1 };
+		constexpr double expm_b5[] = { 30240, 15120, 3360, 420, 30, 1 };
+		constexpr double expm_b7[] = { 17297280, 8648640, 1995840, 277200, 25200, 1512, 56, 1 };
+		constexpr double expm_b9[] = { 17643225600., 8821612800., 2075673600., 302702400., 30270240., 2162160., 110880., 3960., 90., 1. };
+		constexpr double expm_b13[] = {
+			64764752532480000., 32382376266240000., 7771770303897600., 1187353796428800., 129060195264000., 10559470521600.,
+			670442572800., 33522128640., 1323241920., 40840800., 960960., 16380., 182., 1.
+		};
+		
+		// (V - U)^-1 (V + U), U the odd powers and V the even
+		template <typename Matrix, typename T = typename square<Matrix>::value_type>
+		Matrix pade_quotient(Matrix const & u, Matrix const & v) {
+			return lu(Matrix(v - u)).solve(Matrix(v + u));
+		}
+		
+		template <typename Matrix, typename T = typename square<Matrix>::value_type>
+		Matrix expm_pade(Matrix const & a, Matrix const & I, double const * b, std::size_t m) {
+			Matrix const a2 = a * a;
+			Matrix p = I, u = I * T(b[1]), v = I * T(b[0]);
+			
+			for (std::size_t k = 2; k < m; k += 2) {
+				p = p * a2;
+				u = u + p * T(b[k + 1]);
+				v = v + p * T(b[k]);
+			}
+			
+			return pade_quotient(Matrix(a * u), v);
+		}
+		
+		// degree 13 with the powers shared, 6 products
+		template <typename Matrix, typename T = typename square<Matrix>::value_type>
+		Matrix expm_pade13(Matrix const & a, Matrix const & I) {
+			double const * b = expm_b13;
+			
+			Matrix const a2 = a * a, a4 = a2 * a2, a6 = a4 * a2;
+			
+			Matrix u = a6 * T(b[13]) + a4 * T(b[11]) + a2 * T(b[9]);
+			u = a6 * u;
+			u = u + a6 * T(b[7]) + a4 * T(b[5]) + a2 * T(b[3]) + I * T(b[1]);
+			u = a * u;
+			
+			Matrix v = a6 * T(b[12]) + a4 * T(b[10]) + a2 * T(b[8]);
+			v = a6 * v;
+			v = v + a6 * T(b[6]) + a4 * T(b[4]) + a2 * T(b[2]) + I * T(b[0]);
+			
+			return pade_quotient(u, v);
+		}
+		
+		// ------------------------------------------------------
+		// complex schur form for funm
+		
+		// [c s; -conj(s) c] [x; y] = [r; 0], c real
+		template <typename C>
+		void rotation(C const & x, C const & y, typename C::value_type & c, C & s) {
+			typedef typename C::value_type R;
+			
+			R const ax = std::abs(x), length = std::hypot(ax, std::abs(y));
+			
+			if (length == R(0)) {
+				c = 1;
+				s = 0;
+			} else if (ax == R(0)) {
+				c = 0;
+				s = 1;
+			} else {
+				c = ax / length;
+				s = (x / ax) * std::conj(y) / length;
+			}
+		}
+		
+		// the rotation on rows i and i + 1 of the n x n matrix at t, columns first to n
+		template <typename C>
+		void rotate_rows(C * t, std::size_t n, std::size_t i, std::size_t first, typename C::value_type c, C const & s) {
+			for (std::size_t j = first; j < n; ++j) {
+				C const x = t[i * n + j], y = t[(i + 1) * n + j];
+				
+				t[i * n + j] = c * x + s * y;
+				t[(i + 1) * n + j] = c * y - std::conj(s) * x;
+			}
+		}
+		
+		// its conjugate transpose on columns i and i + 1 from the right, rows 0 to last
+		template <typename C>
+		void rotate_cols(C * t, std::size_t n, std::size_t i, std::size_t last, typename C::value_type c, C const & s) {
+			for (std::size_t r = 0; r < last; ++r) {
+				C const x = t[r * n + i], y = t[r * n + i + 1];
+				
+				t[r * n + i] = c * x + std::conj(s) * y;
+				t[r * n + i + 1] = c * y - s * x;
+			}
+		}
+		
+		// A = Q T Q^H, T upper triangular.  t holds A and is replaced by T, q is set to Q
+		template <typename C>
+		void schur(C * t, C * q, std::size_t n) {
+			typedef typename C::value_type R;
+			
+			for (std::size_t i = 0; i < n; ++i)
+				for (std::size_t j = 0; j < n; ++j)
+					q[i * n + j] = C(i == j ? 1 : 0);
+			
+			// hessenberg form, householder reflections of the column below the subdiagonal
+			std::vector<C> v(n);
+			
+			for (std::size_t k = 0; k + 2 < n; ++k) {
+				R tail = 0;
+				
+				for (std::size_t i = k + 2; i < n; ++i)
+					tail += std::norm(t[i * n + k]);
+				
+				if (tail == R(0))
+					continue;
+				
+				C const alpha = t[(k + 1) * n + k];
+				R const length = std::sqrt(std::norm(alpha) + tail);
+				C const beta = (alpha == C(0) ? C(-length) : -alpha / std::abs(alpha) * length);
+				
+				std::size_t const m = n - k - 1;
+				
+				v[0] = alpha - beta;
+				
+				for (std::size_t i = 1; i < m; ++i)
+					v[i] = t[(k + 1 + i) * n + k];
+				
+				R const scale = R(2) / (std::norm(v[0]) + tail);
+				
+				// H = I - scale v v^H from the left on columns k on, and the right on every row, of T and Q
+				for (std::size_t j = k; j < n; ++j) {
+					C s = 0;
+					
+					for (std::size_t i = 0; i < m; ++i)
+						s += std::conj(v[i]) * t[(k + 1 + i) * n + j];
+					
+					s *= scale;
+					
+					for (std::size_t i = 0; i < m; ++i)
+						t[(k + 1 + i) * n + j] -= s * v[i];
+				}
+				
+				for (C * x : { t, q }) {
+					for (std::size_t r = 0; r < n; ++r) {
+						C s = 0;
+						
+						for (std::size_t i = 0; i < m; ++i)
+							s += x[r * n + k + 1 + i] * v[i];
+						
+						s *= scale;
+						
+						for (std::size_t i = 0; i < m; ++i)
+							x[r * n + k + 1 + i] -= s * std::conj(v[i]);
+					}
+				}
+				
+				for (std::size_t i = k + 2; i < n; ++i)
+					t[i * n + k] = 0;
+			}
+			
+			// shifted QR on the hessenberg form, deflating from the bottom
+			R const eps = std::numeric_limits<R>::epsilon();
+			auto size = [](C const & x) { return std::abs(x.real()) + std::abs(x.imag()); };
+			
+			std::size_t steps = 0;
+			
+			for (std::size_t hi = n; hi-- > 1; ) {
+				for (std::size_t iteration = 0; ; ++iteration) {
+					std::size_t lo = hi;
+					
+					for (; lo > 0; --lo) {
+						C & sub = t[lo * n + lo - 1];
+						
+						if (size(sub) <= eps * (size(t[(lo - 1) * n + lo - 1]) + size(t[lo * n + lo]))) {
+							sub = 0;
+							break;
+						}
+					}
+					
+					if (lo == hi)
+						break;
+					
+					if (++steps > 30 * n)
+						throw math::not_converged();
+					
+					// the eigenvalue of the trailing 2x2 closer to its corner, now and then something else so a
+					// cycle can't go on forever
+					C const a = t[(hi - 1) * n + hi - 1], b = t[(hi - 1) * n + hi], c = t[hi * n + hi - 1], d = t[hi * n + hi];
+					C mu;
+					
+					if (iteration % 10 == 9)
+						mu = d + C(std::abs(c.real()) + std::abs(t[(hi - 1) * n + hi - 2 + (hi == lo + 1 ? 1 : 0)].real()));
+					else {
+						C const p = (a - d) / R(2), root = std::sqrt(p * p + b * c);
+						C const mu1 = (a + d) / R(2) + root, mu2 = (a + d) / R(2) - root;
+						
+						mu = (std::abs(mu1 - d) < std::abs(mu2 - d) ? mu1 : mu2);
+					}
+					
+					std::vector<R> cs(hi - lo);
+					std::vector<C> sn(hi - lo);
+					
+					for (std::size_t k = lo; k <= hi; ++k)
+						t[k * n + k] -= mu;
+					
+					for (std::size_t k = lo; k < hi; ++k) {
+						rotation(t[k * n + k], t[(k + 1) * n + k], cs[k - lo], sn[k - lo]);
+						rotate_rows(t, n, k, k, cs[k - lo], sn[k - lo]);
+						t[(k + 1) * n + k] = 0;
+					}
+					
+					for (std::size_t k = lo; k < hi; ++k) {
+						rotate_cols(t, n, k, std::min(k + 2, n), cs[k - lo], sn[k - lo]);
+						rotate_cols(q, n, k, n, cs[k - lo], sn[k - lo]);
+					}
+					
+					for (std::size_t k = lo; k <= hi; ++k)
+						t[k * n + k] += mu;
+				}
+			}
+		}
+		
+		// swaps T_kk and T_k+1,k+1 keeping A = Q T Q^H, as lapack's ztrexc
+		template <typename C>
+		void swap_schur(C * t, C * q, std::size_t n, std::size_t k) {
+			typedef typename C::value_type R;
+			
+			C const t11 = t[k * n + k], t22 = t[(k + 1) * n + k + 1];
+			
+			R c;
+			C s;
+			
+			rotation(t[k * n + k + 1], t22 - t11, c, s);
+			
+			rotate_rows(t, n, k, k + 2, c, s);
+			rotate_cols(t, n, k, k, c, s);
+			rotate_cols(q, n, k, n, c, s);
+			
+			t[k * n + k] = t22;
+			t[(k + 1) * n + k + 1] = t11;
+		}
+		
+		// f of an upper triangular block with close eigenvalues, sum of c_k (T - sigma I)^k about their mean.  the
+		// c_k come from f at samples around a circle, c_k = mean of f(sigma + r w^j) w^-jk / r^k
+		template <typename C, typename F>
+		void funm_block(F & f, C const * t, std::size_t n, std::size_t first, std::size_t b, C * out) {
+			typedef typename C::value_type R;
+			
+			if (b == 1) {
+				out[first * n + first] = f(t[first * n + first]);
+				return;
+			}
+			
+			C sigma = 0;
+			R spread = 0;
+			
+			for (std::size_t i = first; i < first + b; ++i)
+				sigma += t[i * n + i];
+			
+			sigma /= R(b);
+			
+			for (std::size_t i = first; i < first + b; ++i)
+				spread = std::max(spread, std::abs(t[i * n + i] - sigma));
+			
+			R const radius = std::max(R(2) * spread, R(funm_cluster));
+			std::size_t const m = funm_samples;
+			
+			std::vector<C> samples(m), coefficients(m / 2);
+			R const angle = R(2) * R(3.14159265358979323846) / R(m);
+			
+			for (std::size_t j = 0; j < m; ++j)
+				samples[j] = f(sigma + std::polar(radius, angle * R(j)));
+			
+			for (std::size_t k = 0; k < m / 2; ++k) {
+				C s = 0;
+				
+				for (std::size_t j = 0; j < m; ++j)
+					s += samples[j] * std::polar(R(1), -angle * R(j * k % m));
+				
+				coefficients[k] = s / (R(m) * std::pow(radius, R(k)));
+			}
+			
+			// N = T - sigma I, the powers of N and the sum, b x b
+			std::vector<C> N(b * b), P(b * b), next(b * b), sum(b * b, C(0));
+			
+			for (std::size_t i = 0; i < b; ++i) {
+				for (std::size_t j = 0; j < b; ++j) {
+					N[i * b + j] = (j < i ? C(0) : t[(first + i) * n + first + j]);
+					P[i * b + j] = C(i == j ? 1 : 0);
+				}
+				
+				N[i * b + i] -= sigma;
+				sum[i * b + i] = coefficients[0];
+			}
+			
+			R const eps = std::numeric_limits<R>::epsilon();
+			std::size_t small = 0;
+			bool exact = false;
+			
+			for (std::size_t k = 1; k < m / 2 && small < 2 && !exact; ++k) {
+				std::fill(next.begin(), next.end(), C(0));
+				
+				for (std::size_t i = 0; i < b; ++i)
+					for (std::size_t l = i; l < b; ++l)
+						for (std::size_t j = l; j < b; ++j)
+							next[i * b + j] += P[i * b + l] * N[l * b + j];
+				
+				P.swap(next);
+				
+				R term = 0, total = 0;
+				
+				for (std::size_t e = 0; e < b * b; ++e) {
+					sum[e] += coefficients[k] * P[e];
+					term = std::max(term, std::abs(coefficients[k] * P[e]));
+					total = std::max(total, std::abs(sum[e]));
+				}
+				
+				small = (k >= b && term <= eps * total ? small + 1 : 0);
+				
+				// N is nilpotent and the sum is complete
+				exact = std::all_of(P.begin(), P.end(), [](C const & x) { return x == C(0); });
+			}
+			
+			if (small < 2 && !exact)
+				throw math::not_converged();
+			
+			for (std::size_t i = 0; i < b; ++i)
+				for (std::size_t j = i; j < b; ++j)
+					out[(first + i) * n + first + j] = sum[i * b + j];
+		}
+		
+		// f(T) for the n x n upper triangular T, reordered so close eigenvalues are next to each other
+		template <typename C, typename F>
+		std::vector<C> funm_triangular(F & f, C * t, C * q, std::size_t n) {
+			typedef typename C::value_type R;
+			
+			// eigenvalues within funm_cluster of each other, joined up closest pair first, but only while every two
+			// eigenvalues of the joined group are within funm_spread.  joining whole chains would put the circle of
+			// funm_block around eigenvalues far apart, and across any singularity or branch cut of f between them
+			std::vector<std::size_t> group(n);
+			std::vector<std::vector<std::size_t>> members(n);
+			
+			for (std::size_t i = 0; i < n; ++i) {
+				group[i] = i;
+				members[i].assign(1, i);
+			}
+			
+			auto root = [&](std::size_t i) {
+				while (group[i] != i)
+					i = group[i] = group[group[i]];
+				
+				return i;
+			};
+			
+			auto distance = [&](std::size_t i, std::size_t j) { return std::abs(t[i * n + i] - t[j * n + j]); };
+			
+			std::vector<std::pair<std::size_t, std::size_t>> close;
+			
+			for (std::size_t i = 0; i < n; ++i)
+				for (std::size_t j = i + 1; j < n; ++j)
+					if (distance(i, j) <= R(funm_cluster))
+						close.emplace_back(i, j);
+			
+			std::stable_sort(close.begin(), close.end(), [&](std::pair<std::size_t, std::size_t> const & a, std::pair<std::size_t, std::size_t> const & b) {
+				return distance(a.first, a.second) < distance(b.first, b.second);
+			});
+			
+			for (auto const & c : close) {
+				std::size_t const a = root(c.first), b = root(c.second);
+				
+				if (a == b)
+					continue;
+				
+				bool narrow = true;
+				
+				for (std::size_t i : members[a])
+					for (std::size_t j : members[b])
+						narrow = narrow && distance(i, j) <= R(funm_spread);
+				
+				if (!narrow)
+					continue;
+				
+				group[b] = a;
+				members[a].insert(members[a].end(), members[b].begin(), members[b].end());
+				members[b].clear();
+			}
+			
+			// groups in order of the mean position of their eigenvalues, then bubbled into place
+			std::vector<R> position(n, R(0)), count(n, R(0));
+			
+			for (std::size_t i = 0; i < n; ++i) {
+				position[root(i)] += R(i);
+				count[root(i)] += 1;
+			}
+			
+			std::vector<R> rank(n);
+			
+			for (std::size_t i = 0; i < n; ++i)
+				rank[i] = position[root(i)] / count[root(i)] + R(root(i)) / R(2 * n + 1);
+			
+			for (bool moved = true; moved; ) {
+				moved = false;
+				
+				for (std::size_t k = 0; k + 1 < n; ++k) {
+					if (rank[k + 1] < rank[k]) {
+						swap_schur(t, q, n, k);
+						std::swap(rank[k], rank[k + 1]);
+						moved = true;
+					}
+				}
+			}
+			
+			std::vector<std::size_t> blocks(1, 0);
+			
+			for (std::size_t i = 1; i < n; ++i)
+				if (rank[i] != rank[i - 1])
+					blocks.push_back(i);
+			
+			blocks.push_back(n);
+			
+			std::vector<C> out(n * n, C(0));
+			
+			// a block column at a time, up from the diagonal, F_ij from T_ii F_ij - F_ij T_jj = F_ii T_ij - T_ij F_jj +
+			// sum over the blocks k between of F_ik T_kj - T_ik F_kj
+			for (std::size_t J = 0; J + 1 < blocks.size(); ++J) {
+				std::size_t const j0 = blocks[J], j1 = blocks[J + 1];
+				
+				funm_block(f, t, n, j0, j1 - j0, out.data());
+				
+				for (std::size_t I = J; I-- > 0; ) {
+					std::size_t const i0 = blocks[I], i1 = blocks[I + 1];
+					
+					for (std::size_t c = j0; c < j1; ++c) {
+						for (std::size_t r = i1; r-- > i0; ) {
+							C s = 0;
+							
+							// F_ii T_ij + F_ik T_kj, everything from row r to the column block
+							for (std::size_t l = r; l < j0; ++l)
+								s += out[r * n + l] * t[l * n + c];
+							
+							// - T_ij F_jj - T_ik F_kj, with the already solved part of the column
+							for (std::size_t l = i1; l <= c; ++l)
+								s -= t[r * n + l] * out[l * n + c];
+							
+							// T_ii X - X T_jj, the known parts of row r of X and column c of T_jj
+							for (std::size_t l = r + 1; l < i1; ++l)
+								s -= t[r * n + l] * out[l * n + c];
+							
+							for (std::size_t l = j0; l < c; ++l)
+								s += out[r * n + l] * t[l * n + c];
+							
+							out[r * n + c] = s / (t[r * n + r] - t[c * n + c]);
+						}
+					}
+				}
+			}
+			
+			return out;
+		}
+		
+		template <typename T, typename C>
+		T real_if(C const & x, std::true_type) { return x.real(); }
+		template <typename T, typename C>
+		T real_if(C const & x, std::false_type) { return x; }
+	}
+	
+	// ------------------------------------------------------
+	// e^A
+	
+	template <typename Matrix>
+	detail::funm_matrix_t<Matrix> expm(Matrix && m) {
+		typedef detail::funm_matrix_t<Matrix> M;
+		typedef detail::square<M> shape;
+		typedef typename shape::value_type T;
+		typedef detail::real_part_t<T> R;
+		
+		static_assert(check::field<T>::value,
+					  "Assertion failed, matrix functions need a matrix over a field.");
+		
+		M a(std::forward<Matrix>(m));
+		std::size_t const n = shape::size(a);
+		M const I = shape::identity(n);
+		R const norm = detail::norm1(a);
+		
+		double const * pade[] = { detail::expm_b3, detail::expm_b5, detail::expm_b7, detail::expm_b9 };
+		
+		for (std::size_t d = 0; d < 4; ++d) {
+			if (norm <= R(detail::expm_theta[d]))
+				return detail::expm_pade(a, I, pade[d], detail::expm_degree[d]);
+		}
+		
+		int const s = std::max(0, int(std::ceil(std::log2(norm / R(detail::expm_theta[4])))));
+		
+		a = a * T(std::ldexp(R(1), -s));
+		
+		M r = detail::expm_pade13(a, I);
+		
+		for (int k = 0; k < s; ++k)
+			r = r * r;
+		
+		return r;
+	}
+	
+	// ------------------------------------------------------
+	// sqrt(A), the one with eigenvalues in the right half plane
+	
+	template <typename Matrix>
+	detail::funm_matrix_t<Matrix> sqrtm(Matrix && m) {
+		typedef detail::funm_matrix_t<Matrix> M;
+		typedef detail::square<M> shape;
+		typedef typename shape::value_type T;
+		typedef detail::real_part_t<T> R;
+		
+		static_assert(check::field<T>::value,
+					  "Assertion failed, matrix functions need a matrix over a field.");
+		
+		M y(std::forward<Matrix>(m));
+		std::size_t const n = shape::size(y);
+		M z = shape::identity(n);
+		
+		R const eps = std::numeric_limits<R>::epsilon();
+		R last = std::numeric_limits<R>::max();
+		bool scaling = true;
+		
+		for (std::size_t k = 0; k < detail::funm_iterations; ++k) {
+			auto fy = lu(y);
+			auto fz = lu(z);
+			
+			if (fy.singular() || fz.singular())
+				throw math::singular();
+			
+			// |det Y det Z|^(-1/2n), which evens out how fast the eigenvalues converge
+			R mu = 1;
+			
+			if (scaling)
+				mu = std::exp(-(detail::log_determinant(fy) + detail::log_determinant(fz)) / R(2 * n));
+			
+			M next = y * T(mu / 2) + fz.inverse() * T(1 / (2 * mu));
+			z = z * T(mu / 2) + fy.inverse() * T(1 / (2 * mu));
+			
+			R const change = detail::norm1(M(next - y)) / detail::norm1(next);
+			
+			y = std::move(next);
+			
+			// converged, or down to rounding and not getting any better
+			if (change <= R(n) * eps || (change < std::sqrt(eps) && change >= last))
+				return y;
+			
+			scaling = scaling && change > R(1e-2);
+			last = change;
+		}
+		
+		throw math::not_converged();
+	}
+	
+	// ------------------------------------------------------
+	// log(A), the one with eigenvalues' imaginary parts in (-pi, pi)
+	
+	namespace detail {
+		// gauss-legendre on [0, 1], log(I + X) = integral of X (I + t X)^-1, which is the degree 8 pade approximant
+		constexpr double logm_nodes[] = {
+			0.0198550717512319, 0.1016667612931866, 0.2372337950418355, 0.4082826787521751,
+			0.5917173212478249, 0.7627662049581645, 0.8983332387068134, 0.9801449282487681
+		};
+		constexpr double logm_weights[] = {
+			0.0506142681451881, 0.1111905172266872, 0.1568533229389436, 0.1813418916891810,
+			0.1813418916891810, 0.1568533229389436, 0.1111905172266872, 0.0506142681451881
+		};
+		
+		// |X| the approximant is good to double precision for
+		constexpr double logm_theta = 0.25;
+	}
+	
+	template <typename Matrix>
+	detail::funm_matrix_t<Matrix> logm(Matrix && m) {
+		typedef detail::funm_matrix_t<Matrix> M;
+		typedef detail::square<M> shape;
+		typedef typename shape::value_type T;
+		typedef detail::real_part_t<T> R;
+		
+		static_assert(check::field<T>::value,
+					  "Assertion failed, matrix functions need a matrix over a field.");
+		
+		M a(std::forward<Matrix>(m));
+		std::size_t const n = shape::size(a);
+		M const I = shape::identity(n);
+		
+		// square roots until A is near I, log A = 2^s log A^(1/2^s)
+		std::size_t s = 0;
+		
+		for (; detail::norm1(M(a - I)) > R(detail::logm_theta); ++s) {
+			if (s == detail::funm_iterations)
+				throw math::not_converged();
+			
+			a = sqrtm(std::move(a));
+		}
+		
+		M const x = a - I;
+		M r = x * T(0);
+		
+		for (std::size_t j = 0; j < 8; ++j)
+			r = r + lu(M(I + x * T(detail::logm_nodes[j]))).solve(x) * T(detail::logm_weights[j]);
+		
+		return r * T(std::ldexp(R(1), int(s)));
+	}
+	
+	// ------------------------------------------------------
+	// f(A) for any f analytic around the eigenvalues of A
+	
+	template <typename F, typename Matrix>
+	detail::funm_matrix_t<Matrix> funm(F f, Matrix && m) {
+		typedef detail::funm_matrix_t<Matrix> M;
+		typedef detail::square<M> shape;
+		typedef typename shape::value_type T;
+		typedef std::complex<detail::real_part_t<T>> C;
+		
+		static_assert(check::field<T>::value,
+					  "Assertion failed, matrix functions need a matrix over a field.");
+		
+		M r(std::forward<Matrix>(m));
+		std::size_t const n = shape::size(r);
+		
+		std::vector<C> t(r.data(), r.data() + n * n), q(n * n);
+		
+		detail::schur(t.data(), q.data(), n);
+		
+		auto g = [&](C const & z) { return C(f(z)); };
+		std::vector<C> ft = detail::funm_triangular(g, t.data(), q.data(), n);
+		
+		// Q f(T) Q^H, f(T) upper triangular
+		std::vector<C> w(n * n, C(0));
+		
+		for (std::size_t i = 0; i < n; ++i)
+			for (std::size_t l = 0; l < n; ++l)
+				for (std::size_t j = l; j < n; ++j)
+					w[i * n + j] += q[i * n + l] * ft[l * n + j];
+		
+		for (std::size_t i = 0; i < n; ++i) {
+			for (std::size_t j = 0; j < n; ++j) {
+				C s = 0;
+				
+				for (std::size_t l = 0; l < n; ++l)
+					s += w[i * n + l] * std::conj(q[j * n + l]);
+				
+				r.data()[i * n + j] = detail::real_if<T>(s, std::is_same<T, detail::real_part_t<T>>{});
+			}
+		}
+		
+		return r;
+	}
+	
+	// the analytic functors with a better algorithm of their own
+	template <typename Matrix>
+	detail::funm_matrix_t<Matrix> funm(analytic::detail::__exp<pat::select<0>> const &, Matrix && m) {
+		return expm(std::forward<Matrix>(m));
+	}
+	template <typename Matrix>
+	detail::funm_matrix_t<Matrix> funm(analytic::detail::__ln<pat::select<0>> const &, Matrix && m) {
+		return logm(std::forward<Matrix>(m));
+	}
+	template <typename Matrix>
+	detail::funm_matrix_t<Matrix> funm(analytic::detail::___pow<pat::select<0>, analytic::detail::_complex<std::ratio<1,2>, std::ratio<0,1>>> const &, Matrix && m) {
+		return sqrtm(std::forward<Matrix>(m));
+	}
+}
+
+#endif
@@ -0,0 +1,393 @@
+//
+//  gemm.h
+//  math
+//
+//  Created by Patrick Sauter on 10/19/26.
+//  Copyright (c) 2026 Patrick Sauter. All rights reserved.
+//
+
+#ifndef math_gemm_h
+#define math_gemm_h
+
+// C = alpha A B + beta C for row major float, double and complex matrices, the kernel behind matrix * matrix.
+//
+// the straightforward loop reads a column of B with a stride of a whole row for every entry of C, so for anything
+// bigger than the cache nearly every read misses, and the compiler can't vectorize it.  this is the usual blocked
+// scheme instead:
+//	- B is cut into kc x nc blocks, each copied ("packed") once into strips nr columns wide, stored so the kernel
+//	  reads them front to back
+//	- A into mc x kc blocks packed into strips mr rows high
+//	- the micro kernel multiplies one strip of each into an mr x nr tile held in registers, kc fused multiply adds
+//	  per entry before anything is written back
+// the block sizes keep a strip of B in L1 and the block of A in L2.
+//
+// the micro kernels use AVX-512 or AVX2 + FMA when the compiler is allowed to (-mavx512f, -mavx2 -mfma, or
+// -march=native), and portable loops the compiler can vectorize otherwise.  their row loops are unrolled by pragma,
+// so the tile stays in registers at -O2 too.  complex numbers have their own kernel
+// that does the arithmetic on the real and imaginary parts directly, std::complex's operator* checks for nans.
+
+#include <cstddef>
+#include <complex>
+#include <vector>
+#include <algorithm>
+#include <type_traits>
+
+#include "parallel.h"
+
+#if defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+
+namespace math {
+	namespace detail {
+		// portable micro kernel, tile = a_strip * b_strip over k
+		template <typename T, std::size_t MR, std::size_t NR>
+		struct gemm_kernel_generic {
+			static constexpr std::size_t mr = MR, nr = NR;
+			
+			static void run(std::size_t k, T const * a, T const * b, T * tile) {
+				T c[MR * NR] = {};
+				
+				for (std::size_t l = 0; l < k; ++l, a += MR, b += NR) {
+					for (std::size_t r = 0; r < MR; ++r) {
+						T ar = a[r];
+						
+						for (std::size_t j = 0; j < NR; ++j)
+							c[r * NR + j] += ar * b[j];
+					}
+				}
+				
+				std::copy(c, c + MR * NR, tile);
+			}
+		};
+		
+		// complex kernel on the parts, (a + bi)(c + di) = ac - bd + (ad + bc)i
+		template <typename R, std::size_t MR, std::size_t NR>
+		struct gemm_kernel_complex {
+			static constexpr std::size_t mr = MR, nr = NR;
+			
+			static void run(std::size_t k, std::complex<R> const * a, std::complex<R> const * b, std::complex<R> * tile) {
+				R re[MR * NR] = {}, im[MR * NR] = {};
+				
+				for (std::size_t l = 0; l < k; ++l, a += MR, b += NR) {
+					R br[NR], bi[NR];
+					
+					for (std::size_t j = 0; j < NR; ++j) {
+						br[j] = b[j].real();
+						bi[j] = b[j].imag();
+					}
+					
+					for (std::size_t r = 0; r < MR; ++r) {
+						R ar = a[r].real(), ai = a[r].imag();
+						
+						for (std::size_t j = 0; j < NR; ++j) {
+							re[r * NR + j] += ar * br[j] - ai * bi[j];
+							im[r * NR + j] += ar * bi[j] + ai * br[j];
+						}
+					}
+				}
+				
+				for (std::size_t i = 0; i < MR * NR; ++i)
+					tile[i] = std::complex<R>(re[i], im[i]);
+			}
+		};
+
+#if defined(__AVX512F__)
+		struct gemm_kernel_double {
+			static constexpr std::size_t mr = 6, nr = 16;
+			
+			static void run(std::size_t k, double const * a, double const * b, double * tile) {
+				__m512d c[mr][2];
+				
+				#pragma GCC unroll 8
+				for (std::size_t r = 0; r < mr; ++r)
+					c[r][0] = c[r][1] = _mm512_setzero_pd();
+				
+				for (std::size_t l = 0; l < k; ++l, a += mr, b += nr) {
+					__m512d b0 = _mm512_loadu_pd(b), b1 = _mm512_loadu_pd(b + 8);
+					
+					#pragma GCC unroll 8
+					for (std::size_t r = 0; r < mr; ++r) {
+						__m512d ar = _mm512_set1_pd(a[r]);
+						
+						c[r][0] = _mm512_fmadd_pd(ar, b0, c[r][0]);
+						c[r][1] = _mm512_fmadd_pd(ar, b1, c[r][1]);
+					}
+				}
+				
+				#pragma GCC unroll 8
+				for (std::size_t r = 0; r < mr; ++r) {
+					_mm512_storeu_pd(tile + r * nr, c[r][0]);
+					_mm512_storeu_pd(tile + r * nr + 8, c[r][1]);
+				}
+			}
+		};
+		
+		struct gemm_kernel_float {
+			static constexpr std::size_t mr = 6, nr = 32;
+			
+			static void run(std::size_t k, float const * a, float const * b, float * tile) {
+				__m512 c[mr][2];
+				
+				#pragma GCC unroll 8
+				for (std::size_t r = 0; r < mr; ++r)
+					c[r][0] = c[r][1] = _mm512_setzero_ps();
+				
+				for (std::size_t l = 0; l < k; ++l, a += mr, b += nr) {
+					__m512 b0 = _mm512_loadu_ps(b), b1 = _mm512_loadu_ps(b + 16);
+					
+					#pragma GCC unroll 8
+					for (std::size_t r = 0; r < mr; ++r) {
+						__m512 ar = _mm512_set1_ps(a[r]);
+						
+						c[r][0] = _mm512_fmadd_ps(ar, b0, c[r][0]);
+						c[r][1] = _mm512_fmadd_ps(ar, b1, c[r][1]);
+					}
+				}
+				
+				#pragma GCC unroll 8
+				for (std::size_t r = 0; r < mr; ++r) {
+					_mm512_storeu_ps(tile + r * nr, c[r][0]);
+					_mm512_storeu_ps(tile + r * nr + 16, c[r][1]);
+				}
+			}
+		};
+#elif defined(__AVX2__) && defined(__FMA__)
+		struct gemm_kernel_double {
+			static constexpr std::size_t mr = 6, nr = 8;
+			
+			static void run(std::size_t k, double const * a, double const * b, double * tile) {
+				__m256d c[mr][2];
+				
+				#pragma GCC unroll 8
+				for (std::size_t r = 0; r < mr; ++r)
+					c[r][0] = c[r][1] = _mm256_setzero_pd();
+				
+				for (std::size_t l = 0; l < k; ++l, a += mr, b += nr) {
+					__m256d b0 = _mm256_loadu_pd(b), b1 = _mm256_loadu_pd(b + 4);
+					
+					#pragma GCC unroll 8
+					for (std::size_t r = 0; r < mr; ++r) {
+						__m256d ar = _mm256_broadcast_sd(a + r);
+						
+						c[r][0] = _mm256_fmadd_pd(ar, b0, c[r][0]);
+						c[r][1] = _mm256_fmadd_pd(ar, b1, c[r][1]);
+					}
+				}
+				
+				#pragma GCC unroll 8
+				for (std::size_t r = 0; r < mr; ++r) {
+					_mm256_storeu_pd(tile + r * nr, c[r][0]);
+					_mm256_storeu_pd(tile + r * nr + 4, c[r][1]);
+				}
+			}
+		};
+		
+		struct gemm_kernel_float {
+			static constexpr std::size_t mr = 6, nr = 16;
+			
+			static void run(std::size_t k, float const * a, float const * b, float * tile) {
+				__m256 c[mr][2];
+				
+				#pragma GCC unroll 8
+				for (std::size_t r = 0; r < mr; ++r)
+					c[r][0] = c[r][1] = _mm256_setzero_ps();
+				
+				for (std::size_t l = 0; l < k; ++l, a += mr, b += nr) {
+					__m256 b0 = _mm256_loadu_ps(b), b1 = _mm256_loadu_ps(b + 8);
+					
+					#pragma GCC unroll 8
+					for (std::size_t r = 0; r < mr; ++r) {
+						__m256 ar = _mm256_broadcast_ss(a + r);
+						
+						c[r][0] = _mm256_fmadd_ps(ar, b0, c[r][0]);
+						c[r][1] = _mm256_fmadd_ps(ar, b1, c[r][1]);
+					}
+				}
+				
+				#pragma GCC unroll 8
+				for (std::size_t r = 0; r < mr; ++r) {
+					_mm256_storeu_ps(tile + r * nr, c[r][0]);
+					_mm256_storeu_ps(tile + r * nr + 8, c[r][1]);
+				}
+			}
+		};
+#else
+		struct gemm_kernel_double : gemm_kernel_generic<double, 4, 8> { };
+		struct gemm_kernel_float : gemm_kernel_generic<float, 4, 16> { };
+#endif
+
+		template <typename T>
+		struct gemm_kernel;
+		
+		template <> struct gemm_kernel<double> : gemm_kernel_double { };
+		template <> struct gemm_kernel<float> : gemm_kernel_float { };
+		template <> struct gemm_kernel<std::complex<double>> : gemm_kernel_complex<double, 3, 4> { };
+		template <> struct gemm_kernel<std::complex<float>> : gemm_kernel_complex<float, 3, 8> { };
+		
+		// the types gemm handles, everything else uses the plain loops
+		template <typename T>
+		struct has_gemm : std::false_type { };
+		
+		template <> struct has_gemm<double> : std::true_type { };
+		template <> struct has_gemm<float> : std::true_type { };
+		template <> struct has_gemm<std::complex<double>> : std::true_type { };
+		template <> struct has_gemm<std::complex<float>> : std::true_type { };
+		
+		// mc x kc of A and kc x nc of B at a time
+		constexpr std::size_t gemm_kc = 256;
+		constexpr std::size_t gemm_mc = 96;
+		constexpr std::size_t gemm_nc = 2048;
+		
+		// tiles of C handed to each thread, multiples of every mr and nr, and the product size that is worth it
+		constexpr std::size_t gemm_tile_m = 192;
+		constexpr std::size_t gemm_tile_n = 1024;
+		constexpr std::size_t gemm_parallel = std::size_t(1) << 21;
+		
+		// strips of mr rows, column by column, zero past the last row
+		template <std::size_t MR, typename T>
+		void gemm_pack_a(std::size_t m, std::size_t k, T const * a, std::size_t lda, T * packed) {
+			for (std::size_t i = 0; i < m; i += MR) {
+				std::size_t rows = std::min(MR, m - i);
+				
+				for (std::size_t l = 0; l < k; ++l) {
+					for (std::size_t r = 0; r < rows; ++r)
+						*packed++ = a[(i + r) * lda + l];
+					
+					for (std::size_t r = rows; r < MR; ++r)
+						*packed++ = T{};
+				}
+			}
+		}
+		
+		// strips of nr columns, row by row, zero past the last column
+		template <std::size_t NR, typename T>
+		void gemm_pack_b(std::size_t k, std::size_t n, T const * b, std::size_t ldb, T * packed) {
+			for (std::size_t j = 0; j < n; j += NR) {
+				std::size_t cols = std::min(NR, n - j);
+				
+				for (std::size_t l = 0; l < k; ++l) {
+					T const * row = b + l * ldb + j;
+					
+					std::copy(row, row + cols, packed);
+					std::fill(packed + cols, packed + NR, T{});
+					
+					packed += NR;
+				}
+			}
+		}
+		
+		// C = alpha A B + beta C over one mc x nc block of C, with A and B packed.  beta only applies to the first
+		// block along k, the others add to what the first one wrote.
+		template <typename T>
+		void gemm_block(std::size_t m, std::size_t n, std::size_t k, T alpha, T const * a, T const * b, T beta, T * c, std::size_t ldc) {
+			typedef gemm_kernel<T> kernel;
+			
+			constexpr std::size_t MR = kernel::mr, NR = kernel::nr;
+			
+			T tile[MR * NR];
+			
+			for (std::size_t j = 0; j < n; j += NR) {
+				std::size_t cols = std::min(NR, n - j);
+				
+				for (std::size_t i = 0; i < m; i += MR) {
+					std::size_t rows = std::min(MR, m - i);
+					
+					kernel::run(k, a + i * k, b + j * k, tile);
+					
+					for (std::size_t r = 0; r < rows; ++r) {
+						T * out = c + (i + r) * ldc + j;
+						
+						if (beta == T{}) {
+							for (std::size_t s = 0; s < cols; ++s)
+								out[s] = alpha * tile[r * NR + s];
+						} else {
+							for (std::size_t s = 0; s < cols; ++s)
+								out[s] = alpha * tile[r * NR + s] + beta * out[s];
+						}
+					}
+				}
+			}
+		}
+	}
+	
+	namespace detail {
+		// gemm on the calling thread
+		template <typename T>
+		void gemm_serial(std::size_t m, std::size_t n, std::size_t k,
+						 T alpha, T const * a, std::size_t lda, T const * b, std::size_t ldb,
+						 T beta, T * c, std::size_t ldc)
+		{
+			typedef detail::gemm_kernel<T> kernel;
+			
+			constexpr std::size_t MR = kernel::mr, NR = kernel::nr;
+			
+			if (m == 0 || n == 0)
+				return;
+			
+			if (k == 0) {
+				for (std::size_t i = 0; i < m; ++i)
+					for (std::size_t j = 0; j < n; ++j)
+						c[i * ldc + j] = (beta == T{} ? T{} : beta * c[i * ldc + j]);
+				
+				return;
+			}
+			
+			std::size_t const kc = detail::gemm_kc;
+			std::size_t const mc = (detail::gemm_mc / MR) * MR;
+			std::size_t const nc = (detail::gemm_nc / NR) * NR;
+			
+			// reused between calls on the same thread
+			static thread_local std::vector<T> packed_a, packed_b;
+			
+			packed_a.resize(mc * kc);
+			packed_b.resize(std::min(nc, (n + NR - 1) / NR * NR) * kc);
+			
+			for (std::size_t jc = 0; jc < n; jc += nc) {
+				std::size_t nb = std::min(nc, n - jc);
+				
+				for (std::size_t pc = 0; pc < k; pc += kc) {
+					std::size_t kb = std::min(kc, k - pc);
+					
+					detail::gemm_pack_b<NR>(kb, nb, b + pc * ldb + jc, ldb, packed_b.data());
+					
+					for (std::size_t ic = 0; ic < m; ic += mc) {
+						std::size_t mb = std::min(mc, m - ic);
+						
+						detail::gemm_pack_a<MR>(mb, kb, a + ic * lda + pc, lda, packed_a.data());
+						
+						detail::gemm_block(mb, nb, kb, alpha, packed_a.data(), packed_b.data(),
+										   (pc == 0 ? beta : T(1)), c + ic * ldc + jc, ldc);
+					}
+				}
+			}
+		}
+	}
+	
+	// C = alpha A B + beta C, A m x k, B k x n and C m x n, all row major with the given row strides.
+	// C may not overlap A or B.  beta == 0 overwrites C, so it needn't be initialized.
+	// products of more than gemm_parallel multiply adds are cut into tiles of C, gemm_tile_m x gemm_tile_n, shared
+	// out by stealing_for.  every tile is a gemm of its own with its own packing, so threads never write the same
+	// entries and the result doesn't depend on the thread count.
+	template <typename T, typename = typename std::enable_if<detail::has_gemm<T>::value>::type>
+	void gemm(std::size_t m, std::size_t n, std::size_t k,
+			  T alpha, T const * a, std::size_t lda, T const * b, std::size_t ldb,
+			  T beta, T * c, std::size_t ldc, std::size_t threads = hardware_threads())
+	{
+		std::size_t const tm = detail::gemm_tile_m, tn = detail::gemm_tile_n;
+		std::size_t const rows = (m + tm - 1) / tm, cols = (n + tn - 1) / tn;
+		
+		if (threads <= 1 || rows * cols <= 1 || m * n * k < detail::gemm_parallel)
+			return detail::gemm_serial(m, n, k, alpha, a, lda, b, ldb, beta, c, ldc);
+		
+		// row major tiles, so the contiguous shares of stealing_for are bands of rows of C
+		stealing_for(rows * cols, [&](std::size_t t) {
+			std::size_t const i = (t / cols) * tm, j = (t % cols) * tn;
+			
+			detail::gemm_serial(std::min(tm, m - i), std::min(tn, n - j), k, alpha,
+								a + i * lda, lda, b + j, ldb, beta, c + i * ldc + j, ldc);
+		}, threads);
+	}
+}
+
+#endif
@@ -0,0 +1,270 @@
+//
+//  grid_evaluator.h
+//  math
+//
+//  Created by Patrick Sauter on 10/19/26.
+//  Copyright (c) 2026 Patrick Sauter. All rights reserved.
+//
+
+#ifndef math_grid_evaluator_h
+#define math_grid_evaluator_h
+
+// samples an analytic functor at the centers of every cell of a box_divider, without recomputing
+// the parts of the expression that only depend on one axis.
+//
+// for f = multiply<exp<x>, sin<y>, pow<z, rational<2>>> over an n x n x n grid, evaluating f directly costs 3n^3
+// transcendental calls.  here the type of f is split using dependency.h:
+//	- subexpressions reading no arguments are evaluated once
+//	- subexpressions reading a single argument are tabulated once per cell along that axis
+//	- sums and products reading several arguments are rebuilt from their (possibly tabulated) terms in the inner loop
+//	- anything else reading several arguments is evaluated directly at the cell center
+// so the example above costs 3n transcendental calls and n^3 table lookups and multiplies.
+
+#include <cstdint>
+#include <array>
+#include <vector>
+
+#include "analytic.h"
+#include "dependency.h"
+#include "box.h"
+#include "separable_integral.h"
+
+namespace math {
+	namespace detail {
+		constexpr unsigned popcount(std::uint64_t m) {
+			return (m ? unsigned(m & 1) + popcount(m >> 1) : 0);
+		}
+		constexpr std::size_t lowest_axis(std::uint64_t m) {
+			return (m & 1 ? 0 : 1 + lowest_axis(m >> 1));
+		}
+		
+		// centers of the cells along each axis of a box_divider
+		template <typename Vector>
+		struct grid_axes {
+			static constexpr std::size_t dimension = Vector::rows();
+			
+			template <typename Box>
+			explicit grid_axes(box_divider<Box> const & d) : base(d.region().a()) {
+				auto size = d.size();
+				
+				for (std::size_t i = 0; i < dimension; ++i) {
+					for (std::size_t k = 0; k < size[i]; ++k)
+						center[i].push_back((d.edge(i, k) + d.edge(i, k + 1)) / 2);
+				}
+			}
+			
+			Vector base;
+			std::array<std::vector<typename Vector::value_type>, dimension>	center;
+		};
+		
+		enum grid_node_kind {
+			gn_constant,
+			gn_table,
+			gn_add,
+			gn_multiply,
+			gn_direct
+		};
+		
+		// the arguments F reads, among the ones a Vector provides
+		template <typename F, typename Vector>
+		struct _grid_reads {
+			static constexpr std::uint64_t value = analytic::dependencies<F>::value &
+				(Vector::rows() < 64 ? (std::uint64_t(1) << Vector::rows()) - 1 : ~std::uint64_t(0));
+		};
+		
+		template <typename F, typename Vector>
+		struct _grid_node_kind {
+			static constexpr std::uint64_t reads = _grid_reads<F, Vector>::value;
+			
+			static constexpr grid_node_kind value = (reads == 0 ? gn_constant : (popcount(reads) == 1 ? gn_table : gn_direct));
+		};
+		template <typename F, typename G, typename Vector>
+		struct _grid_node_kind<analytic::detail::___add<F,G>, Vector> {
+			static constexpr std::uint64_t reads = _grid_reads<analytic::detail::___add<F,G>, Vector>::value;
+			
+			static constexpr grid_node_kind value = (reads == 0 ? gn_constant : (popcount(reads) == 1 ? gn_table : gn_add));
+		};
+		template <typename F, typename G, typename Vector>
+		struct _grid_node_kind<analytic::detail::___multiply<F,G>, Vector> {
+			static constexpr std::uint64_t reads = _grid_reads<analytic::detail::___multiply<F,G>, Vector>::value;
+			
+			static constexpr grid_node_kind value = (reads == 0 ? gn_constant : (popcount(reads) == 1 ? gn_table : gn_multiply));
+		};
+		
+		template <typename F, typename Vector, grid_node_kind Kind = _grid_node_kind<F, Vector>::value>
+		class grid_node;
+		
+		template <typename F, typename Vector>
+		class grid_node<F, Vector, gn_constant> {
+		public:
+			typedef decltype(call_with(F{}, std::declval<Vector>())) result_type;
+			
+			explicit grid_node(grid_axes<Vector> const & g) : _value(call_with(F{}, g.base)) { }
+			
+			template <typename Index>
+			result_type operator()(Index const &, Vector const &) const { return _value; }
+		private:
+			result_type		_value;
+		};
+		
+		template <typename F, typename Vector>
+		class grid_node<F, Vector, gn_table> {
+		public:
+			typedef decltype(call_with(F{}, std::declval<Vector>())) result_type;
+			
+			static constexpr std::size_t axis = lowest_axis(_grid_reads<F, Vector>::value);
+			
+			explicit grid_node(grid_axes<Vector> const & g) {
+				Vector p = g.base;
+				
+				for (auto c : g.center[axis]) {
+					p[axis] = c;
+					_table.push_back(call_with(F{}, p));
+				}
+			}
+			
+			template <typename Index>
+			result_type operator()(Index const & i, Vector const &) const { return _table[i[axis]]; }
+		private:
+			std::vector<result_type>	_table;
+		};
+		
+		template <typename F, typename G, typename Vector>
+		class grid_node<analytic::detail::___add<F,G>, Vector, gn_add> {
+		public:
+			typedef decltype(call_with(analytic::detail::___add<F,G>{}, std::declval<Vector>())) result_type;
+			
+			explicit grid_node(grid_axes<Vector> const & g) : _f(g), _g(g) { }
+			
+			template <typename Index>
+			result_type operator()(Index const & i, Vector const & p) const { return _f(i, p) + _g(i, p); }
+		private:
+			grid_node<F, Vector>	_f;
+			grid_node<G, Vector>	_g;
+		};
+		
+		template <typename F, typename G, typename Vector>
+		class grid_node<analytic::detail::___multiply<F,G>, Vector, gn_multiply> {
+		public:
+			typedef decltype(call_with(analytic::detail::___multiply<F,G>{}, std::declval<Vector>())) result_type;
+			
+			explicit grid_node(grid_axes<Vector> const & g) : _f(g), _g(g) { }
+			
+			template <typename Index>
+			result_type operator()(Index const & i, Vector const & p) const { return _f(i, p) * _g(i, p); }
+		private:
+			grid_node<F, Vector>	_f;
+			grid_node<G, Vector>	_g;
+		};
+		
+		template <typename F, typename Vector>
+		class grid_node<F, Vector, gn_direct> {
+		public:
+			typedef decltype(call_with(F{}, std::declval<Vector>())) result_type;
+			
+			explicit grid_node(grid_axes<Vector> const &) { }
+			
+			template <typename Index>
+			result_type operator()(Index const &, Vector const & p) const { return call_with(F{}, p); }
+		};
+	}
+	
+	// evaluates the analytic functor F at every cell center of a box_divider.
+	template <typename F, typename Box>
+	class grid_evaluator {
+	public:
+		typedef box_divider<Box>							divider_type;
+		typedef typename divider_type::vector_type			vector_type;
+		typedef typename divider_type::step_vector_type		index_type;
+		typedef detail::grid_node<F, vector_type>			node_type;
+		typedef typename node_type::result_type				result_type;
+		
+		static constexpr std::size_t dimension = vector_type::rows();
+		
+		explicit grid_evaluator(divider_type const & d) : _divider(d), _axes(d), _root(_axes) { }
+		
+		// calls fn(index, value) for every cell, in the divider's 1D index order (axis 0 fastest)
+		template <typename Function>
+		void for_each(Function fn) const {
+			auto size = _divider.size();
+			auto total = _divider.size_total();
+			
+			if (total == 0)
+				return;
+			
+			index_type	i(std::size_t(0));
+			vector_type	p;
+			
+			for (std::size_t a = 0; a < dimension; ++a)
+				p[a] = _axes.center[a][0];
+			
+			for (std::size_t n = 0; n < total; ++n) {
+				fn(i, _root(i, p));
+				
+				// odometer, only touching the coordinates that changed
+				for (std::size_t a = 0; a < dimension; ++a) {
+					if (++i[a] < size[a]) {
+						p[a] = _axes.center[a][i[a]];
+						break;
+					}
+					
+					i[a] = 0;
+					p[a] = _axes.center[a][0];
+				}
+			}
+		}
+		
+		// writes the value at every cell, in 1D index order
+		template <typename OutputIterator>
+		OutputIterator sample(OutputIterator out) const {
+			for_each([&](index_type const &, result_type const & v) {
+				*out++ = v;
+			});
+			
+			return out;
+		}
+		
+		divider_type const &	divider() const { return _divider; }
+	private:
+		divider_type					_divider;
+		detail::grid_axes<vector_type>	_axes;
+		node_type						_root;
+	};
+	
+	template <typename F, typename Box>
+	grid_evaluator<F, Box> make_grid_evaluator(F, box_divider<Box> const & d) {
+		return grid_evaluator<F, Box>(d);
+	}
+	
+	// midpoint rule integral of F over the divided box, using the hoisted evaluation above.
+	// the same sum numeric_integral(f, measure::cartesian, d) computes, for analytic F.
+	template <typename F, typename Box>
+	auto grid_integral(F, box_divider<Box> const & d) -> typename grid_evaluator<F, Box>::result_type {
+		typedef grid_evaluator<F, Box> evaluator_t;
+		
+		evaluator_t e(d);
+		
+		// cell widths, per axis
+		std::array<std::vector<reals_t>, evaluator_t::dimension> width;
+		
+		for (std::size_t a = 0; a < evaluator_t::dimension; ++a) {
+			for (std::size_t k = 0; k < d.size()[a]; ++k)
+				width[a].push_back(d.edge(a, k + 1) - d.edge(a, k));
+		}
+		
+		typename evaluator_t::result_type sum{};
+		
+		e.for_each([&](typename evaluator_t::index_type const & i, typename evaluator_t::result_type const & v) {
+			reals_t w = 1;
+			
+			for (std::size_t a = 0; a < evaluator_t::dimension; ++a)
+				w *= width[a][i[a]];
+			
+			sum += v * w;
+		});
+		
+		return sum;
+	}
+}
+
+#endif
@@ -0,0 +1,307 @@
+//
+//  infinite_integral.h
+//  math
+//
+//  Created by Patrick Sauter on 10/19/26.
+//  Copyright (c) 2026 Patrick Sauter. All rights reserved.
+//
+
+#ifndef math_infinite_integral_h
+#define math_infinite_integral_h
+
+// integrals over boxes with infinite sides, like [0, inf) x (-inf, inf).  corners are given as a math::box
+// using std::numeric_limits<reals_t>::infinity() for the open ends.
+//
+// two ways to get there:
+//	- rational_map turns the function into one over the unit cube, x = a + t / (1 - t) and friends with the jacobian
+//	  multiplied in, so any of the other integrators can be used on the result.  fine for functions decaying like
+//	  a power, the transformed function is usually smooth.
+//	- de_integral uses the double exponential rules, tanh-sinh for finite sides, exp-sinh for half infinite ones and
+//	  sinh-sinh for the whole line.  for analytic integrands the error falls exponentially with the number of points,
+//	  so 10+ digits usually take a few hundred evaluations per axis.  end point singularities are fine too.
+//
+// both can take a product_measure, whose density is multiplied in at every point.
+
+#include <cmath>
+#include <limits>
+#include <vector>
+#include <array>
+#include <algorithm>
+
+#include "core.h"
+#include "box.h"
+#include "numeric_integral.h"
+#include "product_measure.h"
+
+namespace math {
+	struct de_options {
+		reals_t			target_error	= 0;
+		reals_t			relative_error	= 1e-10;
+		std::size_t		max_level		= 8;			// step 2^-level in the transformed variable
+		std::size_t		max_evaluations	= std::size_t(1) << 24;
+	};
+	
+	namespace detail {
+		enum axis_kind {
+			ak_finite,		// [a, b]
+			ak_lower,		// [a, inf)
+			ak_upper,		// (-inf, b]
+			ak_line			// (-inf, inf)
+		};
+		
+		inline axis_kind classify_axis(reals_t a, reals_t b) {
+			bool low = std::isinf(a), high = std::isinf(b);
+			
+			return (low ? (high ? ak_line : ak_upper) : (high ? ak_lower : ak_finite));
+		}
+		
+		// maps t in (0, 1) onto an axis
+		struct rational_axis {
+			rational_axis() = default;
+			rational_axis(reals_t a, reals_t b) : kind(classify_axis(a, b)), a(a), b(b) { }
+			
+			reals_t point(reals_t t) const {
+				switch (kind) {
+					case ak_finite:		return a + (b - a) * t;
+					case ak_lower:		return a + t / (1 - t);
+					case ak_upper:		return b - (1 - t) / t;
+					case ak_line:		return (t - reals_t(0.5)) / (t * (1 - t));
+				}
+				
+				return 0;
+			}
+			
+			reals_t jacobian(reals_t t) const {
+				switch (kind) {
+					case ak_finite:		return b - a;
+					case ak_lower:		return 1 / ((1 - t) * (1 - t));
+					case ak_upper:		return 1 / (t * t);
+					case ak_line:		return (t * t - t + reals_t(0.5)) / (t * (1 - t) * t * (1 - t));
+				}
+				
+				return 0;
+			}
+			
+			axis_kind	kind;
+			reals_t		a, b;
+		};
+		
+		// a point of a double exponential rule, j is its index at the current step
+		struct de_node {
+			long		j;
+			reals_t		x;
+			reals_t		w;
+		};
+		
+		// the double exponential rule for one axis, nodes at t = j h for |t| <= de_range
+		constexpr reals_t de_range = 4;
+		
+		inline std::vector<de_node> de_nodes(reals_t a, reals_t b, std::size_t level) {
+			axis_kind kind = classify_axis(a, b);
+			
+			long const n = long(de_range) << level;
+			reals_t const h = std::ldexp(reals_t(1), -int(level));
+			
+			std::vector<de_node> nodes;
+			
+			for (long j = -n; j <= n; ++j) {
+				reals_t t = j * h;
+				reals_t u = M_PI / 2 * std::sinh(t);
+				reals_t du = M_PI / 2 * std::cosh(t);
+				reals_t x, w;
+				
+				switch (kind) {
+					case ak_finite: {
+						// distance to the nearest end, computed directly so it doesn't round to zero
+						reals_t r = (b - a) / 2;
+						reals_t d = 1 / (std::exp(std::abs(u)) * std::cosh(u));
+						
+						x = (t < 0 ? a + r * d : b - r * d);
+						w = r * du / (std::cosh(u) * std::cosh(u));
+						break;
+					}
+					case ak_lower:
+						x = a + std::exp(u);
+						w = du * std::exp(u);
+						break;
+					case ak_upper:
+						x = b - std::exp(u);
+						w = du * std::exp(u);
+						break;
+					case ak_line:
+						x = std::sinh(u);
+						w = du * std::cosh(u);
+						break;
+				}
+				
+				// the tails fall off so fast they round onto the ends, or the weight underflows
+				if (!(w > 0) || !std::isfinite(w) || !std::isfinite(x) || x == a || x == b)
+					continue;
+				
+				nodes.push_back({ j, x, w });
+			}
+			
+			return nodes;
+		}
+	}
+	
+	// f over a box with (possibly) infinite sides, as a function over the unit cube.
+	template <typename Function, typename Vector>
+	class rational_map {
+	public:
+		typedef Vector											vector_type;
+		typedef decltype(std::declval<Function>()(std::declval<Vector>()))	result_type;
+		
+		static constexpr std::size_t dimension = vector_type::rows();
+		
+		rational_map(Function f, box<Vector> const & domain) : _f(std::move(f)) {
+			for (std::size_t i = 0; i < dimension; ++i)
+				_axes[i] = detail::rational_axis(domain.a()[i], domain.b()[i]);
+		}
+		
+		// the unit cube to integrate over
+		box<Vector> region() const {
+			return box<Vector>(Vector(reals_t(0)), Vector(reals_t(1)));
+		}
+		
+		Vector point(Vector const & t) const {
+			Vector x;
+			
+			for (std::size_t i = 0; i < dimension; ++i)
+				x[i] = _axes[i].point(t[i]);
+			
+			return x;
+		}
+		
+		reals_t jacobian(Vector const & t) const {
+			reals_t J = 1;
+			
+			for (std::size_t i = 0; i < dimension; ++i)
+				J *= _axes[i].jacobian(t[i]);
+			
+			return J;
+		}
+		
+		// zero on the faces at infinity, where an integrable f times the jacobian goes to zero anyway.
+		// rules with points on the faces (sparse grids) would otherwise get inf * 0.
+		result_type operator()(Vector const & t) const {
+			reals_t J = jacobian(t);
+			
+			if (!std::isfinite(J))
+				return result_type{};
+			
+			return _f(point(t)) * J;
+		}
+		
+		// at the center of a cell, so the grid based integrators never touch the faces at infinity
+		result_type operator()(box<Vector> cell) const {
+			return (*this)(Vector(cell));
+		}
+	private:
+		Function									_f;
+		std::array<detail::rational_axis, dimension>	_axes;
+	};
+	
+	template <typename Function, typename Vector>
+	rational_map<Function, Vector> make_rational_map(Function f, box<Vector> const & domain) {
+		return rational_map<Function, Vector>(std::move(f), domain);
+	}
+	
+	// with the density of a product measure multiplied in, for (r, theta, phi) with r in [0, inf) and so on.
+	template <typename Function, typename ... Axes, typename Vector>
+	auto make_rational_map(Function f, measure::product_measure<Axes...> mu, box<Vector> const & domain) {
+		return make_rational_map([f, mu](Vector const & x) { return f(x) * mu.density(x); }, domain);
+	}
+	
+	
+	
+	
+	// double exponential integral of f(Vector) over a box whose sides may be infinite.
+	// the step in the transformed variable is halved until two levels agree to the requested error, only
+	// evaluating the new points of each level.  the error is the difference of the last two levels.
+	template <typename Function, typename Vector>
+	auto de_integral(Function f, box<Vector> const & domain, de_options const & options = {})
+		-> integral_estimate<decltype(f(std::declval<Vector>()))>
+	{
+		typedef decltype(f(std::declval<Vector>())) result_t;
+		
+		static_assert(check::vector_space<result_t, reals_t>::value,
+					  "Assertion failed, return type not a vector space over the reals.");
+		
+		constexpr std::size_t N = Vector::rows();
+		
+		result_t		raw{};		// sum of f times the weights, without the step size
+		result_t		estimate{};
+		reals_t			error = std::numeric_limits<reals_t>::infinity();
+		std::size_t		evaluations = 0;
+		
+		for (std::size_t level = 0; level <= options.max_level; ++level) {
+			std::array<std::vector<detail::de_node>, N> nodes;
+			std::size_t count = 1;
+			
+			for (std::size_t i = 0; i < N; ++i) {
+				nodes[i] = detail::de_nodes(domain.a()[i], domain.b()[i], level);
+				count *= nodes[i].size();
+			}
+			
+			if (level > 0 && evaluations + count > options.max_evaluations)
+				break;
+			
+			// tensor product of the axis rules, skipping the points the coarser levels already have.
+			// those have even indices along every axis.
+			std::array<std::size_t, N> k{};
+			
+			while (count > 0) {
+				bool old = (level > 0);
+				
+				for (std::size_t i = 0; i < N && old; ++i)
+					old = (nodes[i][k[i]].j % 2 == 0);
+				
+				if (!old) {
+					Vector x;
+					reals_t w = 1;
+					
+					for (std::size_t i = 0; i < N; ++i) {
+						x[i] = nodes[i][k[i]].x;
+						w *= nodes[i][k[i]].w;
+					}
+					
+					raw += f(x) * w;
+					++evaluations;
+				}
+				
+				std::size_t i = 0;
+				
+				for (; i < N && ++k[i] == nodes[i].size(); ++i)
+					k[i] = 0;
+				
+				if (i == N)
+					break;
+			}
+			
+			result_t next = raw * std::ldexp(reals_t(1), -int(level * N));
+			
+			if (level > 0) {
+				error = std::sqrt(detail::magnitude2(result_t(next - estimate)));
+				
+				estimate = next;
+				
+				if (error <= std::max(options.target_error, options.relative_error * std::sqrt(detail::magnitude2(estimate))))
+					break;
+			} else
+				estimate = next;
+		}
+		
+		return { estimate, error, evaluations };
+	}
+	
+	// the same with the density of a product measure multiplied in.
+	template <typename Function, typename ... Axes, typename Vector>
+	auto de_integral(Function f, measure::product_measure<Axes...> const & mu, box<Vector> const & domain, de_options const & options = {})
+		-> integral_estimate<decltype(f(std::declval<Vector>()))>
+	{
+		return de_integral([&](Vector const & x) { return f(x) * mu.density(x); }, domain, options);
+	}
+}
+
+#endif
@@ -0,0 +1,378 @@
+//
+//  lu.h
+//  math
+//
+//  Created by Patrick Sauter on 10/19/26.
+//  Copyright (c) 2026 Patrick Sauter. All rights reserved.
+//
+
+#ifndef math_lu_h
+#define math_lu_h
+
+// LU decomposition with partial pivoting, P A = L U, and the determinant, inverse and solve built on it.
+//
+//		auto f = lu(A);			// A a square matrix<T,N,N> or dmatrix<T>
+//		f.determinant();
+//		f.solve(B);				// X with A X = B, any number of columns
+//		f.inverse();
+//
+// the factors are kept in one matrix, L below the diagonal (its diagonal is all ones and not stored) and U on and
+// above it.  pivots()[j] is the row swapped with row j at step j.  factoring is O(n^3), against O(n! n) for the
+// determinant by permutations, and every solve after it is O(n^2) per column.
+//
+// for double, float and their complex types, matrices of more than 2 lu_block rows are factored lu_block columns at a
+// time.  each panel is factored on its own, and the rest of the matrix updated with one gemm, which is where almost
+// all the work is, so the large sizes run near the speed of a matrix product.
+//
+// these need Type to be a field.  over a ring like the integers, determinant(A) uses bareiss' fraction free
+// elimination instead, where every division is exact, so the answer is exact and nothing grows past the size of the
+// determinant itself.  a singular matrix gives a determinant of 0, and solve or inverse throw math::singular.
+
+#include <cmath>
+#include <array>
+#include <vector>
+#include <complex>
+#include <utility>
+#include <algorithm>
+#include <type_traits>
+
+#include "core.h"
+#include "exceptions.h"
+#include "matrix.h"
+#include "dmatrix.h"
+#include "gemm.h"
+
+namespace math {
+	namespace detail {
+		// columns per panel in the blocked factorisation
+		constexpr std::size_t lu_block = 64;
+		
+		// square matrices by kind, the pivot storage and identity for each
+		template <typename Matrix>
+		struct square;
+		
+		template <typename T, std::size_t N>
+		struct square<matrix<T,N,N>> {
+			typedef T							value_type;
+			typedef std::array<std::size_t, N>	pivots_type;
+			
+			static std::size_t size(matrix<T,N,N> const &) { return N; }
+			static pivots_type pivots(std::size_t) { return pivots_type{}; }
+			static matrix<T,N,N> identity(std::size_t) { return matrix<T,N,N>(math::multiplicative_identity); }
+		};
+		
+		template <typename T>
+		struct square<dmatrix<T>> {
+			typedef T							value_type;
+			typedef std::vector<std::size_t>	pivots_type;
+			
+			static std::size_t size(dmatrix<T> const & a) {
+				check_size(a.rows() == a.cols(), "Matrix is not square.");
+				
+				return a.rows();
+			}
+			static pivots_type pivots(std::size_t n) { return pivots_type(n); }
+			static dmatrix<T> identity(std::size_t n) { return dmatrix<T>::identity(n); }
+		};
+		
+		template <typename T>
+		auto pivot_size(T const & x) {
+			using std::abs;
+			
+			return abs(x);
+		}
+		
+		// x^H, and |x|^2, for real and complex entries
+		template <typename T>
+		T conjugate(T const & x) { return x; }
+		template <typename T>
+		std::complex<T> conjugate(std::complex<T> const & x) { return std::conj(x); }
+		
+		template <typename T>
+		T abs2(T const & x) { return x * x; }
+		template <typename T>
+		T abs2(std::complex<T> const & x) { return std::norm(x); }
+		
+		// the real type under T, T itself or what std::complex<> holds
+		template <typename T>
+		using real_part_t = typename std::decay<decltype(abs2(std::declval<T>()))>::type;
+		
+		// factors the rows x cols panel at a, rows of the panel are ld apart.  piv[j] is the panel row swapped with row j.
+		// columns without a nonzero pivot are skipped and singular set
+		template <typename T>
+		void lu_panel(T * a, std::size_t rows, std::size_t cols, std::size_t ld, std::size_t * piv, bool & singular) {
+			T const zero = T(math::additive_identity);
+			
+			for (std::size_t j = 0; j < std::min(rows, cols); ++j) {
+				std::size_t p = j;
+				auto largest = pivot_size(a[j * ld + j]);
+				
+				for (std::size_t i = j + 1; i < rows; ++i) {
+					auto s = pivot_size(a[i * ld + j]);
+					
+					if (largest < s) {
+						largest = s;
+						p = i;
+					}
+				}
+				
+				piv[j] = p;
+				
+				if (a[p * ld + j] == zero) {
+					singular = true;
+					continue;
+				}
+				
+				if (p != j)
+					std::swap_ranges(a + j * ld, a + j * ld + cols, a + p * ld);
+				
+				T const * u = a + j * ld;
+				
+				for (std::size_t i = j + 1; i < rows; ++i) {
+					T * r = a + i * ld;
+					T const l = r[j] = r[j] / u[j];
+					
+					for (std::size_t c = j + 1; c < cols; ++c)
+						r[c] = r[c] - l * u[c];
+				}
+			}
+		}
+		
+		// the n x n matrix at a in place, one panel for all of it
+		template <typename T>
+		void lu_factor(T * a, std::size_t n, std::size_t * piv, bool & singular, std::false_type) {
+			lu_panel(a, n, n, n, piv, singular);
+		}
+		
+		// right looking blocked version, the trailing matrix is updated by gemm after each panel
+		template <typename T>
+		void lu_factor(T * a, std::size_t n, std::size_t * piv, bool & singular, std::true_type) {
+			if (n <= 2 * lu_block)
+				return lu_factor(a, n, piv, singular, std::false_type{});
+			
+			for (std::size_t k = 0; k < n; k += lu_block) {
+				std::size_t const b = std::min(lu_block, n - k), rest = n - k - b;
+				
+				lu_panel(a + k * n + k, n - k, b, n, piv + k, singular);
+				
+				// the same swaps on the columns left and right of the panel
+				for (std::size_t j = k; j < k + b; ++j) {
+					piv[j] += k;
+					
+					if (piv[j] != j) {
+						T * r = a + j * n, * s = a + piv[j] * n;
+						
+						std::swap_ranges(r, r + k, s);
+						std::swap_ranges(r + k + b, r + n, s + k + b);
+					}
+				}
+				
+				if (rest == 0)
+					break;
+				
+				// U12 = L11^-1 A12, then A22 -= L21 U12
+				for (std::size_t i = k + 1; i < k + b; ++i) {
+					T * r = a + i * n;
+					
+					for (std::size_t t = k; t < i; ++t) {
+						T const l = r[t];
+						T const * u = a + t * n;
+						
+						for (std::size_t c = k + b; c < n; ++c)
+							r[c] = r[c] - l * u[c];
+					}
+				}
+				
+				gemm(rest, rest, b, T(-1), a + (k + b) * n + k, n, a + k * n + k + b, n, T(1), a + (k + b) * n + k + b, n);
+			}
+		}
+		
+		// bareiss' elimination on the n x n matrix at a, destroying it.  every division is exact
+		template <typename T>
+		T bareiss_determinant(T * a, std::size_t n) {
+			T const zero = T(math::additive_identity);
+			T previous = T(math::multiplicative_identity);
+			bool negate = false;
+			
+			if (n == 0)
+				return previous;
+			
+			for (std::size_t k = 0; k + 1 < n; ++k) {
+				if (a[k * n + k] == zero) {
+					std::size_t p = k + 1;
+					
+					while (p < n && a[p * n + k] == zero)
+						++p;
+					
+					if (p == n)
+						return zero;
+					
+					std::swap_ranges(a + k * n, a + k * n + n, a + p * n);
+					negate = !negate;
+				}
+				
+				T const * u = a + k * n;
+				
+				for (std::size_t i = k + 1; i < n; ++i) {
+					T * r = a + i * n;
+					
+					for (std::size_t j = k + 1; j < n; ++j)
+						r[j] = (r[j] * u[k] - r[k] * u[j]) / previous;
+				}
+				
+				previous = u[k];
+			}
+			
+			T const & d = a[n * n - 1];
+			
+			return (negate ? T(-d) : d);
+		}
+	}
+	
+	template <typename Matrix>
+	class lu_decomposition {
+	public:
+		typedef detail::square<Matrix>					shape;
+		typedef typename shape::value_type				value_type;
+		typedef typename shape::pivots_type				pivots_type;
+		
+		static_assert(check::field<value_type>::value,
+					  "Assertion failed, LU decomposition needs a matrix over a field.");
+		
+		explicit lu_decomposition(Matrix a) : _lu(std::move(a)), _n(shape::size(_lu)), _pivots(shape::pivots(_n)) {
+			detail::lu_factor(_lu.data(), _n, _pivots.data(), _singular, detail::has_gemm<value_type>{});
+		}
+		
+		std::size_t size() const { return _n; }
+		bool singular() const { return _singular; }
+		
+		// L below the diagonal, U on and above it
+		Matrix const & factors() const { return _lu; }
+		pivots_type const & pivots() const { return _pivots; }
+		
+		value_type determinant() const {
+			value_type d = value_type(math::multiplicative_identity);
+			
+			for (std::size_t i = 0; i < _n; ++i) {
+				d = d * _lu[i * _n + i];
+				
+				if (_pivots[i] != i)
+					d = -d;
+			}
+			
+			return d;
+		}
+		
+		// X with A X = B.  B is any matrix with size() rows, a vector or many columns at once
+		template <typename B>
+		B solve(B b) const {
+			detail::check_size(b.rows() == _n, "Matrix sizes don't match.");
+			
+			if (_singular)
+				throw math::singular();
+			
+			std::size_t const m = b.cols();
+			value_type * x = b.data();
+			value_type const * a = _lu.data();
+			
+			for (std::size_t j = 0; j < _n; ++j) {
+				if (_pivots[j] != j)
+					std::swap_ranges(x + j * m, x + j * m + m, x + _pivots[j] * m);
+			}
+			
+			// L Y = P B, then U X = Y, whole rows at a time so the columns of B go together
+			for (std::size_t i = 1; i < _n; ++i) {
+				for (std::size_t k = 0; k < i; ++k) {
+					value_type const l = a[i * _n + k];
+					
+					for (std::size_t c = 0; c < m; ++c)
+						x[i * m + c] = x[i * m + c] - l * x[k * m + c];
+				}
+			}
+			
+			for (std::size_t i = _n; i-- > 0; ) {
+				for (std::size_t k = i + 1; k < _n; ++k) {
+					value_type const u = a[i * _n + k];
+					
+					for (std::size_t c = 0; c < m; ++c)
+						x[i * m + c] = x[i * m + c] - u * x[k * m + c];
+				}
+				
+				for (std::size_t c = 0; c < m; ++c)
+					x[i * m + c] = x[i * m + c] / a[i * _n + i];
+			}
+			
+			return b;
+		}
+		
+		Matrix inverse() const {
+			return solve(shape::identity(_n));
+		}
+	private:
+		Matrix			_lu;
+		std::size_t		_n;
+		pivots_type		_pivots;
+		bool			_singular = false;
+	};
+	
+	template <typename Matrix>
+	lu_decomposition<typename std::decay<Matrix>::type> lu(Matrix && a) {
+		return lu_decomposition<typename std::decay<Matrix>::type>(std::forward<Matrix>(a));
+	}
+	
+	// ------------------------------------------------------
+	// DETERMINANT
+	// by LU over a field, fraction free over a ring with exact division
+	
+	template <typename T, std::size_t N, typename = typename std::enable_if<check::field<T>::value>::type>
+	T determinant(matrix<T,N,N> const & a) {
+		return lu(a).determinant();
+	}
+	template <typename T, typename = typename std::enable_if<check::field<T>::value>::type>
+	T determinant(dmatrix<T> const & a) {
+		return lu(a).determinant();
+	}
+	
+	template <typename T, std::size_t N,
+		typename = typename std::enable_if<
+			!check::field<T>::value &&
+			pat::traits::has_divide<T,T,T>::value
+		>::type, typename = void>
+	T determinant(matrix<T,N,N> a) {
+		return detail::bareiss_determinant(a.data(), N);
+	}
+	template <typename T,
+		typename = typename std::enable_if<
+			!check::field<T>::value &&
+			pat::traits::has_divide<T,T,T>::value
+		>::type, typename = void>
+	T determinant(dmatrix<T> a) {
+		std::size_t const n = detail::square<dmatrix<T>>::size(a);
+		
+		return detail::bareiss_determinant(a.data(), n);
+	}
+	
+	// ------------------------------------------------------
+	// inverse and solve, over a field
+	
+	template <typename T, std::size_t N, typename = typename std::enable_if<check::field<T>::value>::type>
+	matrix<T,N,N> inverse(matrix<T,N,N> const & a) {
+		return lu(a).inverse();
+	}
+	template <typename T, typename = typename std::enable_if<check::field<T>::value>::type>
+	dmatrix<T> inverse(dmatrix<T> const & a) {
+		return lu(a).inverse();
+	}
+	
+	// X with A X = B, for more than one B factor A once with lu(A) and call solve on that
+	template <typename T, std::size_t N, std::size_t M, typename = typename std::enable_if<check::field<T>::value>::type>
+	matrix<T,N,M> solve(matrix<T,N,N> const & a, matrix<T,N,M> const & b) {
+		return lu(a).solve(b);
+	}
+	template <typename T, typename B, typename = typename std::enable_if<check::field<T>::value>::type>
+	B solve(dmatrix<T> const & a, B const & b) {
+		return lu(a).solve(b);
+	}
+}
+
+#endif
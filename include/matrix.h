@@ -17,6 +17,7 @@
 #include <numeric>
 
 #include "core.h"
+#include "gemm.h"
 
 #include <pat/array.h>
 #include <pat/iterator_range.h>
@@ -124,7 +125,7 @@ namespace math {
 	// matrix == matrix
 	template <typename T, std::size_t N, std::size_t M>
 	bool operator==(matrix<T,N,M> const & a, matrix<T,N,M> const & b) {
-		for (auto i = 0; i < a.size(); ++i)
+		for (std::size_t i = 0; i < a.size(); ++i)
 			if (a[i] != b[i])
 				return false;
 
@@ -135,18 +136,28 @@ namespace math {
 		return !(a == b);
 	}
 	
-
+	
+	// ------------------------------------------------------
+	// the elementwise operators below loop through for_entries (parallel.h), which splits the loop over threads once
+	// the matrix has a few hundred thousand entries, and is the plain loop below that.
+	
 	// ------------------------------------------------------
 	// matrix += matrix
 	template <typename T, std::size_t N, std::size_t M>
 	matrix<T,N,M>& operator+=(matrix<T,N,M> & a, matrix<T,N,M> const & b) {
-		a = a + b;
+		for_entries(a.size(), [&](std::size_t first, std::size_t last) {
+			for (std::size_t i = first; i < last; ++i)
+				a[i] = a[i] + b[i];
+		});
 		
 		return a;
 	}
 	template <typename T, std::size_t N, std::size_t M>
 	matrix<T,N,M>&& operator+=(matrix<T,N,M> && a, matrix<T,N,M> const & b) {
-		a = a + b;
+		for_entries(a.size(), [&](std::size_t first, std::size_t last) {
+			for (std::size_t i = first; i < last; ++i)
+				a[i] = a[i] + b[i];
+		});
 		
 		return std::move(a);
 	}
@@ -156,13 +167,19 @@ namespace math {
 	
 	template <typename T, std::size_t N, std::size_t M>
 	matrix<T,N,M>& operator-=(matrix<T,N,M>& a, matrix<T,N,M> const & b) {
-		a = a - b;
+		for_entries(a.size(), [&](std::size_t first, std::size_t last) {
+			for (std::size_t i = first; i < last; ++i)
+				a[i] = a[i] - b[i];
+		});
 		
 		return a;
 	}
 	template <typename T, std::size_t N, std::size_t M>
 	matrix<T,N,M>&& operator-=(matrix<T,N,M> && a, matrix<T,N,M> const & b) {
-		a = a - b;
+		for_entries(a.size(), [&](std::size_t first, std::size_t last) {
+			for (std::size_t i = first; i < last; ++i)
+				a[i] = a[i] - b[i];
+		});
 		
 		return std::move(a);
 	}
@@ -172,17 +189,39 @@ namespace math {
 	// ------------------------------------------------------
 	// matrix * matrix
 	
+	namespace detail {
+		// below this many multiply adds the packing in gemm costs more than it saves
+		constexpr std::size_t gemm_threshold = 4096;
+		
+		template <typename T, typename Y, std::size_t N, std::size_t M, std::size_t P>
+		struct use_gemm : std::integral_constant<bool,
+			std::is_same<T,Y>::value && has_gemm<T>::value && (N * M * P >= gemm_threshold)
+		> { };
+		
+		// any ring, entry by entry
+		template <typename T, typename Y, std::size_t N, std::size_t M, std::size_t P>
+		void multiply(matrix<T,N,M> const & a, matrix<Y,M,P> const & b, matrix<std::common_type_t<T,Y>,N,P> & m, std::false_type) {
+			for (std::size_t i = 0; i < N; ++i) {
+				for (std::size_t j = 0; j < P; ++j) {
+					auto row = a.row(i);
+					
+					m[i * P + j] = std::inner_product(row.begin(), row.end(), b.col(j).begin(), T{});
+				}
+			}
+		}
+		
+		// float, double and complex, blocked and vectorized
+		template <typename T, std::size_t N, std::size_t M, std::size_t P>
+		void multiply(matrix<T,N,M> const & a, matrix<T,M,P> const & b, matrix<T,N,P> & m, std::true_type) {
+			gemm(N, P, M, T(1), a.data(), M, b.data(), P, T(0), m.data(), P);
+		}
+	}
+	
 	template <typename T, typename Y, std::size_t N, std::size_t M, std::size_t P>
 	matrix<std::common_type_t<T,Y>,N,P> operator*(matrix<T,N,M> const & a, matrix<Y,M,P> const & b) {
 		matrix<std::common_type_t<T,Y>,N,P>	m;
 		
-		for (std::size_t i = 0; i < N; ++i) {
-			for (std::size_t j = 0; j < P; ++j) {
-				auto row = a.row(i);
-				
-				m[i * P + j] = std::inner_product(row.begin(), row.end(), b.col(j).begin(), T{});
-			}
-		}
+		detail::multiply(a, b, m, detail::use_gemm<T,Y,N,M,P>{});
 		
 		return m;
 	}
@@ -195,9 +234,11 @@ namespace math {
 	matrix<std::common_type_t<T,Y>,N,M> operator+(matrix<T,N,M> const & a, matrix<Y,N,M> const & b) {
 		matrix<std::common_type_t<T,Y>,N,M> t;
 		
-		for (auto i = 0; i < a.size(); ++i)
-			t[i] = a[i] + b[i];
-
+		for_entries(a.size(), [&](std::size_t first, std::size_t last) {
+			for (std::size_t i = first; i < last; ++i)
+				t[i] = a[i] + b[i];
+		});
+		
 		return t;
 	}
 	
@@ -208,9 +249,11 @@ namespace math {
 	matrix<T,N,M> operator-(matrix<T,N,M> const & a) {
 		matrix<T,N,M> t;
 		
-		for (auto i = 0; i < a.size(); ++i)
-			t[i] = -a[i];
-
+		for_entries(a.size(), [&](std::size_t first, std::size_t last) {
+			for (std::size_t i = first; i < last; ++i)
+				t[i] = -a[i];
+		});
+		
 		return t;
 	}
 	
@@ -221,14 +264,17 @@ namespace math {
 	matrix<std::common_type_t<T,Y>,N,M> operator-(matrix<T,N,M> const & a, matrix<Y,N,M> const & b) {
 		matrix<std::common_type_t<T,Y>,N,M> t;
 		
-		for (auto i = 0; i < a.size(); ++i)
-			t[i] = a[i] - b[i];
-
+		for_entries(a.size(), [&](std::size_t first, std::size_t last) {
+			for (std::size_t i = first; i < last; ++i)
+				t[i] = a[i] - b[i];
+		});
+		
 		return t;
 	}
 
 	// --------------------------------------------------
 	// TRANSPOSE
+	// copies, transpose_view in view.h gives the transpose without copying.
 	// I could consider adding a flag to say whether the matrix is transposed or not
 	// then adjust the returned iterator based on that flag.
 	// depends on how many checks against that flag would be required vs just transposing like this.
@@ -252,7 +298,7 @@ namespace math {
 	matrix<T,N,M+P> hconcat(matrix<T,N,M> const & a, matrix<T,N,P> const & b) {
 		matrix<T,N,M+P> m;
 		
-		for (auto i = 0; i < a.rows(); ++i) {
+		for (std::size_t i = 0; i < a.rows(); ++i) {
 			auto A = a.row(i);
 			auto B = b.row(i);
 			
@@ -274,18 +320,7 @@ namespace math {
 		
 	
 	// --------------------------------------------------
-	// DETERMINANT
-	
-/*	template <typename T, std::size_t N> {
-	T determinant(matrix<T,N,N> const & a) {
-	
-	I want to add permutations before I add this.
-*/
-	
-	// --------------------------------------------------
-	// inverse
-	// this needs to be enabled only if the matrix is over a field, not a ring.
-	// also depends on the determinant.
+	// DETERMINANT, inverse and solve are in lu.h
 	
 	// ------------------------------------------------------
 	// matrix *= scalar
@@ -296,8 +331,10 @@ namespace math {
 				pat::traits::has_multiply<T,Scalar,T>::value
 			  >::type>
 	matrix<T,N,M>& operator*=(matrix<T,N,M>& a, Scalar const & s) {
-		for (int i = 0; i < a.size(); ++i)
-			a[i] = a[i] * s;
+		for_entries(a.size(), [&](std::size_t first, std::size_t last) {
+			for (std::size_t i = first; i < last; ++i)
+				a[i] = a[i] * s;
+		});
 		
 		return a;
 	}
@@ -306,8 +343,10 @@ namespace math {
 				pat::traits::has_multiply<T,Scalar,T>::value
 			  >::type>
 	matrix<T,N,M>&& operator*=(matrix<T,N,M>&& a, Scalar const & s) {
-		for (int i = 0; i < a.size(); ++i)
-			a[i] = a[i] * s;
+		for_entries(a.size(), [&](std::size_t first, std::size_t last) {
+			for (std::size_t i = first; i < last; ++i)
+				a[i] = a[i] * s;
+		});
 		
 		return std::move(a);
 	}
@@ -322,8 +361,10 @@ namespace math {
 		>::type>
 	matrix<T,N,M>&
 	operator/=(matrix<T,N,M>& a, Scalar const & s) {
-		for (int i = 0; i < N; ++i)
-			a[i] = a[i] / s;
+		for_entries(a.size(), [&](std::size_t first, std::size_t last) {
+			for (std::size_t i = first; i < last; ++i)
+				a[i] = a[i] / s;
+		});
 		
 		return a;
 	}
@@ -334,8 +375,10 @@ namespace math {
 		>::type>
 	matrix<T,N,M>&&
 	operator/=(matrix<T,N,M>&& a, Scalar const & s) {
-		for (int i = 0; i < N; ++i)
-			a[i] = a[i] / s;
+		for_entries(a.size(), [&](std::size_t first, std::size_t last) {
+			for (std::size_t i = first; i < last; ++i)
+				a[i] = a[i] / s;
+		});
 		
 		return std::move(a);
 	}
@@ -354,9 +397,11 @@ namespace math {
 	operator*(matrix<T,N,M> const & a, Scalar const & s) {
 		matrix<T,N,M> t;
 		
-		for (auto i = 0; i < a.size(); ++i)
-			t[i] = a[i] * s;
-
+		for_entries(a.size(), [&](std::size_t first, std::size_t last) {
+			for (std::size_t i = first; i < last; ++i)
+				t[i] = a[i] * s;
+		});
+		
 		return t;
 	}
 	template <std::size_t N, std::size_t M, typename T, typename Scalar,
@@ -367,8 +412,10 @@ namespace math {
 	operator*(Scalar const & s, matrix<T,N,M> const & a) {
 		matrix<T,N,M> t;
 		
-		for (int i = 0; i < t.size(); ++i)
-			t[i] = s * a[i];
+		for_entries(t.size(), [&](std::size_t first, std::size_t last) {
+			for (std::size_t i = first; i < last; ++i)
+				t[i] = s * a[i];
+		});
 		
 		return t;
 	}
@@ -385,8 +432,10 @@ namespace math {
 	operator/(matrix<T,N,M> const & a, Scalar const & s) {
 		matrix<T,N,M> t;
 		
-		for (int i = 0; i < t.size(); ++i)
-			t[i] = a[i] / s;
+		for_entries(t.size(), [&](std::size_t first, std::size_t last) {
+			for (std::size_t i = first; i < last; ++i)
+				t[i] = a[i] / s;
+		});
 		
 		return t;
 	}
@@ -397,7 +446,7 @@ namespace std {
 	ostream & operator<<(ostream& out, math::matrix<T,N,M> const & a) {
 		out << "{" << std::endl;
 		
-		for (int i = 0; i < N; ++i) {
+		for (std::size_t i = 0; i < N; ++i) {
 			for (auto j : a.row(i)) {
 				out << std::setw(3) << j;
 			}
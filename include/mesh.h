@@ -0,0 +1,488 @@
+//
+//  mesh.h
+//  math
+//
+//  Created by Patrick Sauter on 10/19/26.
+//  Copyright (c) 2026 Patrick Sauter. All rights reserved.
+//
+
+#ifndef math_mesh_h
+#define math_mesh_h
+
+// triangle and tetrahedral meshes as integration domains, integrated element by element with the rules from
+// simplex.h and the elements spread over threads.
+//
+//		auto m = map_mesh<vector<reals_t,3>, 2>("surface.mesh");		// triangles in 3D
+//		mesh_integral(f, m, 5);
+//
+// two file formats,
+//	- binary, a mesh_header, then the vertex coordinates as doubles and the element indices as uint32.  the file is
+//	  memory mapped and the mesh reads straight out of the mapping, nothing is copied or parsed, so meshes larger
+//	  than memory are fine and only the pages the integral touches get read.  the vertex indices of an element are
+//	  checked when the element is read, not all at once when the file is opened.  save_mesh writes it.
+//	- obj like text, "v x y z" lines for vertices and "f i j k" lines (1 based, obj's i/t/n and negative indices
+//	  work) with K + 1 indices for elements, 4 for tetrahedra.  other lines are skipped.  load_obj_mesh maps the
+//	  file too and parses it in one pass straight into the mesh, no per line strings.
+//
+// everything is native byte order, and mapping needs a posix system.
+
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <cctype>
+#include <array>
+#include <vector>
+#include <algorithm>
+#include <string>
+#include <memory>
+#include <fstream>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "core.h"
+#include "simplex.h"
+#include "parallel.h"
+
+namespace math {
+	// start of a binary mesh file, 32 bytes so the doubles after it stay aligned
+	struct mesh_header {
+		char			magic[8];		// "MATHMESH"
+		std::uint32_t	dimension;		// coordinates per vertex
+		std::uint32_t	order;			// vertices per element, K + 1
+		std::uint64_t	vertices;
+		std::uint64_t	elements;
+	};
+	
+	namespace detail {
+		constexpr char mesh_magic[8] = { 'M', 'A', 'T', 'H', 'M', 'E', 'S', 'H' };
+		
+		// elements per task in mesh_integral
+		constexpr std::size_t mesh_block = 1024;
+		
+		// a whole file mapped read only
+		class mapped_file {
+		public:
+			explicit mapped_file(std::string const & path) {
+				int fd = ::open(path.c_str(), O_RDONLY);
+				
+				if (fd < 0)
+					throw std::runtime_error("Can't open mesh file " + path + ".");
+				
+				struct stat info;
+				
+				if (::fstat(fd, &info) != 0) {
+					::close(fd);
+					throw std::runtime_error("Can't read mesh file " + path + ".");
+				}
+				
+				_size = std::size_t(info.st_size);
+				
+				if (_size > 0) {
+					void * p = ::mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+					
+					if (p == MAP_FAILED) {
+						::close(fd);
+						throw std::runtime_error("Can't map mesh file " + path + ".");
+					}
+					
+					_data = static_cast<char const *>(p);
+				}
+				
+				// the mapping keeps the file alive
+				::close(fd);
+			}
+			
+			mapped_file(mapped_file const &) = delete;
+			mapped_file & operator=(mapped_file const &) = delete;
+			
+			~mapped_file() {
+				if (_data)
+					::munmap(const_cast<char *>(_data), _size);
+			}
+			
+			char const * data() const { return _data; }
+			std::size_t size() const { return _size; }
+			
+			// a hint that the file is about to be read front to back
+			void sequential() const {
+				if (_data)
+					::madvise(const_cast<char *>(_data), _size, MADV_SEQUENTIAL);
+			}
+		private:
+			char const *	_data = nullptr;
+			std::size_t		_size = 0;
+		};
+		
+		// throws if an element refers to a vertex that isn't there
+		template <typename Index>
+		void check_indices(Index const * indices, std::size_t count, std::size_t vertices) {
+			for (std::size_t i = 0; i < count; ++i) {
+				if (!(std::size_t(indices[i]) < vertices))
+					throw std::runtime_error("Mesh element refers to a missing vertex.");
+			}
+		}
+	}
+	
+	// a mesh held in memory, vertices and elements given by their vertex indices
+	template <typename Vector, std::size_t K = Vector::rows()>
+	class simplex_mesh {
+	public:
+		typedef Vector								vector_type;
+		typedef simplex<Vector, K>					element_type;
+		typedef std::array<std::uint32_t, K + 1>	index_type;
+		
+		static constexpr std::size_t dimension = K;
+		
+		std::size_t size() const { return _elements.size(); }
+		std::size_t vertex_count() const { return _vertices.size(); }
+		
+		vector_type const & vertex(std::size_t i) const { return _vertices[i]; }
+		index_type const & indices(std::size_t e) const { return _elements[e]; }
+		
+		element_type operator[](std::size_t e) const {
+			std::array<vector_type, K + 1> v;
+			
+			for (std::size_t i = 0; i <= K; ++i)
+				v[i] = _vertices[_elements[e][i]];
+			
+			return element_type(v);
+		}
+		
+		void reserve(std::size_t vertices, std::size_t elements) {
+			_vertices.reserve(vertices);
+			_elements.reserve(elements);
+		}
+		
+		void add_vertex(vector_type const & v) { _vertices.push_back(v); }
+		
+		void add_element(index_type const & e) {
+			detail::check_indices(e.data(), e.size(), _vertices.size());
+			_elements.push_back(e);
+		}
+	private:
+		std::vector<vector_type>	_vertices;
+		std::vector<index_type>		_elements;
+	};
+	
+	// a binary mesh file read in place
+	template <typename Vector, std::size_t K = Vector::rows()>
+	class mapped_mesh {
+	public:
+		typedef Vector								vector_type;
+		typedef simplex<Vector, K>					element_type;
+		typedef std::array<std::uint32_t, K + 1>	index_type;
+		
+		static constexpr std::size_t dimension = K;
+		
+		explicit mapped_mesh(std::string const & path) : _file(std::make_shared<detail::mapped_file>(path)) {
+			char const * p = _file->data();
+			std::size_t n = _file->size();
+			
+			mesh_header header;
+			
+			if (n < sizeof(header))
+				throw std::runtime_error("Mesh file " + path + " is too short.");
+			
+			std::memcpy(&header, p, sizeof(header));
+			
+			if (std::memcmp(header.magic, detail::mesh_magic, sizeof(header.magic)) != 0)
+				throw std::runtime_error("Mesh file " + path + " is not a binary mesh.");
+			
+			if (header.dimension != vector_type::rows() || header.order != K + 1)
+				throw std::runtime_error("Mesh file " + path + " has the wrong vertex dimension or element type.");
+			
+			// each count against what the file could hold before multiplying, so a corrupt header can't wrap around
+			std::uint64_t body = n - sizeof(header);
+			
+			if (header.vertices > body / (header.dimension * sizeof(double)) ||
+				header.elements > body / (header.order * sizeof(std::uint32_t)))
+				throw std::runtime_error("Mesh file " + path + " has the wrong size.");
+			
+			std::uint64_t coordinates = header.vertices * header.dimension;
+			std::uint64_t indices = header.elements * header.order;
+			
+			if (body != coordinates * sizeof(double) + indices * sizeof(std::uint32_t))
+				throw std::runtime_error("Mesh file " + path + " has the wrong size.");
+			
+			_vertex_count	= std::size_t(header.vertices);
+			_size			= std::size_t(header.elements);
+			_coordinates	= reinterpret_cast<double const *>(p + sizeof(header));
+			_indices		= reinterpret_cast<std::uint32_t const *>(_coordinates + coordinates);
+		}
+		
+		std::size_t size() const { return _size; }
+		std::size_t vertex_count() const { return _vertex_count; }
+		
+		vector_type vertex(std::size_t i) const {
+			vector_type v;
+			
+			for (std::size_t d = 0; d < vector_type::rows(); ++d)
+				v[d] = typename vector_type::value_type(_coordinates[i * vector_type::rows() + d]);
+			
+			return v;
+		}
+		
+		// as stored in the file, operator[] is the one that checks them against vertex_count()
+		index_type indices(std::size_t e) const {
+			index_type index;
+			
+			std::memcpy(index.data(), _indices + e * (K + 1), sizeof(index));
+			
+			return index;
+		}
+		
+		element_type operator[](std::size_t e) const {
+			std::array<vector_type, K + 1> v;
+			
+			for (std::size_t i = 0; i <= K; ++i) {
+				std::size_t const index = _indices[e * (K + 1) + i];
+				
+				if (!(index < _vertex_count))
+					throw std::runtime_error("Mesh element refers to a missing vertex.");
+				
+				v[i] = vertex(index);
+			}
+			
+			return element_type(v);
+		}
+	private:
+		std::shared_ptr<detail::mapped_file>	_file;
+		std::size_t								_size = 0, _vertex_count = 0;
+		double const *							_coordinates = nullptr;
+		std::uint32_t const *					_indices = nullptr;
+	};
+	
+	template <typename Vector, std::size_t K = Vector::rows()>
+	mapped_mesh<Vector, K> map_mesh(std::string const & path) {
+		return mapped_mesh<Vector, K>(path);
+	}
+	
+	// writes any mesh in the binary format, so it can be mapped later
+	template <typename Mesh>
+	void save_mesh(Mesh const & mesh, std::string const & path) {
+		typedef typename Mesh::vector_type vector_t;
+		
+		constexpr std::size_t K = Mesh::dimension;
+		
+		std::ofstream out(path, std::ios::binary);
+		
+		if (!out)
+			throw std::runtime_error("Can't write mesh file " + path + ".");
+		
+		mesh_header header;
+		
+		std::memcpy(header.magic, detail::mesh_magic, sizeof(header.magic));
+		header.dimension	= std::uint32_t(vector_t::rows());
+		header.order		= std::uint32_t(K + 1);
+		header.vertices		= mesh.vertex_count();
+		header.elements		= mesh.size();
+		
+		out.write(reinterpret_cast<char const *>(&header), sizeof(header));
+		
+		for (std::size_t i = 0; i < mesh.vertex_count(); ++i) {
+			auto v = mesh.vertex(i);
+			
+			for (std::size_t d = 0; d < vector_t::rows(); ++d) {
+				double x = double(v[d]);
+				out.write(reinterpret_cast<char const *>(&x), sizeof(x));
+			}
+		}
+		
+		for (std::size_t e = 0; e < mesh.size(); ++e) {
+			auto index = mesh.indices(e);
+			out.write(reinterpret_cast<char const *>(index.data()), sizeof(index));
+		}
+		
+		if (!out)
+			throw std::runtime_error("Can't write mesh file " + path + ".");
+	}
+	
+	namespace detail {
+		// a cursor over the mapped text, none of it is null terminated
+		struct obj_reader {
+			char const * p;
+			char const * end;
+			
+			bool done() const { return p == end; }
+			
+			void skip_blanks() {
+				while (p != end && (*p == ' ' || *p == '\t' || *p == '\r'))
+					++p;
+			}
+			
+			void next_line() {
+				char const * n = static_cast<char const *>(std::memchr(p, '\n', std::size_t(end - p)));
+				p = (n ? n + 1 : end);
+			}
+			
+			bool at_line_end() {
+				skip_blanks();
+				return p == end || *p == '\n' || *p == '#';
+			}
+			
+			// the next blank separated word, copied to a small buffer so strtod/strtol can't run off the mapping
+			bool word(char (&buffer)[64]) {
+				skip_blanks();
+				
+				std::size_t n = 0;
+				
+				while (p != end && !std::isspace(static_cast<unsigned char>(*p))) {
+					if (n + 1 < sizeof(buffer))
+						buffer[n++] = *p;
+					++p;
+				}
+				
+				buffer[n] = 0;
+				
+				return n > 0;
+			}
+			
+			reals_t number() {
+				char buffer[64], * stop;
+				
+				if (!word(buffer))
+					throw std::runtime_error("Missing coordinate in obj mesh.");
+				
+				reals_t x = reals_t(std::strtod(buffer, &stop));
+				
+				if (*stop)
+					throw std::runtime_error("Bad coordinate in obj mesh.");
+				
+				return x;
+			}
+			
+			// a face corner, "i", "i/t", "i//n" or "i/t/n", negative counts back from the last vertex
+			std::uint32_t index(std::size_t vertices) {
+				char buffer[64], * stop;
+				
+				if (!word(buffer))
+					throw std::runtime_error("Missing index in obj mesh.");
+				
+				long i = std::strtol(buffer, &stop, 10);
+				
+				if (stop == buffer || (*stop && *stop != '/'))
+					throw std::runtime_error("Bad index in obj mesh.");
+				
+				long k = (i < 0 ? long(vertices) + i : i - 1);
+				
+				if (i == 0 || k < 0 || std::size_t(k) >= vertices)
+					throw std::runtime_error("Obj mesh face refers to a missing vertex.");
+				
+				return std::uint32_t(k);
+			}
+			
+			// the keyword at the start of the line, "v", "f", or anything else
+			bool keyword(char const * key) {
+				std::size_t n = std::strlen(key);
+				
+				if (std::size_t(end - p) > n && std::memcmp(p, key, n) == 0 && (p[n] == ' ' || p[n] == '\t')) {
+					p += n;
+					return true;
+				}
+				
+				return false;
+			}
+		};
+	}
+	
+	// reads an obj like text mesh, vertices with Vector::rows() coordinates (extra ones are dropped) and faces of
+	// K + 1 vertices
+	template <typename Vector, std::size_t K = Vector::rows()>
+	simplex_mesh<Vector, K> load_obj_mesh(std::string const & path) {
+		detail::mapped_file file(path);
+		file.sequential();
+		
+		simplex_mesh<Vector, K> mesh;
+		
+		// a quick count first so the arrays are only allocated once
+		std::size_t vertices = 0, elements = 0;
+		
+		for (detail::obj_reader r{ file.data(), file.data() + file.size() }; !r.done(); r.next_line()) {
+			r.skip_blanks();
+			
+			if (r.keyword("v"))
+				++vertices;
+			else if (r.keyword("f"))
+				++elements;
+		}
+		
+		mesh.reserve(vertices, elements);
+		
+		for (detail::obj_reader r{ file.data(), file.data() + file.size() }; !r.done(); r.next_line()) {
+			r.skip_blanks();
+			
+			if (r.keyword("v")) {
+				Vector v;
+				
+				for (std::size_t d = 0; d < Vector::rows(); ++d)
+					v[d] = typename Vector::value_type(r.number());
+				
+				mesh.add_vertex(v);
+			} else if (r.keyword("f")) {
+				typename simplex_mesh<Vector, K>::index_type e;
+				
+				for (std::size_t i = 0; i <= K; ++i)
+					e[i] = r.index(mesh.vertex_count());
+				
+				if (!r.at_line_end())
+					throw std::runtime_error("Obj mesh face has more than " + std::to_string(K + 1) + " vertices.");
+				
+				mesh.add_element(e);
+			}
+		}
+		
+		return mesh;
+	}
+	
+	// integral of f(Vector) over every element of the mesh.  blocks of elements are summed on separate threads and
+	// the block sums added in order, so the result doesn't depend on the thread count.
+	template <typename Function, typename Mesh>
+	auto mesh_integral(Function f, Mesh const & mesh, std::size_t degree = 2, std::size_t threads = hardware_threads())
+		-> decltype(f(std::declval<typename Mesh::vector_type>()))
+	{
+		typedef decltype(f(std::declval<typename Mesh::vector_type>())) result_t;
+		
+		static_assert(check::vector_space<result_t, reals_t>::value,
+					  "Assertion failed, return type not a vector space over the reals.");
+		
+		auto const & rule = simplex_rule<Mesh::dimension>(degree);
+		
+		std::size_t const blocks = (mesh.size() + detail::mesh_block - 1) / detail::mesh_block;
+		
+		std::vector<result_t> partial(blocks, result_t{});
+		
+		parallel_for(blocks, [&](std::size_t block) {
+			std::size_t first = block * detail::mesh_block;
+			std::size_t last = std::min(mesh.size(), first + detail::mesh_block);
+			
+			result_t sum{};
+			
+			for (std::size_t e = first; e < last; ++e) {
+				auto element = mesh[e];
+				
+				result_t s{};
+				
+				for (auto const & node : rule)
+					s += f(element.point(node.barycentric)) * node.weight;
+				
+				sum += s * element.volume();
+			}
+			
+			partial[block] = sum;
+		}, threads);
+		
+		result_t sum{};
+		
+		for (auto const & s : partial)
+			sum += s;
+		
+		return sum;
+	}
+}
+
+#endif
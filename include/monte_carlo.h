@@ -0,0 +1,421 @@
+//
+//  monte_carlo.h
+//  math
+//
+//  Created by Patrick Sauter on 10/19/26.
+//  Copyright (c) 2026 Patrick Sauter. All rights reserved.
+//
+
+#ifndef math_monte_carlo_h
+#define math_monte_carlo_h
+
+// sampling integrators over a math::box, for dimensions where dividing the box into a grid is hopeless.
+//
+//	qmc_integral  - randomized quasi monte carlo.  R independently scrambled copies of a low discrepancy sequence
+//	                (sobol or halton) are integrated, and the spread of the R answers gives the error estimate.
+//	mc_integral   - plain monte carlo with a counter based generator.
+//
+// both are deterministic for a given seed, regardless of how many threads do the work, because every block of
+// samples gets its own random stream and the block results are always combined in block order.
+
+#include <cstdint>
+#include <cmath>
+#include <array>
+#include <vector>
+#include <limits>
+#include <stdexcept>
+
+#include "core.h"
+#include "box.h"
+#include "numeric_integral.h"
+#include "parallel.h"
+
+namespace math {
+	struct monte_carlo_options {
+		std::size_t		samples			= std::size_t(1) << 12;		// first pass, per replicate for qmc
+		std::size_t		max_samples		= std::size_t(1) << 24;		// total evaluations we are willing to spend
+		reals_t			target_error	= 0;						// keep doubling the sample count until the error is below this
+		std::uint64_t	seed			= 0;
+		std::size_t		replicates		= 16;						// independent scramblings, qmc only
+		std::size_t		threads			= hardware_threads();
+	};
+	
+	namespace detail {
+		// splitmix64 finalizer, the mixing function behind our counter based generator.
+		inline std::uint64_t mix64(std::uint64_t z) {
+			z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+			z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+			
+			return z ^ (z >> 31);
+		}
+		
+		inline std::uint32_t reverse_bits(std::uint32_t x) {
+			x = ((x >> 1) & 0x55555555u) | ((x & 0x55555555u) << 1);
+			x = ((x >> 2) & 0x33333333u) | ((x & 0x33333333u) << 2);
+			x = ((x >> 4) & 0x0f0f0f0fu) | ((x & 0x0f0f0f0fu) << 4);
+			x = ((x >> 8) & 0x00ff00ffu) | ((x & 0x00ff00ffu) << 8);
+			
+			return (x >> 16) | (x << 16);
+		}
+		
+		// hash based nested uniform (owen) scramble of a 32 bit binary fraction, from Burley's
+		// "practical hash-based owen scrambling".  the laine-karras permutation only lets higher bits depend on
+		// lower ones, so reversing the bits first gives each digit a permutation depending on all the digits above it.
+		inline std::uint32_t owen_scramble(std::uint32_t x, std::uint32_t seed) {
+			x = reverse_bits(x);
+			
+			x += seed;
+			x ^= x * 0x6c50b47cu;
+			x ^= x * 0xb82f1e52u;
+			x ^= x * 0xc7afe638u;
+			x ^= x * 0x8d22f6e6u;
+			
+			return reverse_bits(x);
+		}
+	}
+	
+	// stateless random number generator.  the i-th number of stream s is a pure function of (seed, s, i), so any
+	// thread can produce any part of any stream without coordination.
+	class counter_rng {
+	public:
+		explicit counter_rng(std::uint64_t seed = 0, std::uint64_t stream = 0)
+			: _key(detail::mix64(seed ^ detail::mix64(stream + 0x9e3779b97f4a7c15ULL))) { }
+		
+		std::uint64_t bits(std::uint64_t counter) const {
+			return detail::mix64(_key + counter * 0x9e3779b97f4a7c15ULL);
+		}
+		
+		// uniform on [0, 1), 53 random bits.
+		reals_t operator()(std::uint64_t counter) const {
+			return reals_t(bits(counter) >> 11) * (reals_t(1) / reals_t(std::uint64_t(1) << 53));
+		}
+	private:
+		std::uint64_t	_key;
+	};
+	
+	
+	
+	
+	// sobol points with Joe and Kuo's direction numbers, owen scrambled per dimension.
+	// point(i) is computed directly from i, so the sequence can be split between threads at any index.
+	// the direction numbers have 32 bits, so there are max_points = 2^32 points and i past that throws.
+	class sobol_sequence {
+	public:
+		static constexpr std::size_t max_dimension = 21;
+		static constexpr std::uint64_t max_points = std::uint64_t(1) << 32;
+		
+		sobol_sequence(std::size_t dimension, std::uint64_t seed) : _dimension(dimension), _seeds(dimension) {
+			if (dimension > max_dimension)
+				throw std::invalid_argument("sobol_sequence dimension too large.");
+			
+			// primitive polynomial degree s, its interior coefficients a, and the initial direction numbers m.
+			static constexpr struct { unsigned s, a, m[7]; } table[max_dimension - 1] = {
+				{ 1,  0, { 1 } },
+				{ 2,  1, { 1, 3 } },
+				{ 3,  1, { 1, 3, 1 } },
+				{ 3,  2, { 1, 1, 1 } },
+				{ 4,  1, { 1, 1, 3, 3 } },
+				{ 4,  4, { 1, 3, 5, 13 } },
+				{ 5,  2, { 1, 1, 5, 5, 17 } },
+				{ 5,  4, { 1, 1, 5, 5, 5 } },
+				{ 5,  7, { 1, 1, 7, 11, 19 } },
+				{ 5, 11, { 1, 1, 5, 1, 1 } },
+				{ 5, 13, { 1, 1, 1, 3, 11 } },
+				{ 5, 14, { 1, 3, 5, 5, 31 } },
+				{ 6,  1, { 1, 3, 3, 9, 7, 49 } },
+				{ 6, 13, { 1, 1, 1, 15, 21, 21 } },
+				{ 6, 16, { 1, 3, 1, 13, 27, 49 } },
+				{ 6, 19, { 1, 1, 1, 15, 7, 5 } },
+				{ 6, 22, { 1, 3, 1, 15, 13, 25 } },
+				{ 6, 25, { 1, 1, 5, 5, 19, 61 } },
+				{ 7,  1, { 1, 3, 7, 11, 23, 15, 103 } },
+				{ 7,  4, { 1, 3, 7, 13, 13, 15, 69 } }
+			};
+			
+			for (std::size_t d = 0; d < dimension; ++d) {
+				auto & v = _direction[d];
+				
+				if (d == 0) {
+					for (unsigned k = 0; k < 32; ++k)
+						v[k] = std::uint32_t(1) << (31 - k);
+				} else {
+					auto const & p = table[d - 1];
+					
+					for (unsigned k = 0; k < p.s; ++k)
+						v[k] = p.m[k] << (31 - k);
+					
+					for (unsigned k = p.s; k < 32; ++k) {
+						v[k] = v[k - p.s] ^ (v[k - p.s] >> p.s);
+						
+						for (unsigned j = 1; j < p.s; ++j) {
+							if ((p.a >> (p.s - 1 - j)) & 1)
+								v[k] ^= v[k - j];
+						}
+					}
+				}
+				
+				_seeds[d] = std::uint32_t(detail::mix64(seed ^ detail::mix64(d + 1)));
+			}
+		}
+		
+		std::size_t dimension() const { return _dimension; }
+		
+		// the d-th coordinate of the i-th point, in [0, 1)
+		reals_t operator()(std::uint64_t i, std::size_t d) const {
+			if (i >= max_points)
+				throw std::invalid_argument("sobol_sequence index past its 2^32 points.");
+			
+			std::uint32_t x = 0;
+			
+			for (unsigned k = 0; i; ++k, i >>= 1) {
+				if (i & 1)
+					x ^= _direction[d][k];
+			}
+			
+			// put the sample in the middle of its 2^-32 cell so that no coordinate is ever exactly 0.
+			return (reals_t(detail::owen_scramble(x, _seeds[d])) + reals_t(0.5)) / reals_t(4294967296.0);
+		}
+	private:
+		std::size_t									_dimension;
+		std::array<std::array<std::uint32_t, 32>, max_dimension>	_direction;
+		std::vector<std::uint32_t>					_seeds;
+	};
+	
+	
+	
+	
+	// halton points with a random digit permutation per dimension.
+	class halton_sequence {
+	public:
+		static constexpr std::size_t max_dimension = 32;
+		// the digits fill a double, past this points start repeating
+		static constexpr std::uint64_t max_points = std::uint64_t(1) << std::numeric_limits<reals_t>::digits;
+		
+		halton_sequence(std::size_t dimension, std::uint64_t seed) : _dimension(dimension), _permutation(dimension) {
+			static constexpr unsigned primes[max_dimension] = {
+				  2,   3,   5,   7,  11,  13,  17,  19,  23,  29,  31,  37,  41,  43,  47,  53,
+				 59,  61,  67,  71,  73,  79,  83,  89,  97, 101, 103, 107, 109, 113, 127, 131
+			};
+			
+			if (dimension > max_dimension)
+				throw std::invalid_argument("halton_sequence dimension too large.");
+			
+			counter_rng rng(seed, 0x68616c746f6eULL);
+			std::uint64_t counter = 0;
+			
+			for (std::size_t d = 0; d < dimension; ++d) {
+				auto & p = _permutation[d];
+				
+				_base[d] = primes[d];
+				
+				p.resize(primes[d]);
+				
+				for (unsigned k = 0; k < primes[d]; ++k)
+					p[k] = k;
+				
+				// fisher-yates
+				for (unsigned k = primes[d] - 1; k > 0; --k)
+					std::swap(p[k], p[std::size_t(rng(counter++) * (k + 1))]);
+				
+				// enough digits to fill a double
+				_digits[d] = unsigned(std::ceil(std::numeric_limits<reals_t>::digits / std::log2(reals_t(primes[d]))));
+			}
+		}
+		
+		std::size_t dimension() const { return _dimension; }
+		
+		reals_t operator()(std::uint64_t i, std::size_t d) const {
+			auto const & p = _permutation[d];
+			
+			reals_t inverse = reals_t(1) / _base[d];
+			reals_t scale = inverse;
+			reals_t x = 0;
+			
+			// the permutation may move digit 0, so keep going past the last nonzero digit of i.
+			for (unsigned k = 0; k < _digits[d]; ++k, scale *= inverse) {
+				x += p[i % _base[d]] * scale;
+				i /= _base[d];
+			}
+			
+			return std::min(x, reals_t(1) - std::numeric_limits<reals_t>::epsilon());
+		}
+	private:
+		std::size_t							_dimension;
+		std::array<unsigned, max_dimension>	_base;
+		std::array<unsigned, max_dimension>	_digits;
+		std::vector<std::vector<unsigned>>	_permutation;
+	};
+	
+	
+	
+	
+	namespace detail {
+		// samples handled by one task.  fixed, and not derived from the thread count, so results are reproducible.
+		constexpr std::size_t monte_carlo_block = 1024;
+		
+		// running mean and sum of squared deviations, combinable with Chan's parallel formula.
+		template <typename T>
+		struct moments {
+			std::size_t		n = 0;
+			T				mean{};
+			reals_t			m2 = 0;
+			
+			void add(T const & x) {
+				++n;
+				
+				T delta = x - mean;
+				mean += delta / reals_t(n);
+				m2 += magnitude2(delta) * reals_t(n - 1) / reals_t(n);
+			}
+			
+			void add(moments const & b) {
+				if (b.n == 0)
+					return;
+				
+				auto total = n + b.n;
+				T delta = b.mean - mean;
+				
+				mean += delta * (reals_t(b.n) / reals_t(total));
+				m2 += b.m2 + magnitude2(delta) * (reals_t(n) * reals_t(b.n) / reals_t(total));
+				n = total;
+			}
+		};
+	}
+	
+	
+	// randomized quasi monte carlo integral of f over region.
+	// Sequence is sobol_sequence or halton_sequence, f takes the box's vector type.  the sample count stops doubling at
+	// Sequence::max_points per replicate, and options.samples above it throws std::invalid_argument.
+	template <typename Sequence = sobol_sequence, typename Function, typename Vector>
+	auto qmc_integral(Function f, box<Vector> const & region, monte_carlo_options const & options = {})
+		-> integral_estimate<decltype(f(std::declval<Vector>()))>
+	{
+		typedef decltype(f(std::declval<Vector>())) result_t;
+		
+		static_assert(check::vector_space<result_t, reals_t>::value,
+					  "Assertion failed, return type not a vector space over the reals.");
+		
+		std::size_t const R = std::max<std::size_t>(2, options.replicates);
+		
+		if (std::uint64_t(options.samples) > Sequence::max_points)
+			throw std::invalid_argument("qmc_integral samples beyond the sequence's points.");
+		
+		std::vector<Sequence> sequences;
+		
+		for (std::size_t r = 0; r < R; ++r)
+			sequences.emplace_back(Vector::rows(), detail::mix64(options.seed) + r);
+		
+		std::vector<result_t>	sums(R, result_t{});
+		std::size_t				done = 0;		// points per replicate so far
+		std::size_t				n = std::max<std::size_t>(1, options.samples);
+		
+		auto const volume = detail::volume(region);
+		
+		integral_estimate<result_t> result{ result_t{}, 0, 0 };
+		
+		while (true) {
+			// evaluate points [done, n) of every replicate
+			std::size_t const blocks = (n - done + detail::monte_carlo_block - 1) / detail::monte_carlo_block;
+			
+			std::vector<result_t> partial(R * blocks, result_t{});
+			
+			parallel_for(R * blocks, [&](std::size_t task) {
+				auto const & s = sequences[task / blocks];
+				
+				std::size_t first = done + (task % blocks) * detail::monte_carlo_block;
+				std::size_t last = std::min(n, first + detail::monte_carlo_block);
+				
+				result_t sum{};
+				
+				for (std::size_t i = first; i < last; ++i)
+					sum += f(detail::unit_to_box(region, [&](std::size_t d) { return s(i, d); }));
+				
+				partial[task] = sum;
+			}, options.threads);
+			
+			for (std::size_t task = 0; task < R * blocks; ++task)
+				sums[task / blocks] += partial[task];
+			
+			done = n;
+			
+			// the replicate means are independent, so their spread is an honest error estimate.
+			detail::moments<result_t> m;
+			
+			for (auto const & s : sums)
+				m.add(s / reals_t(done));
+			
+			result.value		= m.mean * volume;
+			result.error		= std::sqrt(m.m2 / reals_t(R * (R - 1))) * std::abs(volume);
+			result.evaluations	= done * R;
+			
+			if (result.error <= options.target_error || 2 * n * R > options.max_samples ||
+				2 * std::uint64_t(n) > Sequence::max_points)
+				break;
+			
+			n *= 2;
+		}
+		
+		return result;
+	}
+	
+	
+	// plain monte carlo integral of f over region.
+	// block b of the samples uses stream b of a counter_rng, so the sample set only depends on the seed.
+	template <typename Function, typename Vector>
+	auto mc_integral(Function f, box<Vector> const & region, monte_carlo_options const & options = {})
+		-> integral_estimate<decltype(f(std::declval<Vector>()))>
+	{
+		typedef decltype(f(std::declval<Vector>())) result_t;
+		
+		static_assert(check::vector_space<result_t, reals_t>::value,
+					  "Assertion failed, return type not a vector space over the reals.");
+		
+		constexpr std::size_t dimension = Vector::rows();
+		
+		auto const volume = detail::volume(region);
+		
+		detail::moments<result_t>	total;
+		std::size_t					done = 0;
+		std::size_t					n = std::max<std::size_t>(2, options.samples);
+		
+		integral_estimate<result_t> result{ result_t{}, 0, 0 };
+		
+		while (true) {
+			std::size_t const first_block = done / detail::monte_carlo_block;
+			std::size_t const last_block = (n + detail::monte_carlo_block - 1) / detail::monte_carlo_block;
+			
+			std::vector<detail::moments<result_t>> partial(last_block - first_block);
+			
+			parallel_for(partial.size(), [&](std::size_t task) {
+				std::size_t block = first_block + task;
+				counter_rng rng(options.seed, block);
+				
+				auto & m = partial[task];
+				
+				for (std::size_t i = 0; i < detail::monte_carlo_block; ++i) {
+					m.add(f(detail::unit_to_box(region, [&](std::size_t d) {
+						return rng(i * dimension + d);
+					})));
+				}
+			}, options.threads);
+			
+			for (auto const & m : partial)
+				total.add(m);
+			
+			done = total.n;
+			
+			result.value		= total.mean * volume;
+			result.error		= std::sqrt(total.m2 / reals_t(done - 1) / reals_t(done)) * std::abs(volume);
+			result.evaluations	= done;
+			
+			if (result.error <= options.target_error || 2 * done > options.max_samples)
+				break;
+			
+			n = 2 * done;
+		}
+		
+		return result;
+	}
+}
+
+#endif
@@ -127,6 +127,24 @@ namespace math {
 				typedef F type;
 			};
 			
+			// both zero or one, more specialized than any two of the above
+			template <std::intmax_t D1, std::intmax_t D2, std::intmax_t D3, std::intmax_t D4>
+			struct __multiply<complex<0,D1,0,D2>, complex<0,D3,0,D4>, mp_complex> {
+				typedef rational<0> type;
+			};
+			template <std::intmax_t D1, std::intmax_t D2, std::intmax_t D3, std::intmax_t D4>
+			struct __multiply<complex<0,D1,0,D2>, complex<D3,D3,0,D4>, mp_complex> {
+				typedef rational<0> type;
+			};
+			template <std::intmax_t D1, std::intmax_t D2, std::intmax_t D3, std::intmax_t D4>
+			struct __multiply<complex<D1,D1,0,D2>, complex<0,D3,0,D4>, mp_complex> {
+				typedef rational<0> type;
+			};
+			template <std::intmax_t D1, std::intmax_t D2, std::intmax_t D3, std::intmax_t D4>
+			struct __multiply<complex<D1,D1,0,D2>, complex<D3,D3,0,D4>, mp_complex> {
+				typedef rational<1> type;
+			};
+			
 			// REPAIR MULTIPLY CHAIN STRUCTURE
 			template <typename F, typename G, typename H>
 			struct __multiply<___multiply<F, G>, H, mp_repair> {
@@ -235,6 +253,16 @@ namespace math {
 			template <typename T1, typename T2>
 			struct __multiply<T1, T2, mp_sort> :  __multiply_sorter<T1, T2, multiply_sort<T1,T2>()> { };
 			
+			// sin is odd and cos is even, a negative constant in front of the argument comes out
+			template <std::intmax_t N, std::intmax_t D, std::intmax_t iD, typename X>
+			struct _sin<___multiply<complex<N,D,0,iD>, X>, typename std::enable_if<(N < 0)>::type> {
+				typedef multiply<rational<-1>, sin<multiply<rational<-N,D>, X>>> type;
+			};
+			template <std::intmax_t N, std::intmax_t D, std::intmax_t iD, typename X>
+			struct _cos<___multiply<complex<N,D,0,iD>, X>, typename std::enable_if<(N < 0)>::type> {
+				typedef cos<multiply<rational<-N,D>, X>> type;
+			};
+			
 			template <typename F, typename G>
 			std::ostream & operator << (std::ostream & o, ___multiply<F,G> const & m) {
 				return o << m.get1() << "*" << m.get2();
@@ -10,7 +10,10 @@
 #define math_integral_h
 
 #include <type_traits>
+#include <complex>
 #include <cmath>
+#include <tuple>
+#include <utility>
 
 #include "core.h"
 #include "box.h"
@@ -25,6 +28,8 @@ namespace math {
 		// can't really generalize this to just use the determinant of a jacobian
 		// since we aren't actually dealing with differential volumes.
 		
+		// product_measure.h has versions of these that tabulate their factors once per box_divider.
+		
 		// coordinate vector is (r, theta, phi) where theta is polar and phi is azimuthal
 		// the box is a box in (r, theta, phi) coordinate space.
 		
@@ -47,6 +52,57 @@ namespace math {
 		}
 	}
 	
+	// result of the integrators that can say how far off they might be.
+	// error is a one sigma estimate for the sampling integrators, and the size of the last correction
+	// for the deterministic ones.
+	template <typename T>
+	struct integral_estimate {
+		T				value;
+		reals_t			error;
+		std::size_t		evaluations;
+	};
+	
+	namespace detail {
+		// squared magnitude of an integrand value, used when estimating errors of vector space valued integrals.
+		template <typename T, typename = typename std::enable_if<std::is_arithmetic<T>::value>::type>
+		reals_t magnitude2(T const & t) { return reals_t(t) * reals_t(t); }
+		
+		template <typename T>
+		reals_t magnitude2(std::complex<T> const & t) { return std::norm(t); }
+		
+		template <typename T, std::size_t N, std::size_t M>
+		reals_t magnitude2(matrix<T,N,M> const & t) {
+			reals_t sum = 0;
+			
+			for (auto const & i : t)
+				sum += magnitude2(i);
+			
+			return sum;
+		}
+		
+		template <typename Vector>
+		reals_t volume(box<Vector> const & region) {
+			reals_t v = 1;
+			
+			for (auto i : region.diagonal())
+				v *= i;
+			
+			return v;
+		}
+		
+		// maps a point of the unit cube, given coordinate by coordinate as u(i), into the box.
+		template <typename Vector, typename Coordinate>
+		Vector unit_to_box(box<Vector> const & region, Coordinate u) {
+			Vector p = region.a();
+			auto d = region.diagonal();
+			
+			for (std::size_t i = 0; i < Vector::rows(); ++i)
+				p[i] += u(i) * d[i];
+			
+			return p;
+		}
+	}
+	
 	template <typename Function, typename Measure, typename Container>
 	auto numeric_integral(Function f, Measure mu, Container set_container) -> decltype(f(*set_container.begin())) {
 		static_assert(check::vector_space<decltype(f(*set_container.begin())), reals_t>::value,
@@ -60,5 +116,70 @@ namespace math {
 		
 		return sum;
 	}
+	
+	namespace detail {
+		template <typename Container>
+		using cell_point_t = typename std::decay<decltype(*std::declval<Container>().begin())>::type::vector_type;
+		
+		template <typename ... T>
+		struct all_vector_spaces : std::true_type { };
+		
+		template <typename T, typename ... Rest>
+		struct all_vector_spaces<T, Rest...> : std::integral_constant<bool,
+			check::vector_space<T, reals_t>::value && all_vector_spaces<Rest...>::value
+		> { };
+		
+		template <typename Sums, typename Functions, typename Shared, std::size_t ... I>
+		void accumulate_each(Sums & sums, Functions const & fs, Shared const & s, reals_t w, std::index_sequence<I...>) {
+			int expand[] = { 0, (std::get<I>(sums) += std::get<I>(fs)(s) * w, 0) ... };
+			(void)expand;
+		}
+		
+		struct pass_point {
+			template <typename Vector>
+			Vector const & operator()(Vector const & x) const { return x; }
+		};
+	}
+	
+	// several integrals over the same cells in one pass, like all the moments of f at once,
+	//
+	//		numeric_integrals([](V x) { return std::make_pair(x[0], f(x)); },
+	//						  std::make_tuple([](auto s) { return s.second; }, [](auto s) { return s.first * s.second; }),
+	//						  measure::cartesian<reals_t,1>, region / steps);
+	//
+	// shared is called once per cell with the cell's center, each function is then called with what it returned, so
+	// work common to all of them (f above) is done once.  the measure and the center are also worked out once per
+	// cell.  gives a tuple with one integral per function.
+	// a single functor returning a math::vector does the same job with numeric_integral, when the results all have
+	// the same type.
+	template <typename Shared, typename ... Functions, typename Measure, typename Container>
+	auto numeric_integrals(Shared shared, std::tuple<Functions...> const & fs, Measure mu, Container set_container)
+		-> std::tuple<typename std::decay<decltype(std::declval<Functions const &>()(shared(std::declval<detail::cell_point_t<Container>>())))>::type ...>
+	{
+		typedef std::tuple<typename std::decay<decltype(std::declval<Functions const &>()(shared(std::declval<detail::cell_point_t<Container>>())))>::type ...> result_t;
+		
+		static_assert(detail::all_vector_spaces<typename std::decay<decltype(std::declval<Functions const &>()(shared(std::declval<detail::cell_point_t<Container>>())))>::type ...>::value,
+					  "Assertion failed, return type not a vector space over the reals.");
+		
+		result_t sums{};
+		
+		for (auto i : set_container) {
+			detail::cell_point_t<Container> x(i);
+			
+			auto const & s = shared(x);
+			
+			detail::accumulate_each(sums, fs, s, mu(i), std::index_sequence_for<Functions...>{});
+		}
+		
+		return sums;
+	}
+	
+	// the same with every function called with the cell's center
+	template <typename ... Functions, typename Measure, typename Container>
+	auto numeric_integrals(std::tuple<Functions...> const & fs, Measure mu, Container set_container)
+		-> decltype(numeric_integrals(detail::pass_point{}, fs, mu, set_container))
+	{
+		return numeric_integrals(detail::pass_point{}, fs, mu, set_container);
+	}
 }
 #endif
@@ -0,0 +1,223 @@
+//
+//  oscillatory_integral.h
+//  math
+//
+//  Created by Patrick Sauter on 10/19/26.
+//  Copyright (c) 2026 Patrick Sauter. All rights reserved.
+//
+
+#ifndef math_oscillatory_integral_h
+#define math_oscillatory_integral_h
+
+// integrals of analytic functors with a sin or cos factor of high frequency,
+//
+//		oscillatory_integral(multiply<g, sin<multiply<rational<1000>, x>>>(), region, steps)
+//
+// the midpoint rule needs several points per period, so its cost grows with the frequency.  here the type is
+// searched for a factor sin(U) or cos(U) with U = w x_A + phase, w a real constant.  along axis A the integral
+// is done with filon's rule: the rest of the product is interpolated by parabolas over pairs of panels, and the
+// interpolant times the oscillating factor is integrated exactly.  steps only has to resolve g, not the
+// oscillation, and the result gets more accurate as w grows.  the other axes use the midpoint rule.
+//
+// sums are split term by term, and anything without such a factor goes to separable_integral.
+
+#include <cmath>
+#include <cstdint>
+#include <tuple>
+#include <type_traits>
+
+#include "analytic.h"
+#include "antiderivative.h"
+#include "separable_integral.h"
+#include "box.h"
+
+namespace math {
+	namespace detail {
+		// filon's weights for theta = w h, with the series near zero where the closed forms cancel badly.
+		struct filon_weights {
+			explicit filon_weights(reals_t theta) {
+				if (std::abs(theta) < reals_t(1) / 6) {
+					reals_t t2 = theta * theta, t3 = t2 * theta, t4 = t2 * t2, t5 = t4 * theta, t6 = t4 * t2, t7 = t6 * theta;
+					
+					alpha	= 2 * t3 / 45 - 2 * t5 / 315 + 2 * t7 / 4725;
+					beta	= reals_t(2) / 3 + 2 * t2 / 15 - 4 * t4 / 105 + 2 * t6 / 567;
+					gamma	= reals_t(4) / 3 - 2 * t2 / 15 + t4 / 210 - t6 / 11340;
+				} else {
+					reals_t s = std::sin(theta), c = std::cos(theta);
+					reals_t t2 = theta * theta, t3 = t2 * theta;
+					
+					alpha	= 1 / theta + 2 * s * c / (2 * t2) - 2 * s * s / t3;
+					beta	= 2 * ((1 + c * c) / t2 - 2 * s * c / t3);
+					gamma	= 4 * (s / t3 - c / t2);
+				}
+			}
+			
+			reals_t alpha, beta, gamma;
+		};
+		
+		// integral of g(x) sin(w x + phase) (or cos) over [a, b] with filon's rule on 2n panels.
+		template <typename G>
+		auto filon(G g, reals_t w, reals_t phase, reals_t a, reals_t b, std::size_t n, bool sine) -> decltype(g(a)) {
+			typedef decltype(g(a)) result_t;
+			
+			std::size_t const panels = 2 * (n > 0 ? n : 1);
+			reals_t const h = (b - a) / panels;
+			
+			filon_weights k(w * h);
+			
+			result_t even{}, odd{};
+			
+			// the factor the rule is built around, and the other one for the end point terms
+			auto trig = [&](reals_t x) { return sine ? std::sin(w * x + phase) : std::cos(w * x + phase); };
+			auto other = [&](reals_t x) { return sine ? -std::cos(w * x + phase) : std::sin(w * x + phase); };
+			
+			result_t ga = g(a), gb = g(b);
+			
+			for (std::size_t i = 0; i <= panels; ++i) {
+				reals_t x = (i == panels ? b : a + h * i);
+				result_t v = (i == 0 ? ga : (i == panels ? gb : g(x)));
+				
+				if (i % 2)
+					odd += v * trig(x);
+				else
+					even += v * trig(x);
+			}
+			
+			even -= (ga * trig(a) + gb * trig(b)) / 2;
+			
+			return (k.alpha * (gb * other(b) - ga * other(a)) + k.beta * even + k.gamma * odd) * h;
+		}
+		
+		// factor T oscillates along axis A if it is sin or cos of a linear function of x_A with a real slope
+		template <typename T, std::size_t A, typename = void>
+		struct _oscillation : std::false_type { };
+		
+		template <typename U, std::size_t A>
+		struct _real_slope : std::integral_constant<bool,
+			analytic::detail::_linear<U, pat::select<A>>::value &&
+			std::ratio_equal<typename analytic::detail::_linear<U, pat::select<A>>::slope::imag, std::ratio<0>>::value
+		> { };
+		
+		template <typename U, std::size_t A>
+		struct _oscillation<analytic::detail::__sin<U>, A, typename std::enable_if<_real_slope<U, A>::value>::type> : std::true_type {
+			typedef U argument;
+			static constexpr bool sine = true;
+		};
+		template <typename U, std::size_t A>
+		struct _oscillation<analytic::detail::__cos<U>, A, typename std::enable_if<_real_slope<U, A>::value>::type> : std::true_type {
+			typedef U argument;
+			static constexpr bool sine = false;
+		};
+		
+		template <typename Factors, std::size_t I, std::size_t A, bool = (I < std::tuple_size<Factors>::value)>
+		struct _oscillation_at : std::false_type { };
+		
+		template <typename Factors, std::size_t I, std::size_t A>
+		struct _oscillation_at<Factors, I, A, true> : _oscillation<typename std::tuple_element<I, Factors>::type, A> { };
+		
+		// the first factor and axis that oscillate, factors outer and axes inner
+		template <typename Factors, std::size_t N, std::size_t I = 0, std::size_t A = 0, typename = void>
+		struct _find_oscillation : _find_oscillation<Factors, N, (A + 1 < N ? I : I + 1), (A + 1 < N ? A + 1 : 0)> { };
+		
+		template <typename Factors, std::size_t N, std::size_t I, std::size_t A>
+		struct _find_oscillation<Factors, N, I, A, typename std::enable_if<_oscillation_at<Factors, I, A>::value>::type> : std::true_type {
+			static constexpr std::size_t factor = I;
+			static constexpr std::size_t axis = A;
+		};
+		
+		template <typename Factors, std::size_t N, std::size_t I, std::size_t A>
+		struct _find_oscillation<Factors, N, I, A, typename std::enable_if<(I >= std::tuple_size<Factors>::value)>::type> : std::false_type { };
+		
+		template <typename F, typename Vector>
+		using find_oscillation = _find_oscillation<typename _factors<F>::type, Vector::rows()>;
+		
+		template <typename F, typename Vector, typename Steps>
+		auto filon_integral(box<Vector> const & region, Steps const & steps, std::true_type)
+			-> decltype(call_with(F{}, std::declval<Vector>()))
+		{
+			typedef decltype(call_with(F{}, std::declval<Vector>())) result_t;
+			typedef typename _factors<F>::type						factors_t;
+			typedef find_oscillation<F, Vector>						found_t;
+			typedef typename std::tuple_element<found_t::factor, factors_t>::type	trig_t;
+			typedef _oscillation<trig_t, found_t::axis>				oscillation_t;
+			typedef typename oscillation_t::argument				argument_t;
+			
+			constexpr std::size_t A = found_t::axis;
+			constexpr std::uint64_t all = (std::uint64_t(1) << std::tuple_size<factors_t>::value) - 1;
+			
+			typedef partial_product<all & ~(std::uint64_t(1) << found_t::factor), factors_t> g_t;
+			
+			reals_t const w = typename analytic::detail::_linear<argument_t, pat::select<A>>::slope()();
+			
+			// midpoint cells over the other axes, axis A collapsed to a single unit cell
+			Vector a = region.a(), b = region.b();
+			Steps s = steps;
+			
+			a[A] = 0;
+			b[A] = 1;
+			s[A] = 1;
+			
+			result_t sum{};
+			
+			for (auto cell : box<Vector>(a, b) / s) {
+				Vector p = cell;
+				
+				// the phase is the argument with x_A = 0
+				p[A] = 0;
+				
+				reals_t phase = call_with(argument_t{}, p);
+				
+				result_t line = filon([&](reals_t x) {
+					Vector q = p;
+					q[A] = x;
+					
+					return call_with(g_t{}, q);
+				}, w, phase, region.a()[A], region.b()[A], (steps[A] + 1) / 2, oscillation_t::sine);
+				
+				sum += line * volume(cell, ~(std::uint64_t(1) << A));
+			}
+			
+			return sum;
+		}
+		
+		template <typename F, typename Vector, typename Steps>
+		auto filon_integral(box<Vector> const & region, Steps const & steps, std::false_type)
+			-> decltype(call_with(F{}, std::declval<Vector>()))
+		{
+			return separable_integral(F{}, region, steps);
+		}
+		
+		template <typename F>
+		struct _oscillatory {
+			template <typename Vector, typename Steps>
+			static auto integrate(box<Vector> const & region, Steps const & steps) -> decltype(call_with(F{}, std::declval<Vector>())) {
+				typedef std::integral_constant<bool, find_oscillation<F, Vector>::value> found_t;
+				
+				return filon_integral<F>(region, steps, found_t{});
+			}
+		};
+		
+		// term by term, each one might oscillate along a different axis
+		template <typename F, typename G>
+		struct _oscillatory<analytic::detail::___add<F,G>> {
+			template <typename Vector, typename Steps>
+			static auto integrate(box<Vector> const & region, Steps const & steps)
+				-> decltype(call_with(analytic::detail::___add<F,G>{}, std::declval<Vector>()))
+			{
+				return _oscillatory<F>::integrate(region, steps) + _oscillatory<G>::integrate(region, steps);
+			}
+		};
+	}
+	
+	// integral of the analytic functor F over region, with filon's rule along the axis of a sin or cos factor if it
+	// has one.  steps per axis, along the oscillating axis it is the number of panels and only needs to resolve
+	// the rest of the product.
+	template <typename F, typename Vector>
+	auto oscillatory_integral(F, box<Vector> const & region, typename Vector::template convert_type<std::size_t> const & steps)
+		-> decltype(detail::call_with(F{}, std::declval<Vector>()))
+	{
+		return detail::_oscillatory<F>::integrate(region, steps);
+	}
+}
+
+#endif
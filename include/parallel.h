@@ -0,0 +1,277 @@
+//
+//  parallel.h
+//  math
+//
+//  Created by Patrick Sauter on 10/19/26.
+//  Copyright (c) 2026 Patrick Sauter. All rights reserved.
+//
+
+#ifndef math_parallel_h
+#define math_parallel_h
+
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <exception>
+#include <algorithm>
+
+namespace math {
+	// number of threads the parallel algorithms use when the caller doesn't ask for a specific count.
+	// asking the system takes microseconds, so it's only done once.
+	inline std::size_t hardware_threads() {
+		static std::size_t const threads = []() {
+			auto n = std::thread::hardware_concurrency();
+			
+			return std::size_t(n > 0 ? n : 1);
+		}();
+		
+		return threads;
+	}
+	
+	// calls f(i) for every i in [0, count), spread over at most "threads" threads.
+	// the indices are handed out dynamically, so f should write its result to slot i of some
+	// output rather than accumulating into shared state.  reducing those slots in index order afterwards
+	// gives the same answer no matter how many threads actually ran, which is what keeps the
+	// integrators reproducible.
+	// the first exception thrown by f is rethrown on the calling thread once every worker has stopped.
+	template <typename Function>
+	void parallel_for(std::size_t count, Function f, std::size_t threads = hardware_threads()) {
+		threads = std::max<std::size_t>(1, std::min(threads, count));
+		
+		if (threads == 1) {
+			for (std::size_t i = 0; i < count; ++i)
+				f(i);
+			
+			return;
+		}
+		
+		std::atomic<std::size_t>	next{0};
+		std::atomic<bool>			failed{false};
+		std::exception_ptr			error;
+		
+		auto work = [&]() {
+			try {
+				for (std::size_t i; !failed && (i = next++) < count; )
+					f(i);
+			} catch (...) {
+				if (!failed.exchange(true))
+					error = std::current_exception();
+			}
+		};
+		
+		std::vector<std::thread> pool;
+		
+		for (std::size_t t = 1; t < threads; ++t)
+			pool.emplace_back(work);
+		
+		work();
+		
+		for (auto & t : pool)
+			t.join();
+		
+		if (error)
+			std::rethrow_exception(error);
+	}
+	
+	// parallel_for for work where neighbouring indices belong together.  thread t starts on its own share of
+	// [0, count), the t-th of "threads" contiguous pieces as given by share_begin, and only when that runs out does it
+	// steal the back half of what another thread has left.  so each thread mostly works through one range in order,
+	// which keeps its caches warm, and memory first written under the same split (for_entries does that when
+	// dmatrix storage is allocated) sits on the NUMA node of the thread that later uses it.
+	// exceptions as in parallel_for.
+	inline std::size_t share_begin(std::size_t t, std::size_t count, std::size_t threads) {
+		return t * count / threads;
+	}
+	
+	template <typename Function>
+	void stealing_for(std::size_t count, Function f, std::size_t threads = hardware_threads()) {
+		threads = std::max<std::size_t>(1, std::min(threads, count));
+		
+		if (threads == 1) {
+			for (std::size_t i = 0; i < count; ++i)
+				f(i);
+			
+			return;
+		}
+		
+		// what each thread has left, on separate cache lines
+		struct alignas(64) share {
+			std::mutex		mutex;
+			std::size_t		begin, end;
+		};
+		
+		std::vector<share>		shares(threads);
+		std::atomic<bool>		failed{false};
+		std::exception_ptr		error;
+		
+		for (std::size_t t = 0; t < threads; ++t) {
+			shares[t].begin = share_begin(t, count, threads);
+			shares[t].end = share_begin(t + 1, count, threads);
+		}
+		
+		auto next = [&](std::size_t t, std::size_t & i) {
+			{
+				std::lock_guard<std::mutex> lock(shares[t].mutex);
+				
+				if (shares[t].begin < shares[t].end) {
+					i = shares[t].begin++;
+					return true;
+				}
+			}
+			
+			for (std::size_t v = (t + 1) % threads; v != t; v = (v + 1) % threads) {
+				std::size_t begin, end;
+				
+				{
+					std::lock_guard<std::mutex> lock(shares[v].mutex);
+					
+					if (shares[v].begin >= shares[v].end)
+						continue;
+					
+					end = shares[v].end;
+					begin = shares[v].end = end - (end - shares[v].begin + 1) / 2;
+				}
+				
+				// the first stolen index now, the rest become this thread's share
+				std::lock_guard<std::mutex> lock(shares[t].mutex);
+				
+				shares[t].begin = begin + 1;
+				shares[t].end = end;
+				i = begin;
+				
+				return true;
+			}
+			
+			return false;
+		};
+		
+		auto work = [&](std::size_t t) {
+			try {
+				for (std::size_t i; !failed && next(t, i); )
+					f(i);
+			} catch (...) {
+				if (!failed.exchange(true))
+					error = std::current_exception();
+			}
+		};
+		
+		std::vector<std::thread> pool;
+		
+		for (std::size_t t = 1; t < threads; ++t)
+			pool.emplace_back(work, t);
+		
+		work(0);
+		
+		for (auto & t : pool)
+			t.join();
+		
+		if (error)
+			std::rethrow_exception(error);
+	}
+	
+	namespace detail {
+		// elementwise loops over fewer entries than this aren't worth starting threads for
+		constexpr std::size_t parallel_entries = std::size_t(1) << 18;
+		constexpr std::size_t entry_block = std::size_t(1) << 14;
+	}
+	
+	// f(first, last) over [0, n) in blocks, in parallel for large n.  threads = 0 means hardware_threads(),
+	// looked up only once n is large enough to need it.
+	template <typename Function>
+	void for_entries(std::size_t n, Function f, std::size_t threads = 0) {
+		if (n < detail::parallel_entries)
+			return f(std::size_t(0), n);
+		
+		if (threads == 0)
+			threads = hardware_threads();
+		
+		if (threads == 1)
+			return f(std::size_t(0), n);
+		
+		std::size_t const blocks = (n + detail::entry_block - 1) / detail::entry_block;
+		
+		stealing_for(blocks, [&](std::size_t b) {
+			f(b * detail::entry_block, std::min(n, (b + 1) * detail::entry_block));
+		}, threads);
+	}
+	
+	// a fixed set of threads running submitted tasks in the order they came in.  for work that outlives the call
+	// that started it, like async_integral, where parallel_for would block.  tasks still queued when the pool is
+	// destroyed are run before the threads exit, so nothing waiting on them hangs.
+	class worker_pool {
+	public:
+		explicit worker_pool(std::size_t threads = hardware_threads()) {
+			threads = std::max<std::size_t>(1, threads);
+			
+			for (std::size_t t = 0; t < threads; ++t)
+				_threads.emplace_back([this]() { work(); });
+		}
+		
+		worker_pool(worker_pool const &) = delete;
+		worker_pool & operator=(worker_pool const &) = delete;
+		
+		~worker_pool() {
+			{
+				std::lock_guard<std::mutex> lock(_mutex);
+				_stop = true;
+			}
+			
+			_wake.notify_all();
+			
+			for (auto & t : _threads)
+				t.join();
+		}
+		
+		std::size_t size() const { return _threads.size(); }
+		
+		// tasks shouldn't throw, anything they do throw is dropped
+		void submit(std::function<void()> task) {
+			{
+				std::lock_guard<std::mutex> lock(_mutex);
+				_tasks.push_back(std::move(task));
+			}
+			
+			_wake.notify_one();
+		}
+	private:
+		void work() {
+			for (;;) {
+				std::function<void()> task;
+				
+				{
+					std::unique_lock<std::mutex> lock(_mutex);
+					_wake.wait(lock, [this]() { return _stop || !_tasks.empty(); });
+					
+					if (_tasks.empty())
+						return;
+					
+					task = std::move(_tasks.front());
+					_tasks.pop_front();
+				}
+				
+				try {
+					task();
+				} catch (...) { }
+			}
+		}
+		
+		std::mutex							_mutex;
+		std::condition_variable				_wake;
+		std::deque<std::function<void()>>	_tasks;
+		std::vector<std::thread>			_threads;
+		bool								_stop = false;
+	};
+	
+	// the pool shared by everything in the library that runs in the background, one thread per core
+	inline worker_pool & shared_pool() {
+		static worker_pool pool;
+		
+		return pool;
+	}
+}
+
+#endif
@@ -0,0 +1,245 @@
+//
+//  product_measure.h
+//  math
+//
+//  Created by Patrick Sauter on 10/19/26.
+//  Copyright (c) 2026 Patrick Sauter. All rights reserved.
+//
+
+#ifndef math_product_measure_h
+#define math_product_measure_h
+
+// measures whose density is a product of one factor per coordinate, like every common curvilinear system.
+//		spherical		(r, theta, phi)		r^2 sin(theta)
+//		cylindrical		(r, phi, z)			r
+//		polar			(r, phi)			r
+// the measure of a cell is then the product of the one dimensional integrals of each factor over the cell's
+// extent along that axis.  on a box_divider those only depend on the cell's index along the axis, so they can be
+// worked out once per axis (n1 + n2 + n3 values instead of n1 n2 n3) and looked up while integrating.
+//
+// measure::spherical in numeric_integral.h recomputes its cosines and radial polynomial for every cell,
+// numeric_integral(f, measure::spherical_product(), divider) gives the same sum from the tables.
+
+#include <cmath>
+#include <array>
+#include <tuple>
+#include <vector>
+#include <utility>
+
+#include "core.h"
+#include "box.h"
+#include "numeric_integral.h"
+
+namespace math {
+	namespace measure {
+		// ONE DIMENSIONAL FACTORS, each gives the integral of its density from a to b, and the density itself.
+		
+		// density 1, plain length
+		struct unit {
+			reals_t operator()(reals_t a, reals_t b) const { return b - a; }
+			reals_t density(reals_t) const { return 1; }
+		};
+		
+		// density t^K
+		template <unsigned K>
+		struct power {
+			reals_t operator()(reals_t a, reals_t b) const {
+				return (std::pow(b, reals_t(K + 1)) - std::pow(a, reals_t(K + 1))) / reals_t(K + 1);
+			}
+			reals_t density(reals_t t) const { return std::pow(t, reals_t(K)); }
+		};
+		
+		// density sin(t), the polar angle of spherical coordinates
+		struct sine {
+			reals_t operator()(reals_t a, reals_t b) const { return std::cos(a) - std::cos(b); }
+			reals_t density(reals_t t) const { return std::sin(t); }
+		};
+		
+		// any density w(t), integrated numerically with 5 point gauss-legendre over each cell.
+		// exact for polynomial densities up to degree 9, and cells are usually small.
+		template <typename Density>
+		struct jacobian {
+			jacobian(Density w = Density()) : _w(std::move(w)) { }
+			
+			reals_t operator()(reals_t a, reals_t b) const {
+				static constexpr reals_t node[]		= { 0., 0.5384693101056831, 0.9061798459386640 };
+				static constexpr reals_t weight[]	= { 0.5688888888888889, 0.4786286704993665, 0.2369268850561891 };
+				
+				reals_t c = (a + b) / 2, h = (b - a) / 2;
+				reals_t sum = weight[0] * _w(c);
+				
+				for (std::size_t i = 1; i < 3; ++i)
+					sum += weight[i] * (_w(c - h * node[i]) + _w(c + h * node[i]));
+				
+				return sum * h;
+			}
+			reals_t density(reals_t t) const { return _w(t); }
+		private:
+			Density		_w;
+		};
+		
+		template <typename Density>
+		jacobian<Density> make_jacobian(Density w) {
+			return jacobian<Density>(std::move(w));
+		}
+		
+		
+		
+		
+		// the measure with density Axis_0(x_0) * Axis_1(x_1) * ...
+		template <typename ... Axes>
+		class product_measure {
+		public:
+			static constexpr std::size_t dimension = sizeof...(Axes);
+			
+			product_measure() = default;
+			explicit product_measure(std::tuple<Axes...> axes) : _axes(std::move(axes)) { }
+			
+			// measure of a single cell, usable as an ordinary measure
+			template <typename Scalar>
+			reals_t operator()(box<vector<Scalar, dimension>> const & cell) const {
+				return cell_measure(cell, std::make_index_sequence<dimension>{});
+			}
+			
+			// the density at a point, for integrators that sample points instead of cells
+			template <typename Scalar>
+			reals_t density(vector<Scalar, dimension> const & p) const {
+				return point_density(p, std::make_index_sequence<dimension>{});
+			}
+			
+			// per axis weights for every cell of a divided box
+			template <typename Box>
+			class table {
+			public:
+				typedef typename box_divider<Box>::step_vector_type index_type;
+				
+				table(product_measure const & mu, box_divider<Box> const & d) {
+					fill(mu, d, std::make_index_sequence<dimension>{});
+				}
+				
+				// weights along one axis, by cell index
+				std::vector<reals_t> const & operator[](std::size_t axis) const { return _weights[axis]; }
+				
+				reals_t operator()(index_type const & i) const {
+					reals_t w = 1;
+					
+					for (std::size_t a = 0; a < dimension; ++a)
+						w *= _weights[a][i[a]];
+					
+					return w;
+				}
+			private:
+				template <std::size_t ... I>
+				void fill(product_measure const & mu, box_divider<Box> const & d, std::index_sequence<I...>) {
+					int expand[] = { 0, (fill_axis(std::get<I>(mu._axes), I, d), 0) ... };
+					(void)expand;
+				}
+				
+				template <typename Axis>
+				void fill_axis(Axis const & axis, std::size_t a, box_divider<Box> const & d) {
+					auto n = d.size()[a];
+					
+					_weights[a].reserve(n);
+					
+					for (std::size_t k = 0; k < n; ++k)
+						_weights[a].push_back(axis(d.edge(a, k), d.edge(a, k + 1)));
+				}
+				
+				std::array<std::vector<reals_t>, dimension>	_weights;
+			};
+			
+			template <typename Box>
+			table<Box> tabulate(box_divider<Box> const & d) const {
+				return table<Box>(*this, d);
+			}
+		private:
+			template <typename Scalar, std::size_t ... I>
+			reals_t cell_measure(box<vector<Scalar, dimension>> const & cell, std::index_sequence<I...>) const {
+				reals_t w = 1;
+				
+				int expand[] = { 0, (w *= std::get<I>(_axes)(cell.a()[I], cell.b()[I]), 0) ... };
+				(void)expand;
+				
+				return w;
+			}
+			
+			template <typename Scalar, std::size_t ... I>
+			reals_t point_density(vector<Scalar, dimension> const & p, std::index_sequence<I...>) const {
+				reals_t w = 1;
+				
+				int expand[] = { 0, (w *= std::get<I>(_axes).density(p[I]), 0) ... };
+				(void)expand;
+				
+				return w;
+			}
+			
+			std::tuple<Axes...>	_axes;
+		};
+		
+		template <typename ... Axes>
+		product_measure<Axes...> make_product_measure(Axes ... axes) {
+			return product_measure<Axes...>(std::make_tuple(std::move(axes) ...));
+		}
+		
+		// (r, theta, phi), theta polar and phi azimuthal, like measure::spherical
+		typedef product_measure<power<2>, sine, unit>	spherical_product;
+		
+		// (r, phi, z)
+		typedef product_measure<power<1>, unit, unit>	cylindrical_product;
+		
+		// (r, phi)
+		typedef product_measure<power<1>, unit>			polar_product;
+	}
+	
+	// numeric_integral with a product measure over a divided box, looking the cell measures up in per axis tables.
+	// the same sum as the generic version, cells are visited in the same order.
+	template <typename Function, typename ... Axes, typename Box>
+	auto numeric_integral(Function f, measure::product_measure<Axes...> const & mu, box_divider<Box> const & d)
+		-> decltype(f(*d.begin()))
+	{
+		typedef typename Box::vector_type vector_t;
+		
+		static_assert(check::vector_space<decltype(f(*d.begin())), reals_t>::value,
+					  "Assertion failed, return type not a vector space over the reals.");
+		static_assert(vector_t::rows() == sizeof...(Axes), "Assertion failed, measure and box dimensions differ.");
+		
+		constexpr std::size_t N = sizeof...(Axes);
+		
+		auto weights = mu.tabulate(d);
+		auto size = d.size();
+		
+		decltype(f(*d.begin())) sum{};
+		
+		if (d.size_total() == 0)
+			return sum;
+		
+		typename box_divider<Box>::step_vector_type	i(std::size_t(0));
+		vector_t lo, hi;
+		
+		for (std::size_t a = 0; a < N; ++a) {
+			lo[a] = d.edge(a, 0);
+			hi[a] = d.edge(a, 1);
+		}
+		
+		for (std::size_t n = 0; n < d.size_total(); ++n) {
+			sum += f(Box(lo, hi)) * weights(i);
+			
+			// odometer, axis 0 fastest like the divider's 1D index
+			for (std::size_t a = 0; a < N; ++a) {
+				if (++i[a] < size[a]) {
+					lo[a] = d.edge(a, i[a]);
+					hi[a] = d.edge(a, i[a] + 1);
+					break;
+				}
+				
+				i[a] = 0;
+				lo[a] = d.edge(a, 0);
+				hi[a] = d.edge(a, 1);
+			}
+		}
+		
+		return sum;
+	}
+}
+
+#endif
@@ -0,0 +1,340 @@
+//
+//  qr.h
+//  math
+//
+//  Created by Patrick Sauter on 10/19/26.
+//  Copyright (c) 2026 Patrick Sauter. All rights reserved.
+//
+
+#ifndef math_qr_h
+#define math_qr_h
+
+// householder QR of an m x n matrix, A P = Q R, and least squares on top of it.
+//
+//		auto f = qr(A, true);		// with column pivoting
+//		f.rank();
+//		f.solve(B);					// X minimising |A X - B|, one column of X for each of B
+//		lstsq(A, B);				// the same in one go
+//
+// least squares through the normal equations squares the condition number of A, going through Q doesn't, which is
+// the difference between losing 8 digits and losing 16 for a badly conditioned fit.
+//
+// R replaces the upper triangle of A, and below the diagonal column j holds the householder vector v of step j
+// (its first entry is 1 and not stored), H_j = I - tau_j v v^H.  A is taken by value, so qr(std::move(A)) works in
+// place.  the reflections go across whole rows, so the row major storage is read in order.
+//
+// with pivoting each step takes the column with the largest norm left, so |R_00| >= |R_11| >= ... and rank() counts
+// the diagonal entries above a tolerance.  solve then gives the basic solution, zero in the columns past the rank.
+// without pivoting a zero on the diagonal of R makes solve throw math::singular.
+
+#include <cmath>
+#include <array>
+#include <limits>
+#include <vector>
+#include <complex>
+#include <utility>
+#include <algorithm>
+#include <type_traits>
+
+#include "core.h"
+#include "exceptions.h"
+#include "lu.h"
+
+namespace math {
+	namespace detail {
+		template <typename Matrix>
+		struct rectangular;
+		
+		template <typename T, std::size_t N, std::size_t M>
+		struct rectangular<matrix<T,N,M>> {
+			typedef T							value_type;
+			typedef std::array<std::size_t, M>	columns_type;
+			typedef std::array<T, M>			scalars_type;
+			
+			static columns_type columns(std::size_t) { return columns_type{}; }
+			static scalars_type scalars(std::size_t) { return scalars_type{}; }
+		};
+		
+		template <typename T>
+		struct rectangular<dmatrix<T>> {
+			typedef T							value_type;
+			typedef std::vector<std::size_t>	columns_type;
+			typedef std::vector<T>				scalars_type;
+			
+			static columns_type columns(std::size_t n) { return columns_type(n); }
+			static scalars_type scalars(std::size_t n) { return scalars_type(n); }
+		};
+		
+		// X in A X = B, cols(A) x cols(B)
+		template <typename Matrix, typename B>
+		struct qr_solution;
+		
+		template <typename T, std::size_t N, std::size_t M, std::size_t K>
+		struct qr_solution<matrix<T,N,M>, matrix<T,N,K>> {
+			typedef matrix<T,M,K>	type;
+			
+			static type make(std::size_t, std::size_t) { return type(T(math::additive_identity)); }
+		};
+		
+		template <typename T>
+		struct qr_solution<dmatrix<T>, dmatrix<T>> {
+			typedef dmatrix<T>		type;
+			
+			static type make(std::size_t n, std::size_t k) { return type(n, k, T(math::additive_identity)); }
+		};
+		
+		template <typename T>
+		struct qr_solution<dmatrix<T>, dvector<T>> {
+			typedef dvector<T>		type;
+			
+			static type make(std::size_t n, std::size_t) { return type(n, T(math::additive_identity)); }
+		};
+		
+		// the reflection taking column j of the m x n matrix at a, from row j down, to (beta, 0, ..., 0).  v replaces
+		// the column below the diagonal, beta goes on it, and tau is returned
+		template <typename T>
+		T householder(T * a, std::size_t m, std::size_t n, std::size_t j) {
+			using std::real;
+			
+			typedef real_part_t<T> R;
+			
+			T const alpha = a[j * n + j];
+			R tail = 0;
+			
+			for (std::size_t i = j + 1; i < m; ++i)
+				tail += abs2(a[i * n + j]);
+			
+			if (tail == R(0) && alpha == conjugate(alpha))
+				return T(math::additive_identity);
+			
+			R const length = std::sqrt(abs2(alpha) + tail);
+			R const beta = (real(alpha) < 0 ? length : -length);
+			T const scale = T(1) / (alpha - T(beta));
+			
+			for (std::size_t i = j + 1; i < m; ++i)
+				a[i * n + j] = a[i * n + j] * scale;
+			
+			a[j * n + j] = T(beta);
+			
+			return (T(beta) - alpha) / T(beta);
+		}
+		
+		// H^H applied to columns first to first + cols of the rows x ld block x, using the reflection stored in column
+		// j of the m x n matrix at a.  w holds cols entries of scratch
+		template <typename T>
+		void reflect(T const * a, std::size_t m, std::size_t n, std::size_t j, T tau,
+					 T * x, std::size_t ld, std::size_t first, std::size_t cols, T * w)
+		{
+			if (tau == T(math::additive_identity))
+				return;
+			
+			// w = v^H X, then X -= conj(tau) v w
+			std::copy(x + j * ld + first, x + j * ld + first + cols, w);
+			
+			for (std::size_t i = j + 1; i < m; ++i) {
+				T const v = conjugate(a[i * n + j]);
+				T const * r = x + i * ld + first;
+				
+				for (std::size_t c = 0; c < cols; ++c)
+					w[c] = w[c] + v * r[c];
+			}
+			
+			T const t = conjugate(tau);
+			
+			for (std::size_t c = 0; c < cols; ++c)
+				x[j * ld + first + c] = x[j * ld + first + c] - t * w[c];
+			
+			for (std::size_t i = j + 1; i < m; ++i) {
+				T const v = t * a[i * n + j];
+				T * r = x + i * ld + first;
+				
+				for (std::size_t c = 0; c < cols; ++c)
+					r[c] = r[c] - v * w[c];
+			}
+		}
+	}
+	
+	template <typename Matrix>
+	class qr_decomposition {
+	public:
+		typedef detail::rectangular<Matrix>				shape;
+		typedef typename shape::value_type				value_type;
+		typedef detail::real_part_t<value_type>			real_type;
+		typedef typename shape::columns_type			columns_type;
+		typedef typename shape::scalars_type			scalars_type;
+		
+		static_assert(check::field<value_type>::value,
+					  "Assertion failed, QR decomposition needs a matrix over a field.");
+		
+		explicit qr_decomposition(Matrix a, bool pivoting = false)
+			: _qr(std::move(a)), _m(_qr.rows()), _n(_qr.cols()), _pivoting(pivoting),
+			  _columns(shape::columns(_n)), _tau(shape::scalars(_n))
+		{
+			value_type * p = _qr.data();
+			std::size_t const steps = std::min(_m, _n);
+			
+			for (std::size_t j = 0; j < _n; ++j)
+				_columns[j] = j;
+			
+			// squared norms of what is left of each column, and the value they were last worked out at
+			std::vector<real_type> norms, exact;
+			std::vector<value_type> w(_n);
+			
+			if (_pivoting) {
+				norms.assign(_n, real_type(0));
+				
+				for (std::size_t i = 0; i < _m; ++i)
+					for (std::size_t c = 0; c < _n; ++c)
+						norms[c] += detail::abs2(p[i * _n + c]);
+				
+				exact = norms;
+			}
+			
+			for (std::size_t j = 0; j < steps; ++j) {
+				if (_pivoting) {
+					std::size_t q = std::max_element(norms.begin() + j, norms.end()) - norms.begin();
+					
+					if (q != j) {
+						for (std::size_t i = 0; i < _m; ++i)
+							std::swap(p[i * _n + j], p[i * _n + q]);
+						
+						std::swap(norms[j], norms[q]);
+						std::swap(exact[j], exact[q]);
+						std::swap(_columns[j], _columns[q]);
+					}
+				}
+				
+				_tau[j] = detail::householder(p, _m, _n, j);
+				detail::reflect(p, _m, _n, j, _tau[j], p, _n, j + 1, _n - j - 1, w.data());
+				
+				if (_pivoting) {
+					// take row j out of the norms, working them out again once most of a norm has cancelled
+					for (std::size_t c = j + 1; c < _n; ++c) {
+						norms[c] -= detail::abs2(p[j * _n + c]);
+						
+						if (norms[c] <= exact[c] * std::sqrt(std::numeric_limits<real_type>::epsilon())) {
+							norms[c] = 0;
+							
+							for (std::size_t i = j + 1; i < _m; ++i)
+								norms[c] += detail::abs2(p[i * _n + c]);
+							
+							exact[c] = norms[c];
+						}
+					}
+				}
+			}
+		}
+		
+		std::size_t rows() const { return _m; }
+		std::size_t cols() const { return _n; }
+		bool pivoting() const { return _pivoting; }
+		
+		// R on and above the diagonal, the householder vectors below it
+		Matrix const & factors() const { return _qr; }
+		scalars_type const & tau() const { return _tau; }
+		
+		// column j of R came from column permutation()[j] of A
+		columns_type const & permutation() const { return _columns; }
+		
+		// diagonal entries of R above tolerance, by default max(m, n) epsilon |R_00|
+		std::size_t rank(real_type tolerance = -1) const {
+			std::size_t const steps = std::min(_m, _n);
+			
+			if (steps == 0)
+				return 0;
+			
+			if (tolerance < 0)
+				tolerance = real_type(std::max(_m, _n)) * std::numeric_limits<real_type>::epsilon() * std::sqrt(detail::abs2(_qr[0]));
+			
+			std::size_t r = 0;
+			
+			for (std::size_t j = 0; j < steps; ++j) {
+				if (std::sqrt(detail::abs2(_qr[j * _n + j])) > tolerance)
+					++r;
+			}
+			
+			return r;
+		}
+		
+		// Q^H B, B any matrix with rows() rows
+		template <typename B>
+		B apply_qh(B b) const {
+			detail::check_size(b.rows() == _m, "Matrix sizes don't match.");
+			
+			std::size_t const k = b.cols();
+			std::vector<value_type> w(k);
+			
+			for (std::size_t j = 0; j < std::min(_m, _n); ++j)
+				detail::reflect(_qr.data(), _m, _n, j, _tau[j], b.data(), k, 0, k, w.data());
+			
+			return b;
+		}
+		
+		// X minimising |A X - B| column by column, the basic solution when A doesn't have full column rank
+		template <typename B>
+		typename detail::qr_solution<Matrix, B>::type solve(B const & b) const {
+			typedef detail::qr_solution<Matrix, B> solution;
+			
+			std::size_t const k = b.cols();
+			std::size_t r = std::min(_m, _n);
+			
+			if (_pivoting)
+				r = rank();
+			else {
+				for (std::size_t j = 0; j < r; ++j) {
+					if (_qr[j * _n + j] == value_type(math::additive_identity))
+						throw math::singular();
+				}
+			}
+			
+			B y = apply_qh(b);
+			value_type * z = y.data();
+			value_type const * a = _qr.data();
+			
+			// R11 Z = (Q^H B) for the first r rows
+			for (std::size_t i = r; i-- > 0; ) {
+				for (std::size_t t = i + 1; t < r; ++t) {
+					value_type const u = a[i * _n + t];
+					
+					for (std::size_t c = 0; c < k; ++c)
+						z[i * k + c] = z[i * k + c] - u * z[t * k + c];
+				}
+				
+				for (std::size_t c = 0; c < k; ++c)
+					z[i * k + c] = z[i * k + c] / a[i * _n + i];
+			}
+			
+			auto x = solution::make(_n, k);
+			
+			for (std::size_t i = 0; i < r; ++i)
+				std::copy(z + i * k, z + i * k + k, x.data() + _columns[i] * k);
+			
+			return x;
+		}
+	private:
+		Matrix			_qr;
+		std::size_t		_m, _n;
+		bool			_pivoting;
+		columns_type	_columns;
+		scalars_type	_tau;
+	};
+	
+	template <typename Matrix>
+	qr_decomposition<typename std::decay<Matrix>::type> qr(Matrix && a, bool pivoting = false) {
+		return qr_decomposition<typename std::decay<Matrix>::type>(std::forward<Matrix>(a), pivoting);
+	}
+	
+	// ------------------------------------------------------
+	// least squares, X minimising |A X - B| by pivoted QR
+	
+	template <typename T, std::size_t N, std::size_t M, std::size_t K, typename = typename std::enable_if<check::field<T>::value>::type>
+	matrix<T,M,K> lstsq(matrix<T,N,M> const & a, matrix<T,N,K> const & b) {
+		return qr(a, true).solve(b);
+	}
+	template <typename T, typename B, typename = typename std::enable_if<check::field<T>::value>::type>
+	auto lstsq(dmatrix<T> a, B const & b) {
+		return qr(std::move(a), true).solve(b);
+	}
+}
+
+#endif
@@ -0,0 +1,156 @@
+//
+//  romberg.h
+//  math
+//
+//  Created by Patrick Sauter on 10/19/26.
+//  Copyright (c) 2026 Patrick Sauter. All rights reserved.
+//
+
+#ifndef math_romberg_h
+#define math_romberg_h
+
+// progressive integration over a box, for when an answer is needed by some time more than to some accuracy.
+// level l is the trapezoid rule on 2^l intervals per axis.  each level contains the points of the one before, so
+// only the new ones are evaluated and the sum carried over.  for smooth f the trapezoid error is a series in h^2,
+// which romberg's extrapolation cancels term by term, so the error falls much faster than the point count grows.
+//
+// after every level progress(estimate) is called with the best value so far and its error (the change in the
+// extrapolated value), and integration stops when it returns false.  with a deadline, a level that can't finish in
+// time is abandoned and the last complete estimate returned.
+
+#include <cmath>
+#include <array>
+#include <vector>
+#include <chrono>
+#include <limits>
+#include <algorithm>
+
+#include "core.h"
+#include "box.h"
+#include "numeric_integral.h"
+
+namespace math {
+	struct romberg_options {
+		typedef std::chrono::steady_clock		clock;
+		
+		reals_t				target_error	= 0;
+		reals_t				relative_error	= 1e-10;
+		std::size_t			max_level		= 20;
+		std::size_t			max_evaluations	= std::size_t(1) << 26;
+		clock::time_point	deadline		= clock::time_point::max();
+	};
+	
+	namespace detail {
+		struct no_progress {
+			template <typename T>
+			bool operator()(integral_estimate<T> const &) const { return true; }
+		};
+		
+		// points between clock checks
+		constexpr std::size_t romberg_block = 64;
+	}
+	
+	template <typename Function, typename Vector, typename Progress = detail::no_progress>
+	auto romberg_integral(Function f, box<Vector> const & region, romberg_options const & options = {}, Progress progress = {})
+		-> integral_estimate<decltype(f(std::declval<Vector>()))>
+	{
+		typedef decltype(f(std::declval<Vector>())) result_t;
+		
+		static_assert(check::vector_space<result_t, reals_t>::value,
+					  "Assertion failed, return type not a vector space over the reals.");
+		
+		constexpr std::size_t N = Vector::rows();
+		
+		auto const diagonal = region.diagonal();
+		reals_t const volume = detail::volume(region);
+		
+		result_t					raw{};		// trapezoid sum at the current level, without the cell volume
+		std::vector<result_t>		row;		// last row of the romberg table
+		integral_estimate<result_t>	best{ result_t{}, std::numeric_limits<reals_t>::infinity(), 0 };
+		
+		for (std::size_t level = 0; level <= options.max_level; ++level) {
+			std::size_t const n = std::size_t(1) << level;
+			
+			std::size_t count = 1;
+			
+			for (std::size_t i = 0; i < N; ++i)
+				count *= n + 1;
+			
+			if (level > 0 && best.evaluations + count > options.max_evaluations)
+				break;
+			
+			result_t sum = raw;
+			std::size_t evaluations = best.evaluations;
+			bool late = false;
+			
+			std::array<std::size_t, N> k{};
+			
+			for (std::size_t p = 0; p < count; ++p) {
+				// every old point has even indices along every axis
+				bool old = (level > 0);
+				reals_t w = 1;
+				
+				for (std::size_t i = 0; i < N; ++i) {
+					old = old && (k[i] % 2 == 0);
+					
+					if (k[i] == 0 || k[i] == n)
+						w /= 2;
+				}
+				
+				if (!old) {
+					Vector x = region.a();
+					
+					for (std::size_t i = 0; i < N; ++i)
+						x[i] += diagonal[i] * (reals_t(k[i]) / reals_t(n));
+					
+					sum += f(x) * w;
+					
+					if (++evaluations % detail::romberg_block == 0 && romberg_options::clock::now() > options.deadline) {
+						late = true;
+						break;
+					}
+				}
+				
+				for (std::size_t i = 0; i < N && ++k[i] > n; ++i)
+					k[i] = 0;
+			}
+			
+			if (late)
+				break;
+			
+			raw = sum;
+			
+			// new row of the table, T(h) then the extrapolations, R[l][j] = R[l][j-1] + (R[l][j-1] - R[l-1][j-1]) / (4^j - 1)
+			std::vector<result_t> next(level + 1);
+			next[0] = raw * (volume / std::pow(reals_t(n), reals_t(N)));
+			
+			reals_t four = 1;
+			
+			for (std::size_t j = 1; j <= level; ++j) {
+				four *= 4;
+				next[j] = next[j - 1] + (next[j - 1] - row[j - 1]) / (four - 1);
+			}
+			
+			if (level > 0)
+				best.error = std::sqrt(detail::magnitude2(result_t(next[level] - row[level - 1])));
+			
+			best.value = next[level];
+			best.evaluations = evaluations;
+			
+			row = std::move(next);
+			
+			if (!progress(best))
+				break;
+			
+			if (level > 0 && best.error <= std::max(options.target_error, options.relative_error * std::sqrt(detail::magnitude2(best.value))))
+				break;
+			
+			if (romberg_options::clock::now() > options.deadline)
+				break;
+		}
+		
+		return best;
+	}
+}
+
+#endif
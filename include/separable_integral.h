@@ -0,0 +1,346 @@
+//
+//  separable_integral.h
+//  math
+//
+//  Created by Patrick Sauter on 10/19/26.
+//  Copyright (c) 2026 Patrick Sauter. All rights reserved.
+//
+
+#ifndef math_separable_integral_h
+#define math_separable_integral_h
+
+// integrals of analytic functors over a box, split into lower dimensional integrals wherever the expression allows.
+//
+//		separable_integral(multiply<exp<x>, sin<y>, pow<z, rational<2>>>(), region, steps)
+//
+// is computed as three one dimensional integrals multiplied together, instead of one pass over the 3D grid.
+// the structure is read from the functor's type at compile time:
+//	- sums are integrated term by term
+//	- the factors of a product are grouped by the arguments they read (see dependency.h).  factors sharing
+//	  arguments stay together, and every group is integrated over just its own axes.
+//	- anything else is integrated exactly if it has a closed form antiderivative (see antiderivative.h), by evaluating
+//	  it at the corners of the box.  otherwise with the midpoint rule over the axes it reads, the same grid
+//	  numeric_integral would use.
+// axes an expression doesn't read at all just contribute their length.
+
+#include <cstdint>
+#include <tuple>
+#include <utility>
+
+#include "analytic.h"
+#include "dependency.h"
+#include "antiderivative.h"
+#include "box.h"
+#include "numeric_integral.h"
+
+namespace math {
+	namespace detail {
+		// calls an analytic functor with the components of a vector as its arguments
+		template <typename F, typename Vector, std::size_t ... S>
+		auto call_with(F const & f, Vector const & v, std::index_sequence<S ...>) -> decltype(f(v[S] ...)) {
+			return f(v[S] ...);
+		}
+		
+		template <typename F, typename Vector>
+		auto call_with(F const & f, Vector const & v) -> decltype(call_with(f, v, std::make_index_sequence<Vector::rows()>{})) {
+			return call_with(f, v, std::make_index_sequence<Vector::rows()>{});
+		}
+		
+		// length of the box along the given axes multiplied together
+		template <typename Vector>
+		reals_t volume(box<Vector> const & region, std::uint64_t axes) {
+			reals_t v = 1;
+			auto d = region.diagonal();
+			
+			for (std::size_t i = 0; i < Vector::rows(); ++i) {
+				if (axes >> i & 1)
+					v *= d[i];
+			}
+			
+			return v;
+		}
+		
+		// midpoint rule over only the given axes.  the other axes are collapsed to a single unit cell so they
+		// don't contribute to the measure, F doesn't read them so it doesn't matter where we sample them.
+		template <typename F, typename Vector, typename Steps>
+		auto grid_integral(box<Vector> const & region, Steps const & steps, std::uint64_t axes)
+			-> decltype(call_with(F{}, std::declval<Vector>()))
+		{
+			Vector a = region.a(), b = region.b();
+			Steps s = steps;
+			
+			for (std::size_t i = 0; i < Vector::rows(); ++i) {
+				if (!(axes >> i & 1)) {
+					a[i] = 0;
+					b[i] = 1;
+					s[i] = 1;
+				}
+			}
+			
+			box<Vector> sub(a, b);
+			
+			return numeric_integral([](box<Vector> cell) {
+				return call_with(F{}, Vector(cell));
+			}, [](box<Vector> const & cell) {
+				return volume(cell);
+			}, sub / s);
+		}
+		
+		// exact integral over the axes in Mask from the antiderivative in those axes.  the sum over the 2^N corners
+		// of the box, with the sign of each corner set by how many of its coordinates come from the low end.
+		template <typename F, std::uint64_t Mask, typename Vector>
+		auto corner_integral(box<Vector> const & region) -> decltype(call_with(F{}, std::declval<Vector>())) {
+			typedef analytic::antiderivative<F, Mask> antiderivative_t;
+			
+			decltype(call_with(F{}, std::declval<Vector>())) sum{};
+			
+			// every subset of Mask, the axes taken from the high end
+			for (std::uint64_t high = Mask; ; high = (high - 1) & Mask) {
+				Vector p = region.a();
+				bool negative = false;
+				
+				for (std::size_t i = 0; i < Vector::rows(); ++i) {
+					if (high >> i & 1)
+						p[i] = region.b()[i];
+					else if (Mask >> i & 1)
+						negative = !negative;
+				}
+				
+				auto value = call_with(antiderivative_t{}, p);
+				
+				if (negative)
+					sum -= value;
+				else
+					sum += value;
+				
+				if (!high)
+					break;
+			}
+			
+			return sum;
+		}
+		
+		// the arguments F reads, among the ones a Vector provides
+		template <typename F, typename Vector>
+		struct _vector_reads {
+			static constexpr std::uint64_t value = analytic::dependencies<F>::value &
+				(Vector::rows() < 64 ? (std::uint64_t(1) << Vector::rows()) - 1 : ~std::uint64_t(0));
+		};
+		
+		template <typename F, typename Vector, bool = analytic::has_antiderivative<F, _vector_reads<F, Vector>::value>::value>
+		struct _leaf_integral {
+			template <typename Steps>
+			static auto integrate(box<Vector> const & region, Steps const & steps, std::uint64_t reads)
+				-> decltype(call_with(F{}, std::declval<Vector>()))
+			{
+				return grid_integral<F>(region, steps, reads);
+			}
+		};
+		
+		template <typename F, typename Vector>
+		struct _leaf_integral<F, Vector, true> {
+			template <typename Steps>
+			static auto integrate(box<Vector> const & region, Steps const & steps, std::uint64_t reads)
+				-> decltype(call_with(F{}, std::declval<Vector>()))
+			{
+				if (reads == _vector_reads<F, Vector>::value)
+					return corner_integral<F, _vector_reads<F, Vector>::value>(region);
+				
+				return grid_integral<F>(region, steps, reads);
+			}
+		};
+		
+		// the product chain ___multiply<F1, ___multiply<F2, ...>> as a list of factors
+		template <typename T>
+		struct _factors {
+			typedef std::tuple<T> type;
+		};
+		template <typename F, typename G>
+		struct _factors<analytic::detail::___multiply<F,G>> {
+			typedef decltype(std::tuple_cat(std::declval<std::tuple<F>>(), std::declval<typename _factors<G>::type>())) type;
+		};
+		
+		template <std::size_t K>
+		struct factor_sets {
+			std::uint64_t	value[K];
+		};
+		
+		// groups factors whose argument sets overlap, directly or through other factors.
+		// element i is the set of factors in the same group as factor i.
+		template <std::size_t K>
+		constexpr factor_sets<K> factor_groups(factor_sets<K> reads) {
+			factor_sets<K> group{};
+			
+			for (std::size_t i = 0; i < K; ++i)
+				group.value[i] = std::uint64_t(1) << i;
+			
+			// merge until nothing changes, K is tiny
+			for (bool changed = true; changed; ) {
+				changed = false;
+				
+				for (std::size_t i = 0; i < K; ++i) {
+					for (std::size_t j = 0; j < K; ++j) {
+						if ((reads.value[i] & reads.value[j]) && group.value[i] != (group.value[i] | group.value[j])) {
+							group.value[i] |= group.value[j];
+							reads.value[i] |= reads.value[j];
+							changed = true;
+						}
+					}
+				}
+			}
+			
+			return group;
+		}
+		
+		// the product of the factors in Set
+		template <std::uint64_t Set, typename Factors, typename = std::make_index_sequence<std::tuple_size<Factors>::value>>
+		struct _partial_product;
+		
+		template <std::uint64_t Set, typename ... Factors, std::size_t ... I>
+		struct _partial_product<Set, std::tuple<Factors...>, std::index_sequence<I...>> {
+			typedef analytic::multiply<typename std::conditional<(Set >> I & 1), Factors, analytic::rational<1>>::type ...> type;
+		};
+		
+		template <std::uint64_t Set, typename Factors>
+		using partial_product = typename _partial_product<Set, Factors>::type;
+		
+		template <typename F>
+		struct _separable;
+		
+		template <typename F, typename Vector, typename Steps>
+		auto separable(box<Vector> const & region, Steps const & steps, std::uint64_t axes)
+			-> decltype(call_with(F{}, std::declval<Vector>()))
+		{
+			return _separable<F>::integrate(region, steps, axes);
+		}
+		
+		// nothing to split, integrate over the axes F reads, exactly if we can.
+		template <typename F>
+		struct _separable {
+			template <typename Vector, typename Steps>
+			static auto integrate(box<Vector> const & region, Steps const & steps, std::uint64_t axes)
+				-> decltype(call_with(F{}, std::declval<Vector>()))
+			{
+				std::uint64_t reads = analytic::dependencies<F>::value & axes;
+				
+				if (!reads)
+					return call_with(F{}, region.a()) * volume(region, axes);
+				
+				return _leaf_integral<F, Vector>::integrate(region, steps, reads) * volume(region, axes & ~reads);
+			}
+		};
+		
+		// integrals are linear
+		template <typename F, typename G>
+		struct _separable<analytic::detail::___add<F,G>> {
+			template <typename Vector, typename Steps>
+			static auto integrate(box<Vector> const & region, Steps const & steps, std::uint64_t axes)
+				-> decltype(call_with(analytic::detail::___add<F,G>{}, std::declval<Vector>()))
+			{
+				return separable<F>(region, steps, axes) + separable<G>(region, steps, axes);
+			}
+		};
+		
+		// split a product into groups of factors with disjoint arguments
+		template <typename F, typename G>
+		struct _separable<analytic::detail::___multiply<F,G>> {
+		private:
+			typedef analytic::detail::___multiply<F,G>		product_t;
+			typedef typename _factors<product_t>::type		factors_t;
+			
+			static constexpr std::size_t K = std::tuple_size<factors_t>::value;
+			
+			template <std::size_t ... I>
+			static constexpr factor_sets<K> reads(std::index_sequence<I...>) {
+				return {{ analytic::dependencies<typename std::tuple_element<I, factors_t>::type>::value ... }};
+			}
+			
+			static constexpr factor_sets<K> groups() {
+				return factor_groups<K>(reads(std::make_index_sequence<K>{}));
+			}
+			
+			// the integral of the group led by factor I, or 1 if factor I isn't the first in its group
+			template <std::size_t I, typename Vector, typename Steps, typename R>
+			static R group(box<Vector> const & region, Steps const & steps, std::uint64_t axes, R) {
+				constexpr std::uint64_t set = groups().value[I];
+				
+				if (set & ((std::uint64_t(1) << I) - 1))
+					return R(1);
+				
+				std::uint64_t group_axes = 0;
+				
+				for (std::size_t j = 0; j < K; ++j) {
+					if (set >> j & 1)
+						group_axes |= reads(std::make_index_sequence<K>{}).value[j];
+				}
+				
+				return R(_group<set == (std::uint64_t(1) << I), I, set>::integrate(region, steps, axes & group_axes));
+			}
+			
+			// a group of one factor might split further (a sum, say)
+			template <bool Single, std::size_t I, std::uint64_t Set>
+			struct _group {
+				template <typename Vector, typename Steps>
+				static auto integrate(box<Vector> const & region, Steps const & steps, std::uint64_t axes)
+					-> decltype(separable<typename std::tuple_element<I, factors_t>::type>(region, steps, axes))
+				{
+					return separable<typename std::tuple_element<I, factors_t>::type>(region, steps, axes);
+				}
+			};
+			template <std::size_t I, std::uint64_t Set>
+			struct _group<false, I, Set> {
+				template <typename Vector, typename Steps>
+				static auto integrate(box<Vector> const & region, Steps const & steps, std::uint64_t axes)
+					-> decltype(_leaf_integral<partial_product<Set, factors_t>, Vector>::integrate(region, steps, axes))
+				{
+					return _leaf_integral<partial_product<Set, factors_t>, Vector>::integrate(region, steps, axes);
+				}
+			};
+			
+			template <typename Vector, typename Steps, typename R, std::size_t ... I>
+			static R product(box<Vector> const & region, Steps const & steps, std::uint64_t axes, R, std::index_sequence<I...>) {
+				R r = 1;
+				
+				int expand[] = { 0, (r *= group<I>(region, steps, axes, R{}), 0) ... };
+				(void)expand;
+				
+				return r;
+			}
+		public:
+			template <typename Vector, typename Steps>
+			static auto integrate(box<Vector> const & region, Steps const & steps, std::uint64_t axes)
+				-> decltype(call_with(product_t{}, std::declval<Vector>()))
+			{
+				typedef decltype(call_with(product_t{}, std::declval<Vector>())) result_t;
+				
+				std::uint64_t reads = analytic::dependencies<product_t>::value & axes;
+				
+				return product(region, steps, reads, result_t{}, std::make_index_sequence<K>{}) * volume(region, axes & ~reads);
+			}
+		};
+	}
+	
+	// integral of the analytic functor F over region, using steps subdivisions per axis wherever a grid is needed.
+	// F is only used for its type, analytic functors carry no state.
+	template <typename F, typename Vector>
+	auto separable_integral(F, box<Vector> const & region, typename Vector::template convert_type<std::size_t> const & steps)
+		-> decltype(detail::call_with(F{}, std::declval<Vector>()))
+	{
+		std::uint64_t axes = (Vector::rows() < 64 ? (std::uint64_t(1) << Vector::rows()) - 1 : ~std::uint64_t(0));
+		
+		return detail::separable<F>(region, steps, axes);
+	}
+	
+	// integral of the analytic functor F over region from its antiderivative, 2^N evaluations and no grid.
+	// only for functors with a closed form, check analytic::has_antiderivative or use separable_integral otherwise.
+	template <typename F, typename Vector>
+	auto exact_integral(F, box<Vector> const & region) -> decltype(detail::call_with(F{}, std::declval<Vector>())) {
+		constexpr std::uint64_t reads = detail::_vector_reads<F, Vector>::value;
+		
+		static_assert(analytic::has_antiderivative<F, reads>::value, "Assertion failed, no closed form antiderivative.");
+		
+		return detail::corner_integral<F, reads>(region) * detail::volume(region, ~reads);
+	}
+}
+
+#endif
@@ -0,0 +1,239 @@
+//
+//  simplex.h
+//  math
+//
+//  Created by Patrick Sauter on 10/19/26.
+//  Copyright (c) 2026 Patrick Sauter. All rights reserved.
+//
+
+#ifndef math_simplex_h
+#define math_simplex_h
+
+// triangles and tetrahedra as integration domains.  numeric_integral only takes boxes, so anything else had to be
+// masked out of a bounding box, which costs points and only converges at first order along the boundary.
+//
+//		simplex<vector<reals_t,2>> T({ a, b, c });
+//		simplex_integral(f, T, 5);
+//
+// the rules are the usual fully symmetric ones, given in barycentric coordinates with weights summing to 1,
+//		segment			degree 1 (1 point), 3 (2 points), 5 (3 points), gauss-legendre
+//		triangle		degree 1 (1 point), 2 (3 points), 5 (7 points, radon)
+//		tetrahedron		degree 1 (1 point), 2 (4 points), 3 (5 points, keast)
+// a rule of the smallest degree at least the one asked for is used.  K is the dimension of the simplex, which can
+// sit in a larger space (triangles of a surface in 3D), the volume is then worked out from the gram determinant.
+
+#include <cmath>
+#include <array>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+
+#include "core.h"
+#include "vector.h"
+
+namespace math {
+	// a cubature point, weight relative to the volume of the simplex
+	template <std::size_t K>
+	struct simplex_node {
+		std::array<reals_t, K + 1>	barycentric;
+		reals_t						weight;
+	};
+	
+	namespace detail {
+		// every distinct permutation of the barycentric coordinates, weight per point
+		template <std::size_t K>
+		void simplex_orbit(std::vector<simplex_node<K>> & rule, std::array<reals_t, K + 1> lambda, reals_t weight) {
+			std::sort(lambda.begin(), lambda.end());
+			
+			do {
+				rule.push_back({ lambda, weight });
+			} while (std::next_permutation(lambda.begin(), lambda.end()));
+		}
+		
+		template <std::size_t K>
+		struct simplex_rules;
+		
+		template <>
+		struct simplex_rules<1> {
+			static std::vector<std::vector<simplex_node<1>>> make() {
+				std::vector<std::vector<simplex_node<1>>> rules(3);
+				
+				simplex_orbit<1>(rules[0], {{ reals_t(1) / 2, reals_t(1) / 2 }}, 1);
+				
+				reals_t const a = (1 - 1 / std::sqrt(reals_t(3))) / 2;
+				
+				simplex_orbit<1>(rules[1], {{ a, 1 - a }}, reals_t(1) / 2);
+				
+				reals_t const b = (1 - std::sqrt(reals_t(3) / 5)) / 2;
+				
+				simplex_orbit<1>(rules[2], {{ reals_t(1) / 2, reals_t(1) / 2 }}, reals_t(4) / 9);
+				simplex_orbit<1>(rules[2], {{ b, 1 - b }}, reals_t(5) / 18);
+				
+				return rules;
+			}
+			
+			static std::size_t degree(std::size_t i) { return 2 * i + 1; }
+		};
+		
+		template <>
+		struct simplex_rules<2> {
+			static std::vector<std::vector<simplex_node<2>>> make() {
+				std::vector<std::vector<simplex_node<2>>> rules(3);
+				
+				simplex_orbit<2>(rules[0], {{ reals_t(1) / 3, reals_t(1) / 3, reals_t(1) / 3 }}, 1);
+				
+				simplex_orbit<2>(rules[1], {{ reals_t(1) / 6, reals_t(1) / 6, reals_t(2) / 3 }}, reals_t(1) / 3);
+				
+				reals_t const r = std::sqrt(reals_t(15));
+				reals_t const a1 = (6 - r) / 21, a2 = (6 + r) / 21;
+				
+				simplex_orbit<2>(rules[2], {{ reals_t(1) / 3, reals_t(1) / 3, reals_t(1) / 3 }}, reals_t(9) / 40);
+				simplex_orbit<2>(rules[2], {{ a1, a1, 1 - 2 * a1 }}, (155 - r) / 1200);
+				simplex_orbit<2>(rules[2], {{ a2, a2, 1 - 2 * a2 }}, (155 + r) / 1200);
+				
+				return rules;
+			}
+			
+			static std::size_t degree(std::size_t i) { return (i == 0 ? 1 : (i == 1 ? 2 : 5)); }
+		};
+		
+		template <>
+		struct simplex_rules<3> {
+			static std::vector<std::vector<simplex_node<3>>> make() {
+				std::vector<std::vector<simplex_node<3>>> rules(3);
+				
+				simplex_orbit<3>(rules[0], {{ reals_t(1) / 4, reals_t(1) / 4, reals_t(1) / 4, reals_t(1) / 4 }}, 1);
+				
+				reals_t const a = (5 - std::sqrt(reals_t(5))) / 20;
+				
+				simplex_orbit<3>(rules[1], {{ a, a, a, 1 - 3 * a }}, reals_t(1) / 4);
+				
+				// keast's rule has a negative weight at the centroid, fine for smooth integrands
+				simplex_orbit<3>(rules[2], {{ reals_t(1) / 4, reals_t(1) / 4, reals_t(1) / 4, reals_t(1) / 4 }}, reals_t(-4) / 5);
+				simplex_orbit<3>(rules[2], {{ reals_t(1) / 6, reals_t(1) / 6, reals_t(1) / 6, reals_t(1) / 2 }}, reals_t(9) / 20);
+				
+				return rules;
+			}
+			
+			static std::size_t degree(std::size_t i) { return i + 1; }
+		};
+		
+		// determinant of a small symmetric positive semidefinite matrix, by elimination without pivoting
+		template <std::size_t K>
+		reals_t gram_determinant(std::array<std::array<reals_t, K>, K> G) {
+			reals_t det = 1;
+			
+			for (std::size_t i = 0; i < K; ++i) {
+				if (!(G[i][i] > 0))
+					return 0;
+				
+				det *= G[i][i];
+				
+				for (std::size_t r = i + 1; r < K; ++r) {
+					reals_t m = G[r][i] / G[i][i];
+					
+					for (std::size_t c = i; c < K; ++c)
+						G[r][c] -= m * G[i][c];
+				}
+			}
+			
+			return det;
+		}
+	}
+	
+	// the cubature rule for a K simplex exact for polynomials of the given degree.
+	// throws std::invalid_argument if there isn't one that high.
+	template <std::size_t K>
+	std::vector<simplex_node<K>> const & simplex_rule(std::size_t degree) {
+		static_assert(K >= 1 && K <= 3, "Assertion failed, cubature rules exist for segments, triangles and tetrahedra only.");
+		
+		static std::vector<std::vector<simplex_node<K>>> const rules = detail::simplex_rules<K>::make();
+		
+		for (std::size_t i = 0; i < rules.size(); ++i) {
+			if (detail::simplex_rules<K>::degree(i) >= degree)
+				return rules[i];
+		}
+		
+		throw std::invalid_argument("No simplex rule of the requested degree.");
+	}
+	
+	template <typename Vector, std::size_t K = Vector::rows()>
+	class simplex {
+	public:
+		typedef Vector			vector_type;
+		
+		static constexpr std::size_t dimension = K;
+		
+		static_assert(K >= 1 && K <= vector_type::rows(), "Assertion failed, simplex dimension larger than its space.");
+		
+		simplex() = default;
+		simplex(std::array<vector_type, K + 1> const & vertices) : _v(vertices) { }
+		
+		vector_type const & operator[](std::size_t i) const { return _v[i]; }
+		vector_type & operator[](std::size_t i) { return _v[i]; }
+		
+		// sum of lambda_i v_i
+		vector_type point(std::array<reals_t, K + 1> const & lambda) const {
+			vector_type x;
+			
+			for (std::size_t d = 0; d < vector_type::rows(); ++d) {
+				reals_t s = 0;
+				
+				for (std::size_t i = 0; i <= K; ++i)
+					s += lambda[i] * reals_t(_v[i][d]);
+				
+				x[d] = typename vector_type::value_type(s);
+			}
+			
+			return x;
+		}
+		
+		vector_type centroid() const {
+			std::array<reals_t, K + 1> lambda;
+			lambda.fill(reals_t(1) / (K + 1));
+			
+			return point(lambda);
+		}
+		
+		// length, area or volume, sqrt(det(E^T E)) / K! for the edge vectors E from vertex 0
+		reals_t volume() const {
+			std::array<std::array<reals_t, K>, K> G;
+			
+			for (std::size_t i = 0; i < K; ++i) {
+				for (std::size_t j = 0; j <= i; ++j) {
+					reals_t s = 0;
+					
+					for (std::size_t d = 0; d < vector_type::rows(); ++d)
+						s += reals_t(_v[i + 1][d] - _v[0][d]) * reals_t(_v[j + 1][d] - _v[0][d]);
+					
+					G[i][j] = G[j][i] = s;
+				}
+			}
+			
+			reals_t factorial = 1;
+			
+			for (std::size_t k = 2; k <= K; ++k)
+				factorial *= k;
+			
+			return std::sqrt(detail::gram_determinant<K>(G)) / factorial;
+		}
+	private:
+		std::array<vector_type, K + 1>	_v;
+	};
+	
+	// integral of f(Vector) over the simplex with a rule of at least the given degree
+	template <typename Function, typename Vector, std::size_t K>
+	auto simplex_integral(Function f, simplex<Vector, K> const & s, std::size_t degree = 2) -> decltype(f(std::declval<Vector>())) {
+		static_assert(check::vector_space<decltype(f(std::declval<Vector>())), reals_t>::value,
+					  "Assertion failed, return type not a vector space over the reals.");
+		
+		decltype(f(std::declval<Vector>())) sum{};
+		
+		for (auto const & node : simplex_rule<K>(degree))
+			sum += f(s.point(node.barycentric)) * node.weight;
+		
+		return sum * s.volume();
+	}
+}
+
+#endif
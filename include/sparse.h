@@ -0,0 +1,528 @@
+//
+//  sparse.h
+//  math
+//
+//  Created by Patrick Sauter on 10/19/26.
+//  Copyright (c) 2026 Patrick Sauter. All rights reserved.
+//
+
+#ifndef math_sparse_h
+#define math_sparse_h
+
+// compressed sparse matrices, for the systems from discretisations where almost every entry is zero.
+//
+//	- csr_matrix<T>, compressed rows.  offsets()[i] to offsets()[i + 1] are the entries of row i, indices() their
+//	  columns in increasing order and values() the entries.  A x reads each row front to back, a dot product per row.
+//	- csc_matrix<T>, the same by columns, so A^T x is the dot products.
+//
+// the CSR arrays of A are the CSC arrays of A^T, so transpose() moves between the two without touching the entries,
+// while to_csr / to_csc keep the matrix and rearrange the arrays.
+//
+// they are built from triplets (i, j, value), entries at the same place are added up,
+//
+//		sparse_builder<reals_t> b(rows, cols);
+//		b.add(i, j, x);
+//		auto A = b.csr();
+//
+// or in parallel, assemble(rows, cols, count, f) calls f(k, builder) for every k, an element of a mesh say, on many
+// threads.  each block of k has its own builder and they are joined in order, so the entries are added up in the
+// same order on any number of threads and the matrix comes out the same.
+//
+// A * X for a dense X (matrix, dmatrix, dvector, a view or expression) gives a dmatrix, transpose_multiply(A, X) is
+// A^T X, and multiply / multiply_transposed work on raw storage for iterative solvers.  the dot product form runs
+// in parallel over blocks of rows once the matrix is big.  the other form adds into scattered entries of the result,
+// and runs on one thread, so for a lot of A^T x products convert the matrix once with to_csc.
+// for double the dot products use AVX2 gathers when the compiler allows (-mavx2 -mfma), and complex_t works on the
+// real and imaginary parts directly.
+
+#include <cstddef>
+#include <cstdint>
+#include <complex>
+#include <vector>
+#include <utility>
+#include <numeric>
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+
+#include "core.h"
+#include "matrix.h"
+#include "dmatrix.h"
+#include "parallel.h"
+
+#if defined(__AVX2__) && defined(__FMA__)
+#include <immintrin.h>
+#endif
+
+namespace math {
+	namespace detail {
+		typedef std::uint32_t sparse_index;
+		
+		// rows (columns) per parallel block, and items per block of assemble
+		constexpr std::size_t sparse_block = 512;
+		constexpr std::size_t assembly_block = 256;
+		
+		// sum of v[k] x[j[k]]
+		template <typename T>
+		T sparse_dot(T const * v, sparse_index const * j, std::size_t n, T const * x) {
+			T s = T(math::additive_identity);
+			
+			for (std::size_t k = 0; k < n; ++k)
+				s = s + v[k] * x[j[k]];
+			
+			return s;
+		}
+		
+		inline double sparse_dot(double const * v, sparse_index const * j, std::size_t n, double const * x) {
+			std::size_t k = 0;
+			double s = 0;
+
+#if defined(__AVX2__) && defined(__FMA__)
+			__m256d sum = _mm256_setzero_pd();
+			
+			__m256d const all = _mm256_castsi256_pd(_mm256_set1_epi64x(-1));
+			
+			// the indices are below 2^31, checked when the matrix is made, so they gather as signed ints.  the masked
+			// gather, as the plain one leaves gcc thinking its source is uninitialised
+			for (; k + 4 <= n; k += 4) {
+				__m128i index = _mm_loadu_si128(reinterpret_cast<__m128i const *>(j + k));
+				__m256d b = _mm256_mask_i32gather_pd(_mm256_setzero_pd(), x, index, all, 8);
+				
+				sum = _mm256_fmadd_pd(_mm256_loadu_pd(v + k), b, sum);
+			}
+			
+			__m128d half = _mm_add_pd(_mm256_castpd256_pd128(sum), _mm256_extractf128_pd(sum, 1));
+			s = _mm_cvtsd_f64(_mm_add_sd(half, _mm_unpackhi_pd(half, half)));
+#endif
+
+			for (; k < n; ++k)
+				s += v[k] * x[j[k]];
+			
+			return s;
+		}
+		
+		// std::complex's operator* checks for nans on every product
+		inline complex_t sparse_dot(complex_t const * v, sparse_index const * j, std::size_t n, complex_t const * x) {
+			double const * a = reinterpret_cast<double const *>(v);
+			double const * b = reinterpret_cast<double const *>(x);
+			double re = 0, im = 0;
+			
+			for (std::size_t k = 0; k < n; ++k) {
+				double const * c = b + 2 * std::size_t(j[k]);
+				
+				re += a[2 * k] * c[0] - a[2 * k + 1] * c[1];
+				im += a[2 * k] * c[1] + a[2 * k + 1] * c[0];
+			}
+			
+			return complex_t(re, im);
+		}
+	}
+	
+	template <typename Type, bool Rows>
+	class compressed_matrix;
+	
+	template <typename Type = reals_t>
+	using csr_matrix = compressed_matrix<Type, true>;
+	
+	template <typename Type = reals_t>
+	using csc_matrix = compressed_matrix<Type, false>;
+	
+	template <typename Type, bool Rows>
+	class compressed_matrix {
+	public:
+		static_assert(check::ring<Type>::value,
+					  "Assertion failed, matrix type not a Ring.");
+		
+		typedef Type						value_type;
+		typedef detail::sparse_index		index_type;
+		
+		compressed_matrix() : _offsets(1, 0) { }
+		
+		// all zero
+		compressed_matrix(std::size_t rows, std::size_t cols) : _rows(rows), _cols(cols), _offsets(major() + 1, 0) {
+			check_dimensions();
+		}
+		
+		// the arrays as described at the top, checked
+		compressed_matrix(std::size_t rows, std::size_t cols, std::vector<std::size_t> offsets,
+						  std::vector<index_type> indices, std::vector<Type> values)
+			: _rows(rows), _cols(cols), _offsets(std::move(offsets)), _indices(std::move(indices)), _values(std::move(values))
+		{
+			check_dimensions();
+			
+			detail::check_size(_offsets.size() == major() + 1 && _offsets.front() == 0 && _offsets.back() == _indices.size() &&
+							   _indices.size() == _values.size(), "Sparse arrays don't fit together.");
+			
+			for (std::size_t m = 0; m < major(); ++m) {
+				detail::check_size(_offsets[m] <= _offsets[m + 1], "Sparse offsets decrease.");
+				
+				for (std::size_t k = _offsets[m]; k < _offsets[m + 1]; ++k)
+					detail::check_size(_indices[k] < minor() && (k == _offsets[m] || _indices[k - 1] < _indices[k]),
+									   "Sparse indices out of range or out of order.");
+			}
+		}
+		
+		// the nonzero entries of a dense matrix
+		template <std::size_t N, std::size_t M>
+		explicit compressed_matrix(matrix<Type, N, M> const & a) : compressed_matrix(a.data(), N, M) { }
+		explicit compressed_matrix(dmatrix<Type> const & a) : compressed_matrix(a.data(), a.rows(), a.cols()) { }
+		
+		std::size_t rows() const { return _rows; }
+		std::size_t cols() const { return _cols; }
+		std::size_t nonzeros() const { return _values.size(); }
+		
+		std::vector<std::size_t> const & offsets() const { return _offsets; }
+		std::vector<index_type> const & indices() const { return _indices; }
+		std::vector<Type> const & values() const { return _values; }
+		
+		// entry (i, j), a binary search
+		Type operator()(std::size_t i, std::size_t j) const {
+			assert(i < _rows && j < _cols);
+			
+			std::size_t m = (Rows ? i : j), n = (Rows ? j : i);
+			
+			auto first = _indices.begin() + _offsets[m], last = _indices.begin() + _offsets[m + 1];
+			auto k = std::lower_bound(first, last, index_type(n));
+			
+			return (k != last && *k == n ? _values[k - _indices.begin()] : Type(math::additive_identity));
+		}
+		
+		dmatrix<Type> dense() const {
+			dmatrix<Type> a(_rows, _cols);
+			
+			for (std::size_t m = 0; m < major(); ++m)
+				for (std::size_t k = _offsets[m]; k < _offsets[m + 1]; ++k)
+					(Rows ? a(m, _indices[k]) : a(_indices[k], m)) = _values[k];
+			
+			return a;
+		}
+		
+		template <std::size_t N, std::size_t M>
+		explicit operator matrix<Type, N, M>() const {
+			return matrix<Type, N, M>(dense());
+		}
+		
+		// A^T, the same arrays read the other way
+		compressed_matrix<Type, !Rows> transpose() const & {
+			return compressed_matrix<Type, !Rows>(_cols, _rows, _offsets, _indices, _values, 0);
+		}
+		compressed_matrix<Type, !Rows> transpose() && {
+			return compressed_matrix<Type, !Rows>(_cols, _rows, std::move(_offsets), std::move(_indices), std::move(_values), 0);
+		}
+		
+		// Y = A X and Y = A^T X, X and Y row major with k columns.  Y is overwritten
+		void multiply(Type const * x, Type * y, std::size_t k = 1) const {
+			if (Rows)
+				gather(x, y, k);
+			else
+				scatter(x, y, k);
+		}
+		void multiply_transposed(Type const * x, Type * y, std::size_t k = 1) const {
+			if (Rows)
+				scatter(x, y, k);
+			else
+				gather(x, y, k);
+		}
+	private:
+		template <typename, bool>
+		friend class compressed_matrix;
+		
+		// unchecked, for transpose and the builder
+		compressed_matrix(std::size_t rows, std::size_t cols, std::vector<std::size_t> offsets,
+						  std::vector<index_type> indices, std::vector<Type> values, int)
+			: _rows(rows), _cols(cols), _offsets(std::move(offsets)), _indices(std::move(indices)), _values(std::move(values)) { }
+		
+		compressed_matrix(Type const * a, std::size_t rows, std::size_t cols) : _rows(rows), _cols(cols), _offsets(1, 0) {
+			check_dimensions();
+			
+			Type const zero = Type(math::additive_identity);
+			
+			for (std::size_t m = 0; m < major(); ++m) {
+				for (std::size_t n = 0; n < minor(); ++n) {
+					Type const & x = (Rows ? a[m * cols + n] : a[n * cols + m]);
+					
+					if (x != zero) {
+						_indices.push_back(index_type(n));
+						_values.push_back(x);
+					}
+				}
+				
+				_offsets.push_back(_indices.size());
+			}
+		}
+		
+		std::size_t major() const { return (Rows ? _rows : _cols); }
+		std::size_t minor() const { return (Rows ? _cols : _rows); }
+		
+		void check_dimensions() const {
+			detail::check_size(_rows < (std::size_t(1) << 31) && _cols < (std::size_t(1) << 31), "Sparse matrix too large for 32 bit indices.");
+		}
+		
+		// y[m] = sum over the entries of m, independent for every m so blocks of them go in parallel
+		void gather(Type const * x, Type * y, std::size_t k) const {
+			auto block = [&](std::size_t first, std::size_t last) {
+				for (std::size_t m = first; m < last; ++m) {
+					std::size_t const begin = _offsets[m], count = _offsets[m + 1] - begin;
+					
+					if (k == 1) {
+						y[m] = detail::sparse_dot(_values.data() + begin, _indices.data() + begin, count, x);
+						continue;
+					}
+					
+					Type * r = y + m * k;
+					std::fill(r, r + k, Type(math::additive_identity));
+					
+					for (std::size_t e = begin; e < begin + count; ++e) {
+						Type const v = _values[e];
+						Type const * s = x + std::size_t(_indices[e]) * k;
+						
+						for (std::size_t c = 0; c < k; ++c)
+							r[c] = r[c] + v * s[c];
+					}
+				}
+			};
+			
+			std::size_t const n = major();
+			
+			if (nonzeros() * k < detail::parallel_entries)
+				return block(0, n);
+			
+			stealing_for((n + detail::sparse_block - 1) / detail::sparse_block, [&](std::size_t b) {
+				block(b * detail::sparse_block, std::min(n, (b + 1) * detail::sparse_block));
+			});
+		}
+		
+		// y[minor] += v x[m], entries of different m land in the same places so this stays on one thread
+		void scatter(Type const * x, Type * y, std::size_t k) const {
+			std::fill(y, y + minor() * k, Type(math::additive_identity));
+			
+			for (std::size_t m = 0; m < major(); ++m) {
+				Type const * s = x + m * k;
+				
+				for (std::size_t e = _offsets[m]; e < _offsets[m + 1]; ++e) {
+					Type const v = _values[e];
+					Type * r = y + std::size_t(_indices[e]) * k;
+					
+					for (std::size_t c = 0; c < k; ++c)
+						r[c] = r[c] + v * s[c];
+				}
+			}
+		}
+		
+		std::size_t					_rows = 0, _cols = 0;
+		std::vector<std::size_t>	_offsets;
+		std::vector<index_type>		_indices;
+		std::vector<Type>			_values;
+		
+		template <typename T>
+		friend class sparse_builder;
+	};
+	
+	// ------------------------------------------------------
+	// triplets to compressed form
+	
+	template <typename Type = reals_t>
+	class sparse_builder {
+	public:
+		typedef Type						value_type;
+		typedef detail::sparse_index		index_type;
+		
+		struct triplet {
+			index_type		row, col;
+			Type			value;
+		};
+		
+		sparse_builder(std::size_t rows, std::size_t cols) : _rows(rows), _cols(cols) {
+			detail::check_size(rows < (std::size_t(1) << 31) && cols < (std::size_t(1) << 31), "Sparse matrix too large for 32 bit indices.");
+		}
+		
+		std::size_t rows() const { return _rows; }
+		std::size_t cols() const { return _cols; }
+		std::size_t size() const { return _triplets.size(); }
+		
+		void reserve(std::size_t n) { _triplets.reserve(n); }
+		
+		// added to whatever is already at (i, j)
+		void add(std::size_t i, std::size_t j, Type const & value) {
+			detail::check_size(i < _rows && j < _cols, "Sparse entry out of range.");
+			
+			_triplets.push_back({ index_type(i), index_type(j), value });
+		}
+		
+		// the triplets of another builder, after these
+		void append(sparse_builder const & other) {
+			detail::check_size(other._rows == _rows && other._cols == _cols, "Matrix sizes don't match.");
+			
+			_triplets.insert(_triplets.end(), other._triplets.begin(), other._triplets.end());
+		}
+		
+		std::vector<triplet> const & triplets() const { return _triplets; }
+		
+		csr_matrix<Type> csr(std::size_t threads = hardware_threads()) const { return build<true>(threads); }
+		csc_matrix<Type> csc(std::size_t threads = hardware_threads()) const { return build<false>(threads); }
+	private:
+		// a counting sort on the major index keeps the triplets' order, then each row (column) is sorted stably on
+		// the minor index and runs of the same index added up front to back
+		template <bool Rows>
+		compressed_matrix<Type, Rows> build(std::size_t threads) const {
+			std::size_t const major = (Rows ? _rows : _cols);
+			std::size_t const n = _triplets.size();
+			
+			std::vector<std::size_t> start(major + 1, 0);
+			
+			for (auto const & t : _triplets)
+				++start[(Rows ? t.row : t.col) + 1];
+			
+			std::partial_sum(start.begin(), start.end(), start.begin());
+			
+			std::vector<std::pair<index_type, Type>> entries(n);
+			std::vector<std::size_t> next(start.begin(), start.end() - 1);
+			
+			for (auto const & t : _triplets)
+				entries[next[Rows ? t.row : t.col]++] = { (Rows ? t.col : t.row), t.value };
+			
+			// distinct entries in each row, summed in place at the front of the row
+			std::vector<std::size_t> distinct(major + 1, 0);
+			std::size_t const blocks = (major + detail::sparse_block - 1) / detail::sparse_block;
+			
+			parallel_for(blocks, [&](std::size_t b) {
+				for (std::size_t m = b * detail::sparse_block; m < std::min(major, (b + 1) * detail::sparse_block); ++m) {
+					auto first = entries.begin() + start[m], last = entries.begin() + start[m + 1];
+					
+					std::stable_sort(first, last, [](auto const & x, auto const & y) { return x.first < y.first; });
+					
+					auto out = first;
+					
+					for (auto e = first; e != last; ++e) {
+						if (out != first && (out - 1)->first == e->first)
+							(out - 1)->second = (out - 1)->second + e->second;
+						else
+							*out++ = *e;
+					}
+					
+					distinct[m + 1] = out - first;
+				}
+			}, (n < detail::parallel_entries ? 1 : threads));
+			
+			std::partial_sum(distinct.begin(), distinct.end(), distinct.begin());
+			
+			std::vector<index_type> indices(distinct.back());
+			std::vector<Type> values(distinct.back());
+			
+			for (std::size_t m = 0; m < major; ++m) {
+				for (std::size_t e = 0; e < distinct[m + 1] - distinct[m]; ++e) {
+					indices[distinct[m] + e] = entries[start[m] + e].first;
+					values[distinct[m] + e] = entries[start[m] + e].second;
+				}
+			}
+			
+			return compressed_matrix<Type, Rows>(_rows, _cols, std::move(distinct), std::move(indices), std::move(values), 0);
+		}
+		
+		std::size_t				_rows, _cols;
+		std::vector<triplet>	_triplets;
+	};
+	
+	// f(k, builder) for every k in [0, count), on many threads, the triplets joined in the order of k
+	template <typename Type = reals_t, typename Function>
+	sparse_builder<Type> assemble(std::size_t rows, std::size_t cols, std::size_t count, Function f,
+								  std::size_t threads = hardware_threads())
+	{
+		std::size_t const blocks = (count + detail::assembly_block - 1) / detail::assembly_block;
+		
+		std::vector<sparse_builder<Type>> parts(blocks, sparse_builder<Type>(rows, cols));
+		
+		parallel_for(blocks, [&](std::size_t b) {
+			for (std::size_t k = b * detail::assembly_block; k < std::min(count, (b + 1) * detail::assembly_block); ++k)
+				f(k, parts[b]);
+		}, threads);
+		
+		sparse_builder<Type> all(rows, cols);
+		std::size_t total = 0;
+		
+		for (auto const & p : parts)
+			total += p.size();
+		
+		all.reserve(total);
+		
+		for (auto const & p : parts)
+			all.append(p);
+		
+		return all;
+	}
+	
+	// ------------------------------------------------------
+	// the same matrix in the other layout
+	
+	template <typename T, bool Rows>
+	compressed_matrix<T, !Rows> relayout(compressed_matrix<T, Rows> const & a) {
+		// the triplets of A^T in the layout of A are A's triplets in the other one
+		std::size_t const major = (Rows ? a.rows() : a.cols()), minor = (Rows ? a.cols() : a.rows());
+		
+		std::vector<std::size_t> offsets(minor + 1, 0);
+		
+		for (auto j : a.indices())
+			++offsets[j + 1];
+		
+		std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+		
+		std::vector<typename compressed_matrix<T, Rows>::index_type> indices(a.nonzeros());
+		std::vector<T> values(a.nonzeros());
+		std::vector<std::size_t> next(offsets.begin(), offsets.end() - 1);
+		
+		// majors in increasing order, so every new row (column) comes out sorted
+		for (std::size_t m = 0; m < major; ++m) {
+			for (std::size_t e = a.offsets()[m]; e < a.offsets()[m + 1]; ++e) {
+				std::size_t const k = next[a.indices()[e]]++;
+				
+				indices[k] = typename compressed_matrix<T, Rows>::index_type(m);
+				values[k] = a.values()[e];
+			}
+		}
+		
+		return compressed_matrix<T, !Rows>(a.rows(), a.cols(), std::move(offsets), std::move(indices), std::move(values));
+	}
+	
+	template <typename T>
+	csr_matrix<T> to_csr(csr_matrix<T> const & a) { return a; }
+	template <typename T>
+	csr_matrix<T> to_csr(csc_matrix<T> const & a) { return relayout(a); }
+	template <typename T>
+	csc_matrix<T> to_csc(csc_matrix<T> const & a) { return a; }
+	template <typename T>
+	csc_matrix<T> to_csc(csr_matrix<T> const & a) { return relayout(a); }
+	
+	template <typename T, bool Rows>
+	compressed_matrix<T, !Rows> transpose(compressed_matrix<T, Rows> const & a) {
+		return a.transpose();
+	}
+	
+	// ------------------------------------------------------
+	// sparse * dense, and A^T * dense
+	
+	template <typename T, bool Rows, typename X, typename = typename std::enable_if<detail::is_dense<X>::value>::type>
+	dmatrix<T> operator*(compressed_matrix<T, Rows> const & a, X const & x) {
+		auto d = detail::data_of(x);
+		
+		detail::check_size(d.r == a.cols(), "Matrix sizes don't match for multiplication.");
+		
+		dmatrix<T> y(a.rows(), d.c);
+		a.multiply(d.p, y.data(), d.c);
+		
+		return y;
+	}
+	
+	template <typename T, bool Rows, typename X, typename = typename std::enable_if<detail::is_dense<X>::value>::type>
+	dmatrix<T> transpose_multiply(compressed_matrix<T, Rows> const & a, X const & x) {
+		auto d = detail::data_of(x);
+		
+		detail::check_size(d.r == a.rows(), "Matrix sizes don't match for multiplication.");
+		
+		dmatrix<T> y(a.cols(), d.c);
+		a.multiply_transposed(d.p, y.data(), d.c);
+		
+		return y;
+	}
+}
+
+#endif
@@ -0,0 +1,335 @@
+//
+//  sparse_grid.h
+//  math
+//
+//  Created by Patrick Sauter on 10/19/26.
+//  Copyright (c) 2026 Patrick Sauter. All rights reserved.
+//
+
+#ifndef math_sparse_grid_h
+#define math_sparse_grid_h
+
+// smolyak sparse grid integration over a math::box using nested clenshaw-curtis rules.
+//
+// with Q(l) the level l clenshaw-curtis rule and d(l) = Q(l) - Q(l-1), the integral is approximated by
+//		sum over multi-indices k in some set K of  d(k1) x d(k2) x ... x d(kN)
+// the classic smolyak grid of level q uses K = { k : |k| <= q + N - 1 }, and the dimension adaptive version
+// (Gerstner and Griebel) grows K one index at a time in whichever direction the last differences were largest.
+//
+// the rules are nested, so the points of Q(l-1) are points of Q(l).  every evaluation is cached by its exact
+// position on the finest possible grid, and a difference term only calls the integrand for points it hasn't seen.
+
+#include <cstdint>
+#include <cmath>
+#include <array>
+#include <vector>
+#include <map>
+#include <set>
+#include <utility>
+#include <algorithm>
+#include <stdexcept>
+
+#include "core.h"
+#include "box.h"
+#include "numeric_integral.h"
+
+namespace math {
+	struct sparse_grid_options {
+		std::size_t		max_level		= 12;					// per axis, level l has 2^(l-1) + 1 points, at most cc_levels
+		std::size_t		max_evaluations	= std::size_t(1) << 20;
+		reals_t			target_error	= 0;
+	};
+	
+	namespace detail {
+		// positions on the clenshaw-curtis grids are stored as integers k, meaning x = (1 - cos(pi k / 2^cc_bits)) / 2
+		// so the same point has the same key on every level.
+		constexpr unsigned cc_bits = 30;
+		
+		// the finest level whose points all have keys, 2^cc_bits + 1 of them
+		constexpr std::size_t cc_levels = cc_bits + 1;
+		
+		inline reals_t cc_point(std::uint32_t key) {
+			return (1 - std::cos(M_PI * reals_t(key) / reals_t(std::uint32_t(1) << cc_bits))) / 2;
+		}
+		
+		// weights of the level l rule on [0, 1], by key.
+		inline std::vector<std::pair<std::uint32_t, reals_t>> cc_rule(std::size_t level) {
+			if (level < 1 || level > cc_levels)
+				throw std::invalid_argument("Sparse grid level out of range.");
+			
+			if (level == 1)
+				return { { std::uint32_t(1) << (cc_bits - 1), reals_t(1) } };
+			
+			std::size_t const n = std::size_t(1) << (level - 1);		// intervals, so n + 1 points
+			std::uint32_t const spacing = std::uint32_t(1) << (cc_bits - (level - 1));
+			
+			std::vector<std::pair<std::uint32_t, reals_t>> rule(n + 1);
+			
+			for (std::size_t j = 0; j <= n; ++j) {
+				reals_t s = 0;
+				
+				for (std::size_t k = 1; k <= n / 2; ++k) {
+					reals_t b = (2 * k == n ? 1 : 2);
+					
+					s += b / reals_t(4 * k * k - 1) * std::cos(2 * M_PI * reals_t(j * k) / reals_t(n));
+				}
+				
+				reals_t c = (j == 0 || j == n ? 1 : 2);
+				
+				// the formula is for [-1, 1], halve it for the unit interval
+				rule[j] = { std::uint32_t(j) * spacing, c / reals_t(n) * (1 - s) / 2 };
+			}
+			
+			return rule;
+		}
+		
+		// weights of d(l) = Q(l) - Q(l-1), by key, zeros dropped.
+		inline std::vector<std::pair<std::uint32_t, reals_t>> cc_difference(std::size_t level) {
+			auto rule = cc_rule(level);
+			
+			if (level > 1) {
+				for (auto const & p : cc_rule(level - 1)) {
+					auto i = std::lower_bound(rule.begin(), rule.end(), p, [](decltype(p) a, decltype(p) b) {
+						return a.first < b.first;
+					});
+					
+					i->second -= p.second;
+				}
+			}
+			
+			rule.erase(std::remove_if(rule.begin(), rule.end(), [](decltype(rule.front()) p) {
+				return p.second == 0;
+			}), rule.end());
+			
+			return rule;
+		}
+	}
+	
+	// evaluates smolyak difference terms of a function over a box, remembering every sample.
+	template <typename Function, typename Vector>
+	class sparse_grid {
+	public:
+		typedef Vector										vector_type;
+		typedef decltype(std::declval<Function>()(std::declval<Vector>())) result_type;
+		
+		static constexpr std::size_t dimension = vector_type::rows();
+		
+		typedef std::array<std::size_t, dimension>			index_type;
+		
+		static_assert(check::vector_space<result_type, reals_t>::value,
+					  "Assertion failed, return type not a vector space over the reals.");
+		
+		sparse_grid(Function f, box<Vector> region) : _f(std::move(f)), _box(std::move(region)) { }
+		
+		// the tensor product of the one dimensional difference rules d(k[0]) x ... x d(k[N-1])
+		result_type difference(index_type const & k) {
+			std::array<std::vector<std::pair<std::uint32_t, reals_t>> const *, dimension> rules;
+			
+			// build the finest rule first, building one can move the others
+			rule(*std::max_element(k.begin(), k.end()));
+			
+			for (std::size_t i = 0; i < dimension; ++i)
+				rules[i] = &rule(k[i]);
+			
+			std::array<std::size_t, dimension> j{};
+			std::array<std::uint32_t, dimension> key;
+			
+			result_type sum{};
+			
+			while (true) {
+				reals_t w = 1;
+				
+				for (std::size_t i = 0; i < dimension; ++i) {
+					auto const & p = (*rules[i])[j[i]];
+					
+					key[i] = p.first;
+					w *= p.second;
+				}
+				
+				sum += sample(key) * w;
+				
+				// odometer over all the tensor product points
+				std::size_t i = 0;
+				
+				for (; i < dimension && ++j[i] == rules[i]->size(); ++i)
+					j[i] = 0;
+				
+				if (i == dimension)
+					break;
+			}
+			
+			return sum * detail::volume(_box);
+		}
+		
+		// number of distinct points the function has been evaluated at.
+		std::size_t evaluations() const { return _cache.size(); }
+	private:
+		result_type sample(std::array<std::uint32_t, dimension> const & key) {
+			auto i = _cache.find(key);
+			
+			if (i != _cache.end())
+				return i->second;
+			
+			auto value = _f(detail::unit_to_box(_box, [&](std::size_t d) { return detail::cc_point(key[d]); }));
+			
+			_cache.emplace(key, value);
+			
+			return value;
+		}
+		
+		std::vector<std::pair<std::uint32_t, reals_t>> const & rule(std::size_t level) {
+			while (_rules.size() < level)
+				_rules.push_back(detail::cc_difference(_rules.size() + 1));
+			
+			return _rules[level - 1];
+		}
+		
+		Function		_f;
+		box<Vector>		_box;
+		
+		std::map<std::array<std::uint32_t, dimension>, result_type>	_cache;
+		std::vector<std::vector<std::pair<std::uint32_t, reals_t>>>	_rules;
+	};
+	
+	template <typename Function, typename Vector>
+	sparse_grid<Function, Vector> make_sparse_grid(Function f, box<Vector> region) {
+		return sparse_grid<Function, Vector>(std::move(f), std::move(region));
+	}
+	
+	
+	
+	
+	// classic smolyak integral of the given level (level 1 is the single center point).
+	// the error is the size of the last layer of difference terms, a rough but usually pessimistic estimate.
+	template <typename Function, typename Vector>
+	auto smolyak_integral(Function f, box<Vector> const & region, std::size_t level)
+		-> integral_estimate<typename sparse_grid<Function, Vector>::result_type>
+	{
+		typedef sparse_grid<Function, Vector>	grid_t;
+		typedef typename grid_t::result_type	result_t;
+		typedef typename grid_t::index_type		index_t;
+		
+		constexpr std::size_t N = grid_t::dimension;
+		
+		if (level < 1 || level > detail::cc_levels)
+			throw std::invalid_argument("Sparse grid level out of range.");
+		
+		grid_t grid(std::move(f), region);
+		
+		result_t	sum{};
+		result_t	top{};
+		
+		// all k >= 1 with |k| <= level + N - 1, each component bounded by the level.
+		index_t k;
+		k.fill(1);
+		
+		while (true) {
+			std::size_t total = 0;
+			
+			for (auto i : k)
+				total += i;
+			
+			auto delta = grid.difference(k);
+			
+			sum += delta;
+			
+			if (total == level + N - 1)
+				top += delta;
+			
+			// next index in the simplex
+			std::size_t i = 0;
+			
+			for (; i < N; ++i) {
+				if (total < level + N - 1) {
+					++k[i];
+					break;
+				}
+				
+				total -= k[i] - 1;
+				k[i] = 1;
+			}
+			
+			if (i == N)
+				break;
+		}
+		
+		return { sum, std::sqrt(detail::magnitude2(top)), grid.evaluations() };
+	}
+	
+	
+	// dimension adaptive sparse grid integral.
+	// indices are added next to whichever active index has the largest difference term, so axes the integrand
+	// barely depends on stay at low levels.  the error is the sum of the active difference terms.
+	template <typename Function, typename Vector>
+	auto adaptive_sparse_integral(Function f, box<Vector> const & region, sparse_grid_options const & options = {})
+		-> integral_estimate<typename sparse_grid<Function, Vector>::result_type>
+	{
+		typedef sparse_grid<Function, Vector>	grid_t;
+		typedef typename grid_t::result_type	result_t;
+		typedef typename grid_t::index_type		index_t;
+		
+		constexpr std::size_t N = grid_t::dimension;
+		
+		grid_t grid(std::move(f), region);
+		
+		std::set<index_t>						old;
+		std::map<index_t, result_t>				active;
+		
+		index_t first;
+		first.fill(1);
+		
+		active.emplace(first, grid.difference(first));
+		
+		result_t sum = active.begin()->second;
+		
+		auto error = [&]() {
+			reals_t e = 0;
+			
+			for (auto const & a : active)
+				e += std::sqrt(detail::magnitude2(a.second));
+			
+			return e;
+		};
+		
+		while (!active.empty() && error() > options.target_error && grid.evaluations() < options.max_evaluations) {
+			auto largest = std::max_element(active.begin(), active.end(), [](decltype(*active.begin()) a, decltype(*active.begin()) b) {
+				return detail::magnitude2(a.second) < detail::magnitude2(b.second);
+			});
+			
+			index_t k = largest->first;
+			
+			active.erase(largest);
+			old.insert(k);
+			
+			for (std::size_t i = 0; i < N; ++i) {
+				index_t next = k;
+				
+				if (++next[i] > std::min(options.max_level, detail::cc_levels))
+					continue;
+				
+				// admissible only if every backward neighbour is already finished
+				bool admissible = true;
+				
+				for (std::size_t j = 0; j < N && admissible; ++j) {
+					if (next[j] > 1) {
+						index_t back = next;
+						--back[j];
+						
+						admissible = old.count(back) > 0;
+					}
+				}
+				
+				if (admissible) {
+					auto delta = grid.difference(next);
+					
+					sum += delta;
+					active.emplace(next, delta);
+				}
+			}
+		}
+		
+		return { sum, error(), grid.evaluations() };
+	}
+}
+
+#endif
@@ -0,0 +1,723 @@
+//
+//  svd.h
+//  math
+//
+//  Created by Patrick Sauter on 10/19/26.
+//  Copyright (c) 2026 Patrick Sauter. All rights reserved.
+//
+
+#ifndef math_svd_h
+#define math_svd_h
+
+// singular value decomposition of an m x n matrix, A = U diag(s) V^H, thin, so with k = min(m, n) U is m x k, V is
+// n x k and s holds k values, largest first.
+//
+//		auto f = svd(A);
+//		f.values();  f.u();  f.v();
+//		f.rank();
+//		svd(A, false);				// the values alone
+//		singular_values(A);			// the same in one go
+//
+// fixed size matrices go by one sided jacobi, rotating pairs of columns of A until they're orthogonal.  there's
+// nothing to set up, every rotation is a handful of short loops the compiler unrolls, and the small singular values
+// come out to high relative accuracy.
+//
+// dmatrix goes by golub-kahan, householder reflections from both sides take A to a real bidiagonal B (the phases of
+// complex entries scaled into U and V), then implicit shifted QR on B.  the values alone skip building U and V and
+// every rotation along them, which is most of the work for a large matrix.  when m < n the same is done to A^H.
+//
+// U and V for fixed size A are fixed size too, matrix<T,N,K> and matrix<T,M,K>.  without vectors they're left zero.
+
+#include <cmath>
+#include <limits>
+#include <vector>
+#include <complex>
+#include <utility>
+#include <numeric>
+#include <algorithm>
+#include <type_traits>
+
+#include "core.h"
+#include "exceptions.h"
+#include "lu.h"
+#include "qr.h"
+
+namespace math {
+	namespace detail {
+		// sweeps of jacobi, and QR steps of golub-kahan per singular value, before giving up
+		constexpr std::size_t jacobi_sweeps = 60;
+		constexpr std::size_t svd_iterations = 75;
+		
+		// U and V of an m x n matrix
+		template <typename Matrix>
+		struct singular;
+		
+		template <typename T, std::size_t N, std::size_t M>
+		struct singular<matrix<T,N,M>> {
+			static constexpr std::size_t K = (N < M ? N : M);
+			
+			typedef T					value_type;
+			typedef matrix<T,N,K>		u_type;
+			typedef matrix<T,M,K>		v_type;
+			
+			static u_type make_u(std::size_t, std::size_t) { return u_type(T(math::additive_identity)); }
+			static v_type make_v(std::size_t, std::size_t) { return v_type(T(math::additive_identity)); }
+		};
+		
+		template <typename T>
+		struct singular<dmatrix<T>> {
+			typedef T					value_type;
+			typedef dmatrix<T>			u_type;
+			typedef dmatrix<T>			v_type;
+			
+			static u_type make_u(std::size_t m, std::size_t k) { return u_type(m, k, T(math::additive_identity)); }
+			static v_type make_v(std::size_t n, std::size_t k) { return v_type(n, k, T(math::additive_identity)); }
+		};
+		
+		// fills the zero rows of the k x m matrix at x, k <= m, with unit vectors orthogonal to the rest, for the
+		// singular vectors of zero singular values
+		template <typename T>
+		void complete_rows(T * x, std::size_t k, std::size_t m) {
+			typedef real_part_t<T> R;
+			
+			T const zero = T(math::additive_identity);
+			
+			for (std::size_t i = 0; i < k; ++i) {
+				R length = 0;
+				
+				for (std::size_t c = 0; c < m; ++c)
+					length += abs2(x[i * m + c]);
+				
+				if (length > R(0))
+					continue;
+				
+				// the unit vector least in the span of the others, twice gram-schmidt
+				for (std::size_t e = 0; e < m && length < R(0.5); ++e) {
+					T * r = x + i * m;
+					
+					std::fill(r, r + m, zero);
+					r[e] = T(math::multiplicative_identity);
+					
+					for (std::size_t pass = 0; pass < 2; ++pass) {
+						for (std::size_t j = 0; j < k; ++j) {
+							if (j == i)
+								continue;
+							
+							T dot = zero;
+							
+							for (std::size_t c = 0; c < m; ++c)
+								dot = dot + conjugate(x[j * m + c]) * r[c];
+							
+							for (std::size_t c = 0; c < m; ++c)
+								r[c] = r[c] - dot * x[j * m + c];
+						}
+					}
+					
+					length = 0;
+					
+					for (std::size_t c = 0; c < m; ++c)
+						length += abs2(r[c]);
+				}
+				
+				T const scale = T(R(1) / std::sqrt(length));
+				
+				for (std::size_t c = 0; c < m; ++c)
+					x[i * m + c] = x[i * m + c] * scale;
+			}
+		}
+		
+		// one sided jacobi on the k vectors of length m in the rows of g, k <= m.  w gets the row lengths, the rows
+		// end up orthogonal, and the same rotations go along the rows of v, length k, when v isn't null
+		template <typename T>
+		void jacobi(T * g, std::size_t k, std::size_t m, T * v, real_part_t<T> * w) {
+			typedef real_part_t<T> R;
+			
+			R const eps = std::numeric_limits<R>::epsilon();
+			T const zero = T(math::additive_identity);
+			
+			// rows shorter than eps |G|_F are zero as far as the rest can tell, and rotating them never settles.  the
+			// rotations keep |G|_F, so it's worked out once
+			R frobenius = 0;
+			
+			for (std::size_t i = 0; i < k * m; ++i)
+				frobenius += abs2(g[i]);
+			
+			R const negligible = eps * eps * frobenius;
+			
+			for (std::size_t sweep = 0; ; ++sweep) {
+				bool rotated = false;
+				
+				for (std::size_t p = 0; p + 1 < k; ++p) {
+					for (std::size_t q = p + 1; q < k; ++q) {
+						T * x = g + p * m;
+						T * y = g + q * m;
+						
+						R alpha = 0, beta = 0;
+						T gamma = zero;
+						
+						for (std::size_t c = 0; c < m; ++c) {
+							alpha += abs2(x[c]);
+							beta += abs2(y[c]);
+							gamma = gamma + conjugate(x[c]) * y[c];
+						}
+						
+						R const size = std::sqrt(abs2(gamma));
+						
+						if (size <= eps * std::sqrt(alpha * beta) || size == R(0) || alpha <= negligible || beta <= negligible)
+							continue;
+						
+						rotated = true;
+						
+						// turn y by the phase of gamma so x^H y is real, then a plane rotation zeroing it
+						T const phase = gamma / T(size);
+						R const zeta = (beta - alpha) / (R(2) * size);
+						R const t = (zeta < 0 ? R(-1) : R(1)) / (std::abs(zeta) + std::sqrt(R(1) + zeta * zeta));
+						R const c = R(1) / std::sqrt(R(1) + t * t), s = c * t;
+						
+						T const cs = T(c), sp = T(s) * conjugate(phase), cp = T(c) * conjugate(phase);
+						
+						for (std::size_t i = 0; i < m; ++i) {
+							T const a = x[i], b = y[i];
+							
+							x[i] = cs * a - sp * b;
+							y[i] = T(s) * a + cp * b;
+						}
+						
+						if (v) {
+							T * vx = v + p * k;
+							T * vy = v + q * k;
+							
+							for (std::size_t i = 0; i < k; ++i) {
+								T const a = vx[i], b = vy[i];
+								
+								vx[i] = cs * a - sp * b;
+								vy[i] = T(s) * a + cp * b;
+							}
+						}
+					}
+				}
+				
+				if (!rotated)
+					break;
+				
+				if (sweep == jacobi_sweeps)
+					throw math::not_converged();
+			}
+			
+			// the negligible rows go to zero, so their singular vectors are completed rather than read off noise
+			for (std::size_t p = 0; p < k; ++p) {
+				R length = 0;
+				
+				for (std::size_t c = 0; c < m; ++c)
+					length += abs2(g[p * m + c]);
+				
+				if (length <= negligible) {
+					std::fill(g + p * m, g + p * m + m, zero);
+					length = 0;
+				}
+				
+				w[p] = std::sqrt(length);
+			}
+		}
+		
+		// the real bidiagonal d, e of the m x n matrix at a, m >= n, U^H A V = B.  the left reflections stay below the
+		// diagonal with their tau in left, the right ones to the right of the superdiagonal with theirs in right, and
+		// uphase, vphase are the unit scalings of the columns of U and V that made B real
+		template <typename T>
+		void bidiagonalize(T * a, std::size_t m, std::size_t n, real_part_t<T> * d, real_part_t<T> * e,
+						   T * left, T * right, T * uphase, T * vphase)
+		{
+			typedef real_part_t<T> R;
+			
+			T const zero = T(math::additive_identity), one = T(math::multiplicative_identity);
+			
+			std::vector<T> w(n);
+			
+			for (std::size_t k = 0; k < n; ++k) {
+				// column k from the diagonal down
+				left[k] = householder(a, m, n, k);
+				reflect(a, m, n, k, left[k], a, n, k + 1, n - k - 1, w.data());
+				
+				right[k] = zero;
+				
+				if (k + 1 >= n)
+					continue;
+				
+				// row k right of the diagonal, A G = B with G^H conj(row) = (beta, 0, ..., 0).  the row is one column
+				// of length n - k - 1 to householder
+				T * r = a + k * n + k + 1;
+				std::size_t const length = n - k - 1;
+				
+				for (std::size_t j = 0; j < length; ++j)
+					r[j] = conjugate(r[j]);
+				
+				T const t = right[k] = householder(r, length, 1, 0);
+				
+				if (t == zero)
+					continue;
+				
+				// rows below, x G = x - tau (x u) u^H
+				for (std::size_t i = k + 1; i < m; ++i) {
+					T * x = a + i * n + k + 1;
+					T s = x[0];
+					
+					for (std::size_t j = 1; j < length; ++j)
+						s = s + x[j] * r[j];
+					
+					s = s * t;
+					x[0] = x[0] - s;
+					
+					for (std::size_t j = 1; j < length; ++j)
+						x[j] = x[j] - s * conjugate(r[j]);
+				}
+			}
+			
+			// P^H B Q real, row and column phases in turn down the diagonal
+			if (n > 0)
+				vphase[0] = one;
+			
+			for (std::size_t k = 0; k < n; ++k) {
+				T const dk = a[k * n + k] * vphase[k];
+				R const lk = std::sqrt(abs2(dk));
+				
+				uphase[k] = (lk == R(0) ? one : dk / T(lk));
+				d[k] = lk;
+				
+				if (k + 1 < n) {
+					T const ek = conjugate(uphase[k]) * a[k * n + k + 1];
+					R const le = std::sqrt(abs2(ek));
+					
+					e[k] = le;
+					vphase[k + 1] = (le == R(0) ? one : conjugate(ek / T(le)));
+				} else
+					e[k] = 0;
+			}
+		}
+		
+		// U = H_0 ... H_n-1 [I; 0] and V = G_0 ... G_n-2, each times its phases, into the m x n u and n x n v
+		template <typename T>
+		void bidiagonal_back(T const * a, std::size_t m, std::size_t n, T const * left, T const * right,
+							 T const * uphase, T const * vphase, T * u, T * v)
+		{
+			T const zero = T(math::additive_identity);
+			
+			std::vector<T> w(n);
+			
+			if (u) {
+				for (std::size_t i = 0; i < n; ++i)
+					u[i * n + i] = uphase[i];
+				
+				for (std::size_t k = n; k-- > 0; )
+					reflect(a, m, n, k, conjugate(left[k]), u, n, k, n - k, w.data());
+			}
+			
+			if (v) {
+				for (std::size_t i = 0; i < n; ++i)
+					v[i * n + i] = vphase[i];
+				
+				// G_k = I - tau u u^H on rows k + 1 on, u is row k of a right of the superdiagonal.  w = u^H V a row at
+				// a time, then V -= tau u w
+				for (std::size_t k = (n < 2 ? 0 : n - 1); k-- > 0; ) {
+					T const t = right[k];
+					
+					if (t == zero)
+						continue;
+					
+					T const * r = a + k * n + k + 1;
+					std::size_t const length = n - k - 1, first = k + 1;
+					
+					std::copy(v + first * n + first, v + first * n + n, w.begin());
+					
+					for (std::size_t j = 1; j < length; ++j) {
+						T const u = conjugate(r[j]);
+						T const * x = v + (first + j) * n + first;
+						
+						for (std::size_t c = 0; c < length; ++c)
+							w[c] = w[c] + u * x[c];
+					}
+					
+					for (std::size_t j = 0; j < length; ++j) {
+						T const u = t * (j == 0 ? T(math::multiplicative_identity) : r[j]);
+						T * x = v + (first + j) * n + first;
+						
+						for (std::size_t c = 0; c < length; ++c)
+							x[c] = x[c] - u * w[c];
+					}
+				}
+			}
+		}
+		
+		// the singular values of the real bidiagonal d, e, n long with e[n - 1] = 0, by implicit shifted QR, left in
+		// d.  the rotations go along the rows of ut (n x m) and vt (n x n) when they aren't null, U^T and V^T
+		template <typename R, typename T>
+		void bidiagonal_qr(R * s, R * e, std::ptrdiff_t n, T * ut, std::ptrdiff_t m, T * vt) {
+			R const eps = std::numeric_limits<R>::epsilon();
+			R const tiny = std::numeric_limits<R>::min() / eps;
+			
+			auto rotate = [](T * z, std::ptrdiff_t cols, std::ptrdiff_t i, std::ptrdiff_t j, R c, R s) {
+				if (!z)
+					return;
+				
+				T * x = z + i * cols;
+				T * y = z + j * cols;
+				
+				for (std::ptrdiff_t k = 0; k < cols; ++k) {
+					T const t = T(c) * x[k] + T(s) * y[k];
+					
+					y[k] = T(c) * y[k] - T(s) * x[k];
+					x[k] = t;
+				}
+			};
+			
+			std::ptrdiff_t p = n;
+			std::size_t iterations = 0;
+			
+			while (p > 0) {
+				// e[k] negligible for the largest k < p - 1, and which case that leaves
+				std::ptrdiff_t k = p - 2;
+				
+				for (; k >= 0; --k) {
+					if (std::abs(e[k]) <= tiny + eps * (std::abs(s[k]) + std::abs(s[k + 1]))) {
+						e[k] = 0;
+						break;
+					}
+				}
+				
+				int kind;
+				
+				if (k == p - 2)
+					kind = 4;
+				else {
+					std::ptrdiff_t ks = p - 1;
+					
+					for (; ks > k; --ks) {
+						R const t = (ks != p ? std::abs(e[ks]) : R(0)) + (ks != k + 1 ? std::abs(e[ks - 1]) : R(0));
+						
+						if (std::abs(s[ks]) <= tiny + eps * t) {
+							s[ks] = 0;
+							break;
+						}
+					}
+					
+					if (ks == k)
+						kind = 3;
+					else if (ks == p - 1)
+						kind = 1;
+					else {
+						kind = 2;
+						k = ks;
+					}
+				}
+				
+				++k;
+				
+				switch (kind) {
+				// s[p - 1] is zero, chase e[p - 2] out through the columns
+				case 1: {
+					R f = e[p - 2];
+					
+					e[p - 2] = 0;
+					
+					for (std::ptrdiff_t j = p - 2; j >= k; --j) {
+						R const t = std::hypot(s[j], f), c = s[j] / t, sn = f / t;
+						
+						s[j] = t;
+						
+						if (j != k) {
+							f = -sn * e[j - 1];
+							e[j - 1] = c * e[j - 1];
+						}
+						
+						rotate(vt, n, j, p - 1, c, sn);
+					}
+				} break;
+				
+				// s[k - 1] is zero, chase e[k - 1] out through the rows
+				case 2: {
+					R f = e[k - 1];
+					
+					e[k - 1] = 0;
+					
+					for (std::ptrdiff_t j = k; j < p; ++j) {
+						R const t = std::hypot(s[j], f), c = s[j] / t, sn = f / t;
+						
+						s[j] = t;
+						f = -sn * e[j];
+						e[j] = c * e[j];
+						
+						rotate(ut, m, j, k - 1, c, sn);
+					}
+				} break;
+				
+				// a QR step on k .. p - 1, shifted by the eigenvalue of the trailing 2 x 2 of B^T B closer to its corner
+				case 3: {
+					if (++iterations > svd_iterations * std::size_t(n))
+						throw math::not_converged();
+					
+					R const scale = std::max({ std::abs(s[p - 1]), std::abs(s[p - 2]), std::abs(e[p - 2]), std::abs(s[k]), std::abs(e[k]) });
+					R const sp = s[p - 1] / scale, spm1 = s[p - 2] / scale, epm1 = e[p - 2] / scale;
+					R const sk = s[k] / scale, ek = e[k] / scale;
+					R const b = ((spm1 + sp) * (spm1 - sp) + epm1 * epm1) / R(2), c = (sp * epm1) * (sp * epm1);
+					
+					R shift = 0;
+					
+					if (b != R(0) || c != R(0)) {
+						shift = std::sqrt(b * b + c);
+						shift = c / (b + (b < 0 ? -shift : shift));
+					}
+					
+					R f = (sk + sp) * (sk - sp) + shift, g = sk * ek;
+					
+					for (std::ptrdiff_t j = k; j < p - 1; ++j) {
+						R t = std::hypot(f, g), cs = f / t, sn = g / t;
+						
+						if (j != k)
+							e[j - 1] = t;
+						
+						f = cs * s[j] + sn * e[j];
+						e[j] = cs * e[j] - sn * s[j];
+						g = sn * s[j + 1];
+						s[j + 1] = cs * s[j + 1];
+						
+						rotate(vt, n, j, j + 1, cs, sn);
+						
+						t = std::hypot(f, g);
+						cs = f / t;
+						sn = g / t;
+						s[j] = t;
+						f = cs * e[j] + sn * s[j + 1];
+						s[j + 1] = -sn * e[j] + cs * s[j + 1];
+						g = sn * e[j + 1];
+						e[j + 1] = cs * e[j + 1];
+						
+						rotate(ut, m, j, j + 1, cs, sn);
+					}
+					
+					e[p - 2] = f;
+				} break;
+				
+				// s[k] has converged, make it positive
+				case 4: {
+					if (s[k] <= 0) {
+						s[k] = (s[k] < 0 ? -s[k] : R(0));
+						
+						if (vt) {
+							for (std::ptrdiff_t i = 0; i < n; ++i)
+								vt[k * n + i] = -vt[k * n + i];
+						}
+					}
+					
+					--p;
+				} break;
+				}
+			}
+		}
+		
+		// the order of the singular values in s, largest first
+		template <typename R>
+		std::vector<std::size_t> descending(R const * s, std::size_t k) {
+			std::vector<std::size_t> order(k);
+			std::iota(order.begin(), order.end(), 0);
+			std::stable_sort(order.begin(), order.end(), [&](std::size_t i, std::size_t j) { return s[i] > s[j]; });
+			
+			return order;
+		}
+	}
+	
+	template <typename Matrix>
+	class svd_decomposition {
+	public:
+		typedef detail::singular<Matrix>				shape;
+		typedef typename shape::value_type				value_type;
+		typedef detail::real_part_t<value_type>			real_type;
+		typedef typename shape::u_type					u_type;
+		typedef typename shape::v_type					v_type;
+		
+		static_assert(check::field<value_type>::value,
+					  "Assertion failed, SVD needs a matrix over a field.");
+		
+		svd_decomposition(Matrix a, bool vectors) : _m(a.rows()), _n(a.cols()), _has_vectors(vectors),
+			_u(shape::make_u(_m, std::min(_m, _n))), _v(shape::make_v(_n, std::min(_m, _n)))
+		{
+			factor(a, is_fixed<Matrix>{});
+		}
+		
+		std::size_t rows() const { return _m; }
+		std::size_t cols() const { return _n; }
+		bool has_vectors() const { return _has_vectors; }
+		
+		// largest first
+		std::vector<real_type> const & values() const { return _s; }
+		
+		// orthonormal columns, column j of each for values()[j]
+		u_type const & u() const { return _u; }
+		v_type const & v() const { return _v; }
+		
+		// singular values above tolerance, by default max(m, n) epsilon s_0
+		std::size_t rank(real_type tolerance = -1) const {
+			if (_s.empty())
+				return 0;
+			
+			if (tolerance < 0)
+				tolerance = real_type(std::max(_m, _n)) * std::numeric_limits<real_type>::epsilon() * _s[0];
+			
+			return std::size_t(std::count_if(_s.begin(), _s.end(), [&](real_type x) { return x > tolerance; }));
+		}
+	private:
+		template <typename X>
+		struct is_fixed : std::false_type { };
+		template <typename T, std::size_t N, std::size_t M>
+		struct is_fixed<matrix<T,N,M>> : std::true_type { };
+		
+		// A (or A^H when it's wide) in the rows of g as m' vectors of length k', the columns of the tall one
+		std::vector<value_type> columns(Matrix const & a, bool wide) const {
+			std::size_t const k = std::min(_m, _n), m = std::max(_m, _n);
+			std::vector<value_type> g(k * m);
+			
+			for (std::size_t i = 0; i < _m; ++i)
+				for (std::size_t j = 0; j < _n; ++j) {
+					if (wide)
+						g[i * m + j] = a.data()[i * _n + j];
+					else
+						g[j * m + i] = a.data()[i * _n + j];
+				}
+			
+			return g;
+		}
+		
+		// U^T as k rows of length m_u and V^T as k rows of length n_v, sorted by order, into u and v
+		void finish(std::vector<value_type> const & ut, std::vector<value_type> const & vt, std::vector<real_type> const & s,
+					std::vector<std::size_t> const & order, bool wide)
+		{
+			std::size_t const k = order.size();
+			
+			_s.resize(k);
+			
+			for (std::size_t j = 0; j < k; ++j)
+				_s[j] = s[order[j]];
+			
+			if (!_has_vectors)
+				return;
+			
+			// for A^H the roles of U and V swap, and conjugating both leaves U S V^H alone
+			value_type const * x = (wide ? vt : ut).data();
+			value_type const * y = (wide ? ut : vt).data();
+			
+			for (std::size_t i = 0; i < _m; ++i)
+				for (std::size_t j = 0; j < k; ++j)
+					_u.data()[i * k + j] = (wide ? detail::conjugate(x[order[j] * _m + i]) : x[order[j] * _m + i]);
+			
+			for (std::size_t i = 0; i < _n; ++i)
+				for (std::size_t j = 0; j < k; ++j)
+					_v.data()[i * k + j] = (wide ? detail::conjugate(y[order[j] * _n + i]) : y[order[j] * _n + i]);
+		}
+		
+		// one sided jacobi on the columns of the tall one of A and A^H
+		void factor(Matrix const & a, std::true_type) {
+			bool const wide = _m < _n;
+			std::size_t const k = std::min(_m, _n), m = std::max(_m, _n);
+			
+			std::vector<value_type> g = columns(a, wide), vt(_has_vectors ? k * k : 0);
+			std::vector<real_type> s(k);
+			
+			for (std::size_t i = 0; i < vt.size(); i += k + 1)
+				vt[i] = value_type(math::multiplicative_identity);
+			
+			detail::jacobi(g.data(), k, m, (_has_vectors ? vt.data() : nullptr), s.data());
+			
+			// the columns of U are the columns over their lengths
+			if (_has_vectors) {
+				for (std::size_t j = 0; j < k; ++j) {
+					if (s[j] == real_type(0)) {
+						std::fill(g.begin() + j * m, g.begin() + j * m + m, value_type(math::additive_identity));
+						continue;
+					}
+					
+					value_type const scale = value_type(real_type(1) / s[j]);
+					
+					for (std::size_t c = 0; c < m; ++c)
+						g[j * m + c] = g[j * m + c] * scale;
+				}
+				
+				detail::complete_rows(g.data(), k, m);
+			}
+			
+			finish(g, vt, s, detail::descending(s.data(), k), wide);
+		}
+		
+		// golub-kahan on the tall one of A and A^H
+		void factor(Matrix const & a, std::false_type) {
+			bool const wide = _m < _n;
+			std::size_t const k = std::min(_m, _n), m = std::max(_m, _n);
+			
+			std::vector<value_type> b(m * k);
+			
+			for (std::size_t i = 0; i < _m; ++i)
+				for (std::size_t j = 0; j < _n; ++j) {
+					if (wide)
+						b[j * k + i] = detail::conjugate(a.data()[i * _n + j]);
+					else
+						b[i * k + j] = a.data()[i * _n + j];
+				}
+			
+			std::vector<real_type> s(k), e(k);
+			std::vector<value_type> left(k), right(k), uphase(k), vphase(k);
+			
+			detail::bidiagonalize(b.data(), m, k, s.data(), e.data(), left.data(), right.data(), uphase.data(), vphase.data());
+			
+			std::vector<value_type> u, v, ut, vt;
+			
+			if (_has_vectors) {
+				u.assign(m * k, value_type(math::additive_identity));
+				v.assign(k * k, value_type(math::additive_identity));
+				
+				detail::bidiagonal_back(b.data(), m, k, left.data(), right.data(), uphase.data(), vphase.data(), u.data(), v.data());
+				
+				// transposed so the rotations run along rows
+				ut.resize(k * m);
+				vt.resize(k * k);
+				
+				for (std::size_t i = 0; i < m; ++i)
+					for (std::size_t j = 0; j < k; ++j)
+						ut[j * m + i] = u[i * k + j];
+				
+				for (std::size_t i = 0; i < k; ++i)
+					for (std::size_t j = 0; j < k; ++j)
+						vt[j * k + i] = v[i * k + j];
+			}
+			
+			detail::bidiagonal_qr(s.data(), e.data(), std::ptrdiff_t(k), (_has_vectors ? ut.data() : nullptr), std::ptrdiff_t(m),
+								  (_has_vectors ? vt.data() : nullptr));
+			
+			// finish conjugates the wide case, which undoes the conjugate on the way in
+			if (wide) {
+				for (auto & x : ut)
+					x = detail::conjugate(x);
+				
+				for (auto & x : vt)
+					x = detail::conjugate(x);
+			}
+			
+			finish(ut, vt, s, detail::descending(s.data(), k), wide);
+		}
+		
+		std::size_t				_m, _n;
+		bool					_has_vectors;
+		std::vector<real_type>	_s;
+		u_type					_u;
+		v_type					_v;
+	};
+	
+	template <typename Matrix>
+	svd_decomposition<typename std::decay<Matrix>::type> svd(Matrix && a, bool vectors = true) {
+		return svd_decomposition<typename std::decay<Matrix>::type>(std::forward<Matrix>(a), vectors);
+	}
+	
+	// just the singular values, largest first
+	template <typename Matrix>
+	auto singular_values(Matrix && a) {
+		return svd(std::forward<Matrix>(a), false).values();
+	}
+}
+
+#endif
@@ -0,0 +1,194 @@
+//
+//  symmetric_integral.h
+//  math
+//
+//  Created by Patrick Sauter on 10/19/26.
+//  Copyright (c) 2026 Patrick Sauter. All rights reserved.
+//
+
+#ifndef math_symmetric_integral_h
+#define math_symmetric_integral_h
+
+// integrals of functions on the plane that are invariant under the dihedral group D2<N>, over regions with the same
+// symmetry.  the region is the union of 2N copies of a fundamental domain, so only that domain is integrated and the
+// result multiplied by 2N.  that's 2N times fewer evaluations for the same accuracy.
+//
+// D2<N> acts on the plane by the reflection y -> -y (when s is set) followed by the rotation by 2 pi r / N, so the
+// fundamental domains are wedges between the angles 0 and pi / N.  two kinds,
+//	- sector, r in [r0, r1] for a disk or annulus, integrated on a polar grid
+//	- a triangle, for regular polygons, polygon_wedge<N> gives the one for a polygon centered on the origin, and
+//	  [-a, a]^2 is the polygon_wedge<4>(a sqrt(2), false).  it is split into n^2 smaller triangles for mesh_integral
+//
+// symmetry_options::check_points > 0 samples that many points of the domain and compares f at every image under the
+// group, throwing math::not_invariant if they differ, since a wrong symmetry silently gives a wrong answer.
+
+#include <cmath>
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+
+#include "core.h"
+#include "exceptions.h"
+#include "dihedral.h"
+#include "box.h"
+#include "simplex.h"
+#include "mesh.h"
+#include "monte_carlo.h"
+#include "product_measure.h"
+
+namespace math {
+	namespace groups {
+		template <int N>
+		constexpr std::size_t order(D2<N> const &) { return 2 * N; }
+		
+		// every element of the group
+		template <int N>
+		std::vector<D2<N>> elements(D2<N> const &) {
+			std::vector<D2<N>> g;
+			
+			for (int s = 0; s < 2; ++s)
+				for (int r = 0; r < N; ++r)
+					g.emplace_back(s != 0, r);
+			
+			return g;
+		}
+		
+		// the action on the plane, reflect in the x axis if s then rotate by r steps of 2 pi / N
+		template <int N, typename T>
+		vector<T, 2> act(D2<N> const & g, vector<T, 2> const & x) {
+			reals_t angle = 2 * M_PI * g.get_r() / N;
+			reals_t c = std::cos(angle), s = std::sin(angle);
+			
+			T y = (g.get_s() ? -x[1] : x[1]);
+			
+			return { T(c * x[0] - s * y), T(s * x[0] + c * y) };
+		}
+	}
+	
+	struct symmetry_options {
+		std::size_t		check_points	= 0;		// points to test the invariance at, 0 to trust the caller
+		reals_t			tolerance		= 1e-10;	// relative to the size of f
+		std::uint64_t	seed			= 0;
+	};
+	
+	// the wedge r0 <= r <= r1, 0 <= theta <= pi / N of a disk or annulus
+	struct sector {
+		reals_t		r0, r1;
+	};
+	
+	// the fundamental triangle of the regular N-gon with circumradius R centered on the origin.
+	// vertex_on_axis puts a vertex on the positive x axis, otherwise the middle of an edge is there.
+	template <int N>
+	simplex<vector<reals_t, 2>, 2> polygon_wedge(reals_t R, bool vertex_on_axis = true) {
+		typedef vector<reals_t, 2> V;
+		
+		reals_t t = M_PI / N, apothem = R * std::cos(t);
+		
+		if (vertex_on_axis)
+			return simplex<V, 2>({ V{ 0, 0 }, V{ R, 0 }, V{ apothem * std::cos(t), apothem * std::sin(t) } });
+		
+		return simplex<V, 2>({ V{ 0, 0 }, V{ apothem, 0 }, V{ R * std::cos(t), R * std::sin(t) } });
+	}
+	
+	namespace detail {
+		typedef vector<reals_t, 2> plane_t;
+		
+		template <int N, typename Function, typename Sampler>
+		void check_invariance(groups::D2<N> const & G, Function const & f, Sampler sample, symmetry_options const & options) {
+			counter_rng rng(options.seed, 0x73796d6dULL);
+			
+			auto group = groups::elements(G);
+			
+			for (std::size_t i = 0; i < options.check_points; ++i) {
+				plane_t x = sample(rng(2 * i), rng(2 * i + 1));
+				
+				auto fx = f(x);
+				reals_t scale = std::max(reals_t(1), magnitude2(fx));
+				
+				for (auto const & g : group) {
+					if (magnitude2(decltype(fx)(f(groups::act(g, x)) - fx)) > options.tolerance * options.tolerance * scale)
+						throw not_invariant();
+				}
+			}
+		}
+		
+		// the triangle split into n^2 similar ones
+		inline simplex_mesh<plane_t, 2> refine(simplex<plane_t, 2> const & T, std::size_t n) {
+			simplex_mesh<plane_t, 2> mesh;
+			
+			mesh.reserve((n + 1) * (n + 2) / 2, n * n);
+			
+			// row j has n + 1 - j points, from vertex 0 towards vertex 1, rows moving towards vertex 2
+			std::vector<std::uint32_t> start(n + 2);
+			
+			for (std::size_t j = 0; j <= n; ++j) {
+				start[j] = std::uint32_t(mesh.vertex_count());
+				
+				for (std::size_t i = 0; i + j <= n; ++i) {
+					reals_t a = reals_t(i) / n, b = reals_t(j) / n;
+					
+					mesh.add_vertex(T.point({{ 1 - a - b, a, b }}));
+				}
+			}
+			
+			for (std::size_t j = 0; j < n; ++j) {
+				for (std::size_t i = 0; i + j < n; ++i) {
+					std::uint32_t p = start[j] + std::uint32_t(i), q = start[j + 1] + std::uint32_t(i);
+					
+					mesh.add_element({{ p, p + 1, q }});
+					
+					if (i + j + 1 < n)
+						mesh.add_element({{ p + 1, q + 1, q }});
+				}
+			}
+			
+			return mesh;
+		}
+	}
+	
+	// integral of a D2<N> invariant f(vector<reals_t,2>) over the disk or annulus, on a polar grid of the wedge
+	template <int N, typename Function>
+	auto symmetric_integral(groups::D2<N> const & G, Function f, sector const & domain,
+							vector<std::size_t, 2> const & steps, symmetry_options const & options = {})
+		-> decltype(f(std::declval<vector<reals_t, 2>>()))
+	{
+		typedef vector<reals_t, 2> V;
+		
+		auto polar = [](V const & p) { return V{ p[0] * std::cos(p[1]), p[0] * std::sin(p[1]) }; };
+		
+		if (options.check_points > 0) {
+			detail::check_invariance(G, f, [&](reals_t u, reals_t v) {
+				return polar(V{ domain.r0 + (domain.r1 - domain.r0) * u, M_PI / N * v });
+			}, options);
+		}
+		
+		box<V> wedge(V{ domain.r0, 0 }, V{ domain.r1, M_PI / N });
+		
+		return numeric_integral([&](box<V> cell) { return f(polar(V(cell))); },
+								measure::polar_product(), wedge / steps) * reals_t(groups::order(G));
+	}
+	
+	// integral of a D2<N> invariant f over the region made of the 2N images of the triangle, split n^2 ways and
+	// integrated with the simplex rule of the given degree
+	template <int N, typename Function>
+	auto symmetric_integral(groups::D2<N> const & G, Function f, simplex<vector<reals_t, 2>, 2> const & domain,
+							std::size_t n, std::size_t degree = 5, symmetry_options const & options = {})
+		-> decltype(f(std::declval<vector<reals_t, 2>>()))
+	{
+		if (options.check_points > 0) {
+			detail::check_invariance(G, f, [&](reals_t u, reals_t v) {
+				// folded onto the triangle so the points are uniform over it
+				if (u + v > 1) {
+					u = 1 - u;
+					v = 1 - v;
+				}
+				
+				return domain.point({{ 1 - u - v, u, v }});
+			}, options);
+		}
+		
+		return mesh_integral(f, detail::refine(domain, std::max<std::size_t>(n, 1)), degree) * reals_t(groups::order(G));
+	}
+}
+
+#endif
@@ -10,6 +10,7 @@
 #define math_trig_h
 
 #include <cmath>
+#include "constant.h"
 
 namespace math {
 	namespace analytic {
@@ -40,7 +41,7 @@ namespace math {
 				}
 			};
 			
-			template <typename X>
+			template <typename X, typename = void>
 			struct _cos {
 				typedef __cos<X> type;
 			};
@@ -48,6 +49,10 @@ namespace math {
 			struct _cos<__acos<X>> {
 				typedef X type;
 			};
+			template <std::intmax_t D1, std::intmax_t D2>
+			struct _cos<complex<0,D1,0,D2>> {
+				typedef rational<1> type;
+			};
 			
 			template <typename X>
 			struct _acos {
@@ -94,7 +99,7 @@ namespace math {
 				}
 			};
 			
-			template <typename X>
+			template <typename X, typename = void>
 			struct _sin {
 				typedef __sin<X> type;
 			};
@@ -102,6 +107,10 @@ namespace math {
 			struct _sin<__asin<X>> {
 				typedef X type;
 			};
+			template <std::intmax_t D1, std::intmax_t D2>
+			struct _sin<complex<0,D1,0,D2>> {
+				typedef rational<0> type;
+			};
 			
 			template <typename X>
 			struct _asin {
@@ -0,0 +1,285 @@
+//
+//  view.h
+//  math
+//
+//  Created by Patrick Sauter on 10/19/26.
+//  Copyright (c) 2026 Patrick Sauter. All rights reserved.
+//
+
+#ifndef math_view_h
+#define math_view_h
+
+// views, a window onto the storage of a matrix, dmatrix or another view without copying anything.  entry (i, j) of a
+// view is p[i * row_stride + j * col_stride], which covers
+//
+//		transpose_view(A)				the strides swapped
+//		block(A, i, j, rows, cols)		a rectangle
+//		diagonal(A)						as a column, stride cols + 1
+//		row_slice(A, first, count, step), col_slice(A, first, count, step)
+//
+// and the same as members, so they compose, block(A, 0, 0, 4, 4).transpose().diagonal().  views of const matrices are
+// matrix_view<T const> and read only.
+//
+// a view is an operand like any dmatrix, A + transpose_view(B) * 2 is an expression and the products evaluate to a
+// dmatrix.  assigning to a view writes through to the matrix under it,
+//
+//		block(A, 0, 0, 2, 2) = B;
+//		diagonal(A) += v;
+//
+// and copying one view to another copies the entries, not the window.  when the right side reads the storage being
+// written, in another order, it is worked out into a temporary first, so A = transpose_view(A) does the right thing.
+// the view doesn't keep the matrix alive.
+//
+// row_begin() and row_end() walk the rows as ranges, so row_reduce(v.row_begin(), v.row_end()) reduces a block in place.
+
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+
+#include "core.h"
+#include "matrix.h"
+#include "dmatrix.h"
+
+namespace math {
+	template <typename T>
+	class matrix_view;
+	
+	namespace detail {
+		// rows of a view as ranges, for algorithms that walk rows like row_reduce
+		template <typename T>
+		class view_row_iterator {
+		public:
+			typedef typename matrix_view<T>::range_t			value_type;
+			typedef value_type									reference;
+			typedef std::ptrdiff_t								difference_type;
+			typedef std::forward_iterator_tag					iterator_category;
+			
+			struct pointer {
+				value_type const * operator->() const { return &r; }
+				
+				value_type		r;
+			};
+			
+			view_row_iterator(matrix_view<T> const & v, std::size_t i) : _v(v), _i(i) { }
+			
+			reference operator*() const { return _v.row(_i); }
+			pointer operator->() const { return { _v.row(_i) }; }
+			
+			view_row_iterator & operator++() { ++_i; return *this; }
+			view_row_iterator operator++(int) { auto t = *this; ++_i; return t; }
+			
+			bool operator==(view_row_iterator const & o) const { return _i == o._i; }
+			bool operator!=(view_row_iterator const & o) const { return _i != o._i; }
+		private:
+			matrix_view<T>		_v;
+			std::size_t			_i;
+		};
+	}
+	
+	template <typename T>
+	class matrix_view : public detail::dexpr<matrix_view<T>> {
+	public:
+		typedef typename std::remove_const<T>::type		value_type;
+		typedef pat::step_iterator<T*>					iterator;
+		typedef iterator_range<iterator>				range_t;
+		typedef detail::view_row_iterator<T>			row_iterator;
+		
+		matrix_view(T * p, std::size_t rows, std::size_t cols, std::ptrdiff_t row_stride, std::ptrdiff_t col_stride)
+			: _p(p), _rows(rows), _cols(cols), _rs(row_stride), _cs(col_stride) { }
+		
+		matrix_view(matrix_view const &) = default;
+		
+		// views of T convert to views of T const
+		template <typename U, typename = typename std::enable_if<std::is_same<U const, T>::value && !std::is_same<U, T>::value>::type>
+		matrix_view(matrix_view<U> const & v) : matrix_view(v.data(), v.rows(), v.cols(), v.row_stride(), v.col_stride()) { }
+		
+		std::size_t rows() const { return _rows; }
+		std::size_t cols() const { return _cols; }
+		std::size_t size() const { return _rows * _cols; }
+		
+		std::ptrdiff_t row_stride() const { return _rs; }
+		std::ptrdiff_t col_stride() const { return _cs; }
+		T * data() const { return _p; }
+		
+		T & operator()(std::size_t i, std::size_t j) const {
+			assert(i < _rows && j < _cols);
+			
+			return _p[std::ptrdiff_t(i) * _rs + std::ptrdiff_t(j) * _cs];
+		}
+		
+		// entry i counting row by row, as in dmatrix
+		T & operator[](std::size_t i) const { return (*this)(i / _cols, i % _cols); }
+		
+		range_t row(std::size_t i) const {
+			iterator r(&(*this)(i, 0), _cs);
+			
+			return make_range(r, r + _cols);
+		}
+		range_t col(std::size_t j) const {
+			iterator c(&(*this)(0, j), _rs);
+			
+			return make_range(c, c + _rows);
+		}
+		
+		row_iterator row_begin() const { return row_iterator(*this, 0); }
+		row_iterator row_end() const { return row_iterator(*this, _rows); }
+		
+		matrix_view block(std::size_t i, std::size_t j, std::size_t rows, std::size_t cols) const {
+			detail::check_size(i + rows <= _rows && j + cols <= _cols, "Block doesn't fit in the matrix.");
+			
+			return matrix_view(_p + std::ptrdiff_t(i) * _rs + std::ptrdiff_t(j) * _cs, rows, cols, _rs, _cs);
+		}
+		
+		matrix_view transpose() const { return matrix_view(_p, _cols, _rows, _cs, _rs); }
+		
+		// the diagonal as a column
+		matrix_view diagonal() const { return matrix_view(_p, std::min(_rows, _cols), 1, _rs + _cs, _cs); }
+		
+		// count rows (columns) from first, step apart
+		matrix_view row_slice(std::size_t first, std::size_t count, std::size_t step = 1) const {
+			detail::check_size(count == 0 || first + (count - 1) * step < _rows, "Slice doesn't fit in the matrix.");
+			
+			return matrix_view(_p + std::ptrdiff_t(first) * _rs, count, _cols, _rs * std::ptrdiff_t(step), _cs);
+		}
+		matrix_view col_slice(std::size_t first, std::size_t count, std::size_t step = 1) const {
+			detail::check_size(count == 0 || first + (count - 1) * step < _cols, "Slice doesn't fit in the matrix.");
+			
+			return matrix_view(_p + std::ptrdiff_t(first) * _cs, _rows, count, _rs, _cs * std::ptrdiff_t(step));
+		}
+		
+		// the bytes the view can touch
+		T * lowest() const { return _p; }
+		T * highest() const {
+			return (size() == 0 ? _p : _p + std::ptrdiff_t(_rows - 1) * _rs + std::ptrdiff_t(_cols - 1) * _cs + 1);
+		}
+		
+		bool aliases(void const * b, void const * e, bool) const {
+			return detail::overlap(lowest(), highest(), b, e);
+		}
+		
+		// ------------------------------------------------------
+		// writing through the view, from a matrix, dmatrix, view or expression of the same size
+		
+		matrix_view const & operator=(matrix_view const & x) const { return assign(x, [](value_type & a, value_type const & b) { a = b; }); }
+		
+		template <typename X, typename = typename std::enable_if<detail::is_dense<X>::value>::type>
+		matrix_view const & operator=(X && x) const {
+			return assign(std::forward<X>(x), [](value_type & a, value_type const & b) { a = b; });
+		}
+		template <typename X, typename = typename std::enable_if<detail::is_dense<X>::value>::type>
+		matrix_view const & operator+=(X && x) const {
+			return assign(std::forward<X>(x), [](value_type & a, value_type const & b) { a = a + b; });
+		}
+		template <typename X, typename = typename std::enable_if<detail::is_dense<X>::value>::type>
+		matrix_view const & operator-=(X && x) const {
+			return assign(std::forward<X>(x), [](value_type & a, value_type const & b) { a = a - b; });
+		}
+		
+		template <typename Scalar, typename = typename std::enable_if<pat::traits::has_multiply<value_type, Scalar, value_type>::value>::type>
+		matrix_view const & operator*=(Scalar const & s) const {
+			for (std::size_t i = 0; i < _rows; ++i)
+				for (auto & x : row(i))
+					x = x * s;
+			
+			return *this;
+		}
+		template <typename Scalar, typename = typename std::enable_if<pat::traits::has_divide<value_type, Scalar, value_type>::value>::type>
+		matrix_view const & operator/=(Scalar const & s) const {
+			for (std::size_t i = 0; i < _rows; ++i)
+				for (auto & x : row(i))
+					x = x / s;
+			
+			return *this;
+		}
+	private:
+		template <typename X, typename Op>
+		matrix_view const & assign(X && x, Op op) const {
+			static_assert(!std::is_const<T>::value, "Assertion failed, writing through a view of a const matrix.");
+			
+			auto e = detail::wrap(std::forward<X>(x));
+			
+			detail::check_size(e.rows() == _rows && e.cols() == _cols, "Matrix sizes don't match.");
+			
+			// the right side reads what is about to be written
+			if (e.aliases(lowest(), highest(), false))
+				return assign(dmatrix<value_type>(e), op);
+			
+			for (std::size_t i = 0, k = 0; i < _rows; ++i) {
+				T * r = _p + std::ptrdiff_t(i) * _rs;
+				
+				for (std::size_t j = 0; j < _cols; ++j, ++k)
+					op(r[std::ptrdiff_t(j) * _cs], value_type(e[k]));
+			}
+			
+			return *this;
+		}
+		
+		T *					_p;
+		std::size_t			_rows, _cols;
+		std::ptrdiff_t		_rs, _cs;
+	};
+	
+	namespace detail {
+		template <typename X>
+		struct is_view : std::false_type { };
+		template <typename T>
+		struct is_view<matrix_view<T>> : std::true_type { };
+		
+		// views of temporaries would dangle
+		template <typename Matrix>
+		struct viewable : std::integral_constant<bool,
+			std::is_lvalue_reference<Matrix>::value || is_view<typename std::decay<Matrix>::type>::value
+		> { };
+	}
+	
+	// ------------------------------------------------------
+	// the whole of a matrix, dmatrix or view
+	
+	template <typename T, std::size_t N, std::size_t M>
+	matrix_view<T> view(matrix<T,N,M> & m) { return matrix_view<T>(m.data(), N, M, M, 1); }
+	template <typename T, std::size_t N, std::size_t M>
+	matrix_view<T const> view(matrix<T,N,M> const & m) { return matrix_view<T const>(m.data(), N, M, M, 1); }
+	
+	template <typename T>
+	matrix_view<T> view(dmatrix<T> & m) { return matrix_view<T>(m.data(), m.rows(), m.cols(), m.cols(), 1); }
+	template <typename T>
+	matrix_view<T const> view(dmatrix<T> const & m) { return matrix_view<T const>(m.data(), m.rows(), m.cols(), m.cols(), 1); }
+	
+	template <typename T>
+	matrix_view<T> view(matrix_view<T> const & v) { return v; }
+	
+	template <typename Matrix, typename = typename std::enable_if<detail::viewable<Matrix>::value>::type>
+	auto transpose_view(Matrix && m) { return view(m).transpose(); }
+	
+	template <typename Matrix, typename = typename std::enable_if<detail::viewable<Matrix>::value>::type>
+	auto block(Matrix && m, std::size_t i, std::size_t j, std::size_t rows, std::size_t cols) { return view(m).block(i, j, rows, cols); }
+	
+	template <typename Matrix, typename = typename std::enable_if<detail::viewable<Matrix>::value>::type>
+	auto diagonal(Matrix && m) { return view(m).diagonal(); }
+	
+	template <typename Matrix, typename = typename std::enable_if<detail::viewable<Matrix>::value>::type>
+	auto row_slice(Matrix && m, std::size_t first, std::size_t count, std::size_t step = 1) { return view(m).row_slice(first, count, step); }
+	
+	template <typename Matrix, typename = typename std::enable_if<detail::viewable<Matrix>::value>::type>
+	auto col_slice(Matrix && m, std::size_t first, std::size_t count, std::size_t step = 1) { return view(m).col_slice(first, count, step); }
+}
+
+namespace std {
+	template <typename T>
+	ostream & operator<<(ostream& out, math::matrix_view<T> const & a) {
+		out << "{" << std::endl;
+		
+		for (std::size_t i = 0; i < a.rows(); ++i) {
+			for (auto const & j : a.row(i))
+				out << std::setw(3) << j;
+			
+			out << std::endl;
+		}
+		
+		out << "}";
+		
+		return out;
+	}
+}
+
+#endif
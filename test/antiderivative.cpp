@@ -0,0 +1,68 @@
+//
+//  antiderivative.cpp
+//  math tests
+//
+//  Created by Patrick Sauter on 10/19/26.
+//  Copyright (c) 2026 Patrick Sauter. All rights reserved.
+//
+
+// has_integral<> must not depend on what was instantiated before it.  x e^x sin x is integrated by parts
+// into e^x sin x, so ask for the two in both orders, once in x and once in y.
+
+#include <cmath>
+#include <iostream>
+#include <type_traits>
+
+#include "analytic.h"
+#include "derivative.h"
+#include "antiderivative.h"
+
+namespace A = math::analytic;
+using A::x;
+using A::y;
+
+typedef A::multiply<A::exp<x>, A::sin<x>>		exp_sin_x;
+typedef A::multiply<x, A::exp<x>, A::sin<x>>	x_exp_sin_x;
+typedef A::multiply<A::exp<y>, A::sin<y>>		exp_sin_y;
+typedef A::multiply<y, A::exp<y>, A::sin<y>>	y_exp_sin_y;
+
+// the smaller one first
+typedef A::integral<exp_sin_x, x> i_exp_sin_x;
+static_assert(A::has_integral<x_exp_sin_x, x>::value, "x e^x sin x, after e^x sin x");
+typedef A::integral<x_exp_sin_x, x> i_x_exp_sin_x;
+
+// the larger one first
+static_assert(A::has_integral<y_exp_sin_y, y>::value, "y e^y sin y, before e^y sin y");
+typedef A::integral<y_exp_sin_y, y> i_y_exp_sin_y;
+static_assert(A::has_integral<exp_sin_y, y>::value, "e^y sin y, after y e^y sin y");
+typedef A::integral<exp_sin_y, y> i_exp_sin_y;
+
+// sin and cos of zero and of negated arguments come out simplified
+static_assert(std::is_same<A::sin<A::rational<0>>, A::rational<0>>::value, "sin(0)");
+static_assert(std::is_same<A::cos<A::rational<0>>, A::rational<1>>::value, "cos(0)");
+static_assert(std::is_same<A::cos<A::multiply<A::rational<-1>, x>>, A::cos<x>>::value, "cos(-x)");
+static_assert(std::is_same<A::sin<A::multiply<A::rational<-2>, x>>, A::multiply<A::rational<-1>, A::sin<A::multiply<A::rational<2>, x>>>>::value, "sin(-2x)");
+
+template <typename F, typename I>
+bool check(char const * name) {
+	// dI/dx against F, with a central difference
+	double const h = 1e-5;
+	for (double t = -1; t <= 1; t += 0.25) {
+		double d = (I()(t + h, t + h) - I()(t - h, t - h)) / (2 * h);
+		if (std::abs(d - F()(t, t)) > 1e-6) {
+			std::cout << name << ": " << I() << " is off by " << d - F()(t, t) << " at " << t << std::endl;
+			return false;
+		}
+	}
+	return true;
+}
+
+int main(int argc, const char * argv[])
+{
+	bool ok = check<exp_sin_x, i_exp_sin_x>("e^x sin x") &&
+		check<x_exp_sin_x, i_x_exp_sin_x>("x e^x sin x") &&
+		check<exp_sin_y, i_exp_sin_y>("e^y sin y") &&
+		check<y_exp_sin_y, i_y_exp_sin_y>("y e^y sin y");
+	
+	return ok ? 0 : 1;
+}
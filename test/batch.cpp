@@ -0,0 +1,142 @@
+//
+//  batch.cpp
+//  math tests
+//
+//  Created by Patrick Sauter on 10/19/26.
+//  Copyright (c) 2026 Patrick Sauter. All rights reserved.
+//
+
+// determinant, inverse and solve over batches whose last tile is only partly used, against the same done one matrix
+// at a time.  the padding matrices past size() have to stay zero in the results, and a singular matrix anywhere in the
+// batch, but not the padding, has to throw.  up to 4x4 goes through the cofactor kernels, 5x5 through lu().
+
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <algorithm>
+
+#include "matrix.h"
+#include "lu.h"
+#include "batch.h"
+
+// deterministic entries in [-1, 1)
+struct entries {
+	std::uint64_t state;
+	
+	double operator()() {
+		state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+		
+		return double(state >> 11) / double(std::uint64_t(1) << 52) - 1;
+	}
+};
+
+template <typename T, std::size_t N, std::size_t M>
+bool padding_zero(math::matrix_batch<T,N,M> const & a) {
+	for (std::size_t k = a.size(); k < a.padded_size(); ++k)
+		for (std::size_t e = 0; e < N * M; ++e)
+			if (a.entries(k, e)[0] != T(0))
+				return false;
+	
+	return true;
+}
+
+template <typename T, std::size_t N, std::size_t K>
+bool check(char const * name, std::size_t count, double tolerance) {
+	entries r{ count * 10 + N };
+	math::matrix_batch<T,N,N> a(count);
+	math::matrix_batch<T,N,K> b(count);
+	
+	// diagonally dominant, so every one is well conditioned
+	for (std::size_t k = 0; k < count; ++k) {
+		math::matrix<T,N,N> m;
+		math::matrix<T,N,K> v;
+		
+		for (std::size_t i = 0; i < N; ++i)
+			for (std::size_t j = 0; j < N; ++j)
+				m[i * N + j] = T(r()) + (i == j ? T(N) : T(0));
+		for (auto & x : v)
+			x = T(r());
+		
+		a.set(k, m);
+		b.set(k, v);
+	}
+	
+	auto d = math::determinant(a);
+	auto inverse = math::inverse(a);
+	auto x = math::solve(a, b);
+	
+	double error = 0;
+	
+	for (std::size_t k = 0; k < count; ++k) {
+		auto f = math::lu(a[k]);
+		auto expected_inverse = f.inverse();
+		auto expected_x = f.solve(b[k]);
+		
+		error = std::max(error, double(std::abs(d[k] / f.determinant() - T(1))));
+		
+		for (std::size_t e = 0; e < N * N; ++e)
+			error = std::max(error, double(std::abs(inverse[k][e] - expected_inverse[e])));
+		for (std::size_t e = 0; e < N * K; ++e)
+			error = std::max(error, double(std::abs(x[k][e] - expected_x[e])));
+	}
+	
+	bool ok = d.size() == count && padding_zero(inverse) && padding_zero(x);
+	
+	if (!(error < tolerance) || !ok) {
+		std::cout << name << " " << N << "x" << N << ", " << count << " matrices: error " << error <<
+			(ok ? "" : ", padding not zero") << std::endl;
+		return false;
+	}
+	
+	// the second to last made singular, with a zero row so the determinant comes out exactly 0
+	if (count > 1) {
+		auto m = a[count - 2];
+		
+		for (std::size_t j = 0; j < N; ++j)
+			m[N + j] = T(0);
+		
+		a.set(count - 2, m);
+		
+		std::size_t caught = 0;
+		
+		try { math::inverse(a); } catch (math::singular const &) { ++caught; }
+		try { math::solve(a, b); } catch (math::singular const &) { ++caught; }
+		
+		if (caught != 2) {
+			std::cout << name << " " << N << "x" << N << ", " << count << " matrices: " << caught << " of 2 threw" << std::endl;
+			return false;
+		}
+	}
+	
+	return true;
+}
+
+template <typename T>
+bool check_all(char const * name, double tolerance) {
+	bool ok = true;
+	
+	for (std::size_t count : { 1, 7, 8, 13, 17, 10007 }) {
+		ok = check<T,2,1>(name, count, tolerance) && ok;
+		ok = check<T,3,1>(name, count, tolerance) && ok;
+		ok = check<T,3,4>(name, count, tolerance) && ok;
+		ok = check<T,4,2>(name, count, tolerance) && ok;
+		ok = check<T,5,1>(name, count, tolerance) && ok;
+	}
+	
+	return ok;
+}
+
+int main(int argc, const char * argv[])
+{
+	bool ok = true;
+	
+	try {
+		ok = check_all<double>("double", 1e-12) && ok;
+		ok = check_all<float>("float", 1e-4) && ok;
+	} catch (std::exception const & e) {
+		std::cout << e.what() << std::endl;
+		ok = false;
+	}
+	
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,167 @@
+//
+//  cholesky.cpp
+//  math tests
+//
+//  Created by Patrick Sauter on 10/19/26.
+//  Copyright (c) 2026 Patrick Sauter. All rights reserved.
+//
+
+// cholesky and LDL^H on both sides of the 2 lu_block rows where the factorisation goes blocked, checked for A X = B
+// and a determinant known from the way A was built, with junk in the upper triangle since only the lower one is
+// read.  an indefinite matrix has to make cholesky's determinant and solve throw, and a zero pivot LDL^H's.
+
+#include <cmath>
+#include <complex>
+#include <cstdint>
+#include <iostream>
+#include <algorithm>
+
+#include "dmatrix.h"
+#include "cholesky.h"
+
+// deterministic entries in [-1, 1)
+struct entries {
+	std::uint64_t state;
+	
+	double operator()() {
+		state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+		
+		return double(state >> 11) / double(std::uint64_t(1) << 52) - 1;
+	}
+};
+
+template <typename T>
+T entry(entries & r) { return T(r()); }
+
+template <>
+std::complex<double> entry(entries & r) { double x = r(); return std::complex<double>(x, r()); }
+
+// A = L D L^H with unit L, small enough below the diagonal to keep A well conditioned, d gives the diagonal of D
+template <typename T, typename D>
+math::dmatrix<T> product(std::size_t n, entries & r, D d, T & det) {
+	math::dmatrix<T> l(n, n), a(n, n);
+	std::vector<double> w(n);
+	
+	det = T(1);
+	
+	for (std::size_t i = 0; i < n; ++i) {
+		for (std::size_t j = 0; j < i; ++j)
+			l[i * n + j] = entry<T>(r) / T(std::sqrt(double(n)));
+		
+		l[i * n + i] = T(1);
+		w[i] = d(i);
+		det *= T(w[i]);
+	}
+	
+	for (std::size_t i = 0; i < n; ++i) {
+		for (std::size_t j = 0; j <= i; ++j) {
+			T s = 0;
+			
+			for (std::size_t k = 0; k <= j; ++k)
+				s += l[i * n + k] * w[k] * math::detail::conjugate(l[j * n + k]);
+			
+			a[i * n + j] = s;
+			a[j * n + i] = math::detail::conjugate(s);
+		}
+	}
+	
+	return a;
+}
+
+template <bool Unit, typename T>
+bool check(char const * name, std::size_t n) {
+	entries r{ n };
+	T det;
+	
+	// positive for cholesky, both signs for LDL^H
+	auto a = product<T>(n, r, [&](std::size_t) { return (Unit && r() < 0 ? -1 : 1) * (1 + r() / 4); }, det);
+	auto lower = a;
+	math::dmatrix<T> b(n, 3);
+	
+	for (std::size_t i = 0; i < n; ++i)
+		for (std::size_t j = i + 1; j < n; ++j)
+			lower[i * n + j] = T(1e6);
+	
+	for (auto & x : b)
+		x = entry<T>(r);
+	
+	math::cholesky_decomposition<math::dmatrix<T>, Unit> f(lower);
+	
+	if (!f.factored()) {
+		std::cout << name << " " << n << "x" << n << ": not factored" << std::endl;
+		return false;
+	}
+	
+	auto x = f.solve(b);
+	double error = std::abs(f.determinant() / det - T(1));
+	
+	for (std::size_t i = 0; i < n; ++i) {
+		for (std::size_t c = 0; c < 3; ++c) {
+			T s = -b[i * 3 + c];
+			
+			for (std::size_t k = 0; k < n; ++k)
+				s += a[i * n + k] * x[k * 3 + c];
+			
+			error = std::max(error, double(std::abs(s)));
+		}
+	}
+	
+	if (!(error < 1e-11)) {
+		std::cout << name << " " << n << "x" << n << ": error " << error << std::endl;
+		return false;
+	}
+	
+	return true;
+}
+
+// stopped factorisations, which determinant and solve have to refuse rather than answer from half the factors
+template <typename Exception, typename Decomposition>
+bool check_throws(char const * name, Decomposition const & f) {
+	std::size_t caught = 0;
+	math::dmatrix<double> b(f.size(), 1, 1.0);
+	
+	try { f.determinant(); } catch (Exception const &) { ++caught; }
+	try { f.solve(b); } catch (Exception const &) { ++caught; }
+	
+	if (f.factored() || caught != 2) {
+		std::cout << name << ": factored " << f.factored() << ", " << caught << " of 2 threw" << std::endl;
+		return false;
+	}
+	
+	return true;
+}
+
+int main(int argc, const char * argv[])
+{
+	typedef std::complex<double> C;
+	
+	bool ok = true;
+	
+	try {
+		for (std::size_t n : { 100, 128, 129, 200, 301 }) {
+			ok = check<false, double>("cholesky", n) && ok;
+			ok = check<false, C>("complex cholesky", n) && ok;
+			ok = check<true, double>("ldlt", n) && ok;
+			ok = check<true, C>("complex ldlt", n) && ok;
+		}
+		
+		for (std::size_t n : { 3, 200 }) {
+			entries r{ n };
+			double det;
+			
+			// the last pivot negative, so both paths get all the way to the end before stopping
+			auto a = product<double>(n, r, [&](std::size_t i) { return (i + 1 == n ? -1.0 : 1.0); }, det);
+			
+			ok = check_throws<math::not_positive_definite>("indefinite cholesky", math::cholesky(a)) && ok;
+			
+			a[0] = 0;
+			
+			ok = check_throws<math::singular>("zero pivot ldlt", math::ldlt(a)) && ok;
+		}
+	} catch (std::exception const & e) {
+		std::cout << e.what() << std::endl;
+		ok = false;
+	}
+	
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,137 @@
+//
+//  funm.cpp
+//  math tests
+//
+//  Created by Patrick Sauter on 10/19/26.
+//  Copyright (c) 2026 Patrick Sauter. All rights reserved.
+//
+
+// schur-parlett funm against known values.  diagonal matrices with eigenvalues closer than funm_cluster in a long
+// chain used to end up in one block, whose circle crossed the branch cut of sqrt and log.  rotated copies check the
+// same through a full schur form, and expm against funm of exp on random matrices.
+
+#include <cmath>
+#include <random>
+#include <complex>
+#include <iostream>
+#include <algorithm>
+
+#include "dmatrix.h"
+#include "funm.h"
+#include "exceptions.h"
+
+typedef std::complex<double> C;
+
+double difference(math::dmatrix<double> const & a, math::dmatrix<double> const & b) {
+	double d = 0;
+	
+	for (std::size_t i = 0; i < a.size(); ++i)
+		d = std::max(d, std::abs(a.data()[i] - b.data()[i]));
+	
+	return d;
+}
+
+bool report(char const * name, double step, double error, double tolerance) {
+	if (error > tolerance) {
+		std::cout << name << " with spacing " << step << " is off by " << error << std::endl;
+		return false;
+	}
+	
+	return true;
+}
+
+// Q D Q^T for a random orthogonal Q, from gram-schmidt on a random matrix
+math::dmatrix<double> rotated(math::dmatrix<double> const & d, std::mt19937 & g) {
+	std::size_t const n = d.rows();
+	std::normal_distribution<double> normal;
+	math::dmatrix<double> q(n, n);
+	
+	for (std::size_t j = 0; j < n; ++j) {
+		for (std::size_t i = 0; i < n; ++i)
+			q(i, j) = normal(g);
+		
+		for (std::size_t pass = 0; pass < 2; ++pass) {
+			for (std::size_t k = 0; k < j; ++k) {
+				double dot = 0;
+				
+				for (std::size_t i = 0; i < n; ++i)
+					dot += q(i, k) * q(i, j);
+				for (std::size_t i = 0; i < n; ++i)
+					q(i, j) -= dot * q(i, k);
+			}
+		}
+		
+		double length = 0;
+		
+		for (std::size_t i = 0; i < n; ++i)
+			length += q(i, j) * q(i, j);
+		for (std::size_t i = 0; i < n; ++i)
+			q(i, j) /= std::sqrt(length);
+	}
+	
+	return q * d * transpose(q);
+}
+
+int main(int argc, const char * argv[])
+{
+	std::mt19937 g(5);
+	bool ok = true;
+	
+	try {
+		for (double step : { 0.2, 0.09, 0.05, 0.01 }) {
+			std::size_t const n = std::size_t(std::round(2.5 / step)) + 1;
+			math::dmatrix<double> d(n, n, 0.0), s(n, n, 0.0), l(n, n, 0.0);
+			
+			for (std::size_t i = 0; i < n; ++i) {
+				d(i, i) = 0.5 + step * double(i);
+				s(i, i) = std::sqrt(d(i, i));
+				l(i, i) = std::log(d(i, i));
+			}
+			
+			ok = report("sqrt of a diagonal", step, difference(math::funm([](C z) { return std::sqrt(z); }, d), s), 1e-12) && ok;
+			ok = report("log of a diagonal", step, difference(math::funm([](C z) { return std::log(z); }, d), l), 1e-12) && ok;
+			
+			if (n <= 60) {
+				math::dmatrix<double> a = rotated(d, g);
+				
+				ok = report("sqrt, rotated", step, difference(math::funm([](C z) { return std::sqrt(z); }, a), math::sqrtm(a)), 1e-10) && ok;
+				ok = report("log, rotated", step, difference(math::funm([](C z) { return std::log(z); }, a), math::logm(a)), 1e-10) && ok;
+			}
+		}
+		
+		std::normal_distribution<double> normal;
+		
+		for (std::size_t n : { 2, 5, 12, 40 }) {
+			math::dmatrix<double> a(n, n);
+			
+			for (auto & x : a)
+				x = normal(g) / std::sqrt(double(n));
+			
+			math::dmatrix<double> e = math::expm(a);
+			
+			ok = report("expm against funm", double(n), difference(math::funm([](C z) { return std::exp(z); }, a), e) / (1 + difference(e, math::dmatrix<double>(n, n, 0.0))), 1e-12) && ok;
+		}
+	} catch (std::exception const & e) {
+		std::cout << e.what() << std::endl;
+		ok = false;
+	}
+	
+	// a jordan block longer than the series, sqrt of it can't be summed from the coefficients funm has
+	math::dmatrix<double> j(40, 40, 0.0);
+	
+	for (std::size_t i = 0; i < 40; ++i) {
+		j(i, i) = 1;
+		
+		if (i + 1 < 40)
+			j(i, i + 1) = 1;
+	}
+	
+	try {
+		math::funm([](C z) { return std::sqrt(z); }, j);
+		
+		std::cout << "sqrt of a 40 x 40 jordan block didn't throw" << std::endl;
+		ok = false;
+	} catch (math::not_converged const &) { }
+	
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,123 @@
+//
+//  lu.cpp
+//  math tests
+//
+//  Created by Patrick Sauter on 10/19/26.
+//  Copyright (c) 2026 Patrick Sauter. All rights reserved.
+//
+
+// matrices over 2 lu_block rows are factored a panel at a time with gemm updates, smaller ones unblocked.  sizes on
+// both sides of that line, and with a partial last panel, are checked for A X = B, A A^-1 = I, and a determinant
+// known from the way A was built.
+
+#include <cmath>
+#include <complex>
+#include <cstdint>
+#include <iostream>
+#include <algorithm>
+
+#include "dmatrix.h"
+#include "lu.h"
+
+// deterministic entries in [-1, 1)
+struct entries {
+	std::uint64_t state;
+	
+	double operator()() {
+		state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+		
+		return double(state >> 11) / double(std::uint64_t(1) << 52) - 1;
+	}
+};
+
+template <typename T>
+T entry(entries & r) { return T(r()); }
+
+template <>
+std::complex<double> entry(entries & r) { double x = r(); return std::complex<double>(x, r()); }
+
+// A = L U with unit L and the diagonal of U in [0.75, 1.25], so det A is the product of that diagonal
+template <typename T>
+bool check(char const * name, std::size_t n, double tolerance) {
+	entries r{ n };
+	math::dmatrix<T> l(n, n), u(n, n), a(n, n), b(n, 3);
+	T det = T(1);
+	
+	for (std::size_t i = 0; i < n; ++i) {
+		for (std::size_t j = 0; j < n; ++j) {
+			if (j < i)
+				l[i * n + j] = entry<T>(r) / T(4);
+			else if (j > i)
+				u[i * n + j] = entry<T>(r) / T(4);
+		}
+		
+		l[i * n + i] = T(1);
+		u[i * n + i] = T(1 + r() / 4);
+		det *= u[i * n + i];
+	}
+	
+	for (std::size_t i = 0; i < n; ++i) {
+		for (std::size_t j = 0; j < n; ++j) {
+			T s = 0;
+			
+			for (std::size_t k = 0; k <= std::min(i, j); ++k)
+				s += l[i * n + k] * u[k * n + j];
+			
+			a[i * n + j] = s;
+		}
+	}
+	
+	for (auto & x : b)
+		x = entry<T>(r);
+	
+	auto f = math::lu(a);
+	auto x = f.solve(b);
+	auto inverse = f.inverse();
+	
+	double error = std::abs(f.determinant() / det - T(1));
+	
+	for (std::size_t i = 0; i < n; ++i) {
+		for (std::size_t c = 0; c < 3; ++c) {
+			T s = -b[i * 3 + c];
+			
+			for (std::size_t k = 0; k < n; ++k)
+				s += a[i * n + k] * x[k * 3 + c];
+			
+			error = std::max(error, double(std::abs(s)));
+		}
+		
+		for (std::size_t j = 0; j < n; ++j) {
+			T s = -T(i == j);
+			
+			for (std::size_t k = 0; k < n; ++k)
+				s += a[i * n + k] * inverse[k * n + j];
+			
+			error = std::max(error, double(std::abs(s)));
+		}
+	}
+	
+	if (!(error < tolerance)) {
+		std::cout << name << " " << n << "x" << n << ": error " << error << std::endl;
+		return false;
+	}
+	
+	return true;
+}
+
+int main(int argc, const char * argv[])
+{
+	bool ok = true;
+	
+	try {
+		for (std::size_t n : { 100, 128, 129, 200, 301 }) {
+			ok = check<double>("double", n, 1e-9) && ok;
+			ok = check<float>("float", n, 2e-2) && ok;
+			ok = check<std::complex<double>>("complex", n, 1e-9) && ok;
+		}
+	} catch (std::exception const & e) {
+		std::cout << e.what() << std::endl;
+		ok = false;
+	}
+	
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,135 @@
+//
+//  qr.cpp
+//  math tests
+//
+//  Created by Patrick Sauter on 10/19/26.
+//  Copyright (c) 2026 Patrick Sauter. All rights reserved.
+//
+
+// least squares by pivoted QR on matrices that don't have full column rank.  rank() has to find the rank A was built
+// with, X has to satisfy the normal equations A^H (A X - B) = 0, and the basic solution is zero in the columns the
+// pivoting put past the rank.
+
+#include <cmath>
+#include <complex>
+#include <cstdint>
+#include <iostream>
+#include <algorithm>
+
+#include "matrix.h"
+#include "dmatrix.h"
+#include "qr.h"
+
+// deterministic entries in [-1, 1)
+struct entries {
+	std::uint64_t state;
+	
+	double operator()() {
+		state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+		
+		return double(state >> 11) / double(std::uint64_t(1) << 52) - 1;
+	}
+};
+
+template <typename T>
+T entry(entries & r) { return T(r()); }
+
+template <>
+std::complex<double> entry(entries & r) { double x = r(); return std::complex<double>(x, r()); }
+
+template <typename Matrix, typename B>
+bool check(char const * name, Matrix const & a, B const & b, std::size_t rank) {
+	typedef typename Matrix::value_type T;
+	
+	std::size_t const m = a.rows(), n = a.cols(), k = b.cols();
+	
+	auto f = math::qr(a, true);
+	auto x = math::lstsq(a, b);
+	
+	double error = 0;
+	
+	for (std::size_t j = 0; j < n; ++j) {
+		for (std::size_t c = 0; c < k; ++c) {
+			T s = 0;
+			
+			for (std::size_t i = 0; i < m; ++i) {
+				T t = -b.data()[i * k + c];
+				
+				for (std::size_t l = 0; l < n; ++l)
+					t += a.data()[i * n + l] * x.data()[l * k + c];
+				
+				s += math::detail::conjugate(a.data()[i * n + j]) * t;
+			}
+			
+			error = std::max(error, double(std::abs(s)));
+		}
+	}
+	
+	for (std::size_t j = rank; j < n; ++j) {
+		for (std::size_t c = 0; c < k; ++c)
+			error = std::max(error, double(std::abs(x.data()[f.permutation()[j] * k + c])));
+	}
+	
+	if (!(error < 1e-10) || f.rank() != rank) {
+		std::cout << name << ": rank " << f.rank() << " (expected " << rank << "), error " << error << std::endl;
+		return false;
+	}
+	
+	return true;
+}
+
+// m x n of rank r as a product of m x r and r x n
+template <typename T>
+math::dmatrix<T> product(std::size_t m, std::size_t n, std::size_t r, entries & e) {
+	math::dmatrix<T> u(m, r), v(r, n), a(m, n);
+	
+	for (auto & x : u)
+		x = entry<T>(e);
+	for (auto & x : v)
+		x = entry<T>(e);
+	
+	for (std::size_t i = 0; i < m; ++i)
+		for (std::size_t j = 0; j < n; ++j)
+			for (std::size_t l = 0; l < r; ++l)
+				a[i * n + j] += u[i * r + l] * v[l * n + j];
+	
+	return a;
+}
+
+template <typename T>
+bool check_random(char const * name, std::size_t m, std::size_t n, std::size_t r) {
+	entries e{ m * 1000 + n * 10 + r };
+	
+	auto a = product<T>(m, n, r, e);
+	math::dmatrix<T> b(m, 2);
+	
+	for (auto & x : b)
+		x = entry<T>(e);
+	
+	return check(name, a, b, r);
+}
+
+int main(int argc, const char * argv[])
+{
+	typedef std::complex<double> C;
+	
+	bool ok = true;
+	
+	try {
+		ok = check("5x4 rank 2", math::matrix<double,5,4>{ 1, 2, 3, 4, 2, 4, 6, 8, 1, 0, 1, 0, 3, 4, 7, 8, 0, 2, 2, 4 },
+				   math::matrix<double,5,1>{ 1, 2, 3, 4, 5 }, 2) && ok;
+		ok = check("4x4 duplicate columns", math::matrix<double,4,4>{ 1, 1, 2, 2, 3, 3, 1, 1, 0, 0, 5, 5, 2, 2, 1, 1 },
+				   math::matrix<double,4,2>{ 1, 0, 0, 1, 1, 1, 2, 3 }, 2) && ok;
+		ok = check_random<double>("40x12 rank 5", 40, 12, 5) && ok;
+		ok = check_random<double>("12x40 rank 7", 12, 40, 7) && ok;
+		ok = check_random<double>("30x30 rank 29", 30, 30, 29) && ok;
+		ok = check_random<double>("20x8 full rank", 20, 8, 8) && ok;
+		ok = check_random<C>("complex 40x12 rank 5", 40, 12, 5) && ok;
+		ok = check_random<C>("complex 25x25 rank 10", 25, 25, 10) && ok;
+	} catch (std::exception const & e) {
+		std::cout << e.what() << std::endl;
+		ok = false;
+	}
+	
+	return ok ? 0 : 1;
+}
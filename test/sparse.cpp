@@ -0,0 +1,148 @@
+//
+//  sparse.cpp
+//  math tests
+//
+//  Created by Patrick Sauter on 10/19/26.
+//  Copyright (c) 2026 Patrick Sauter. All rights reserved.
+//
+
+// CSR and CSC built from the same triplets, with repeated entries and empty rows and columns, have to agree with the
+// dense matrix and with each other through to_csr, to_csc and transpose, and A X and A^T X have to match the dense
+// products for either layout.  the entries are small integers, so everything is compared exactly.  sizes past
+// sparse_block rows take the parallel paths.
+
+#include <cstdint>
+#include <complex>
+#include <iostream>
+#include <algorithm>
+
+#include "dmatrix.h"
+#include "sparse.h"
+
+// deterministic integers in [0, n)
+struct entries {
+	std::uint64_t state;
+	
+	std::size_t operator()(std::size_t n) {
+		state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+		
+		return std::size_t(state >> 33) % n;
+	}
+};
+
+template <typename T>
+T value(entries & r) { return T(double(r(9)) - 4); }
+
+template <>
+std::complex<double> value(entries & r) { double x = double(r(9)) - 4; return std::complex<double>(x, double(r(9)) - 4); }
+
+template <typename T>
+bool same(math::dmatrix<T> const & a, math::dmatrix<T> const & b) {
+	return a.rows() == b.rows() && a.cols() == b.cols() && std::equal(a.begin(), a.end(), b.begin());
+}
+
+template <typename T, bool Rows>
+bool same(math::compressed_matrix<T, Rows> const & a, math::compressed_matrix<T, Rows> const & b) {
+	return a.rows() == b.rows() && a.cols() == b.cols() && a.offsets() == b.offsets() && a.indices() == b.indices() &&
+		   a.values() == b.values();
+}
+
+template <typename T>
+bool check(char const * name, std::size_t m, std::size_t n, std::size_t count) {
+	entries r{ m * 7 + n };
+	math::sparse_builder<T> b(m, n);
+	math::dmatrix<T> d(m, n), t(n, m);
+	
+	// every other row and every third column stay empty, and about a fifth of the entries come twice
+	for (std::size_t k = 0; k < count; ++k) {
+		std::size_t i = 2 * r(m / 2), j = 3 * r(n / 3);
+		T x = value<T>(r);
+		
+		b.add(i, j, x);
+		d(i, j) += x;
+		
+		if (r(5) == 0) {
+			b.add(i, j, x);
+			d(i, j) += x;
+		}
+	}
+	
+	for (std::size_t i = 0; i < m; ++i)
+		for (std::size_t j = 0; j < n; ++j)
+			t(j, i) = d(i, j);
+	
+	auto csr = b.csr();
+	auto csc = b.csc();
+	
+	std::size_t failures = 0;
+	auto expect = [&](bool condition, char const * what) {
+		if (!condition) {
+			std::cout << name << " " << m << "x" << n << ": " << what << std::endl;
+			++failures;
+		}
+	};
+	
+	expect(same(csr.dense(), d), "csr isn't the dense matrix");
+	expect(same(csc.dense(), d), "csc isn't the dense matrix");
+	expect(same(math::to_csc(csr), csc), "to_csc(csr) isn't csc");
+	expect(same(math::to_csr(csc), csr), "to_csr(csc) isn't csr");
+	expect(same(math::to_csr(math::to_csc(csr)), csr), "csr to csc and back changed it");
+	expect(same(math::transpose(csr).dense(), t), "transpose(csr) isn't A^T");
+	expect(same(math::transpose(csc).dense(), t), "transpose(csc) isn't A^T");
+	// the triplets can add up to explicit zeros, which the dense constructor leaves out
+	expect(same(math::csr_matrix<T>(d).dense(), d), "csr from the dense matrix isn't the dense matrix");
+	
+	for (std::size_t k : { 1, 3 }) {
+		math::dmatrix<T> x(n, k), y(m, k);
+		
+		for (auto & e : x)
+			e = value<T>(r);
+		for (auto & e : y)
+			e = value<T>(r);
+		
+		expect(same(csr * x, d * x), "csr A X");
+		expect(same(csc * x, d * x), "csc A X");
+		expect(same(math::transpose_multiply(csr, y), t * y), "csr A^T X");
+		expect(same(math::transpose_multiply(csc, y), t * y), "csc A^T X");
+		expect(same(math::transpose(csr) * y, t * y), "transpose(csr) X");
+	}
+	
+	return failures == 0;
+}
+
+// the same triplets on one thread and on several
+bool check_assemble(std::size_t n) {
+	auto f = [n](std::size_t k, math::sparse_builder<double> & b) {
+		b.add(k % n, (k * 7) % n, double(k % 5));
+		b.add((k * 3) % n, k % n, 1.0);
+	};
+	
+	auto one = math::assemble(n, n, 10 * n, f, 1).csr(1);
+	auto many = math::assemble(n, n, 10 * n, f, 4).csr(4);
+	
+	if (!same(one, many)) {
+		std::cout << "assemble " << n << "x" << n << ": differs between 1 and 4 threads" << std::endl;
+		return false;
+	}
+	
+	return true;
+}
+
+int main(int argc, const char * argv[])
+{
+	bool ok = true;
+	
+	try {
+		ok = check<double>("double", 7, 11, 12) && ok;
+		ok = check<double>("double", 40, 30, 200) && ok;
+		ok = check<double>("double", 2000, 1500, 20000) && ok;
+		ok = check<std::complex<double>>("complex", 40, 30, 200) && ok;
+		ok = check<std::complex<double>>("complex", 1500, 2000, 20000) && ok;
+		ok = check_assemble(3000) && ok;
+	} catch (std::exception const & e) {
+		std::cout << e.what() << std::endl;
+		ok = false;
+	}
+	
+	return ok ? 0 : 1;
+}
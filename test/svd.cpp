@@ -0,0 +1,86 @@
+//
+//  svd.cpp
+//  math tests
+//
+//  Created by Patrick Sauter on 10/19/26.
+//  Copyright (c) 2026 Patrick Sauter. All rights reserved.
+//
+
+// rank deficient fixed size matrices go through one sided jacobi, where a column that is numerically zero but not
+// exactly zero used to keep the sweeps from ever settling.  each is checked against the same matrix as a dmatrix,
+// which goes through golub-kahan, and for U S V^H = A with orthonormal U and V.
+
+#include <cmath>
+#include <complex>
+#include <iostream>
+#include <algorithm>
+
+#include "matrix.h"
+#include "dmatrix.h"
+#include "svd.h"
+
+template <typename T, std::size_t N, std::size_t M>
+bool check(char const * name, math::matrix<T,N,M> const & a, std::size_t rank) {
+	constexpr std::size_t K = std::min(N, M);
+	
+	auto f = math::svd(a);
+	auto g = math::svd(math::dmatrix<T>(a));
+	
+	double error = 0;
+	
+	for (std::size_t l = 0; l < K; ++l)
+		error = std::max(error, double(std::abs(f.values()[l] - g.values()[l])));
+	
+	for (std::size_t i = 0; i < N; ++i) {
+		for (std::size_t j = 0; j < M; ++j) {
+			T s = 0;
+			
+			for (std::size_t l = 0; l < K; ++l)
+				s += f.u().data()[i * K + l] * f.values()[l] * math::detail::conjugate(f.v().data()[j * K + l]);
+			
+			error = std::max(error, double(std::abs(s - a.data()[i * M + j])));
+		}
+	}
+	
+	for (std::size_t p = 0; p < K; ++p) {
+		for (std::size_t q = 0; q < K; ++q) {
+			T u = 0, v = 0;
+			
+			for (std::size_t i = 0; i < N; ++i)
+				u += math::detail::conjugate(f.u().data()[i * K + p]) * f.u().data()[i * K + q];
+			for (std::size_t j = 0; j < M; ++j)
+				v += math::detail::conjugate(f.v().data()[j * K + p]) * f.v().data()[j * K + q];
+			
+			error = std::max({ error, double(std::abs(u - T(p == q))), double(std::abs(v - T(p == q))) });
+		}
+	}
+	
+	if (error > 1e-12 || f.rank() != rank) {
+		std::cout << name << ": rank " << f.rank() << " (expected " << rank << "), error " << error << std::endl;
+		return false;
+	}
+	
+	return true;
+}
+
+int main(int argc, const char * argv[])
+{
+	typedef std::complex<double> C;
+	
+	bool ok = true;
+	
+	try {
+		ok = check("3x3 rank 2", math::matrix<double,3,3>{ 1, 2, 3, 2, 4, 6, 1, 0, 1 }, 2) && ok;
+		ok = check("3x3 rank 2, i + j + 1", math::matrix<double,3,3>{ 1, 2, 3, 2, 3, 4, 3, 4, 5 }, 2) && ok;
+		ok = check("4x3 rank 1", math::matrix<double,4,3>{ 1, 1, 1, 2, 2, 2, 3, 3, 3, 4, 4, 4 }, 1) && ok;
+		ok = check("2x4 rank 1", math::matrix<double,2,4>{ 1, 2, 3, 4, 0.5, 1, 1.5, 2 }, 1) && ok;
+		ok = check("4x4 rank 2", math::matrix<double,4,4>{ 1, 2, 3, 4, 2, 3, 4, 5, 3, 4, 5, 6, 4, 5, 6, 7 }, 2) && ok;
+		ok = check("3x3 complex rank 2", math::matrix<C,3,3>{ C(1, 1), C(2, 0), C(0, 1), C(2, 2), C(4, 0), C(0, 2), C(1, 0), C(0, 1), C(1, 1) }, 2) && ok;
+		ok = check("3x3 zero", math::matrix<double,3,3>(0.0), 0) && ok;
+	} catch (std::exception const & e) {
+		std::cout << e.what() << std::endl;
+		ok = false;
+	}
+	
+	return ok ? 0 : 1;
+}
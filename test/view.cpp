@@ -0,0 +1,80 @@
+//
+//  view.cpp
+//  math tests
+//
+//  Created by Patrick Sauter on 10/19/26.
+//  Copyright (c) 2026 Patrick Sauter. All rights reserved.
+//
+
+// assignments whose right side reads, through a view, the storage being written in another order.  each has to come
+// out as if the right side had been worked out first, which is checked against the same assignment from a copy.
+
+#include <cmath>
+#include <iostream>
+#include <algorithm>
+
+#include "matrix.h"
+#include "dmatrix.h"
+#include "view.h"
+
+math::dmatrix<double> numbered(std::size_t rows, std::size_t cols) {
+	math::dmatrix<double> a(rows, cols);
+	
+	for (std::size_t i = 0; i < a.size(); ++i)
+		a[i] = double(i) + 1;
+	
+	return a;
+}
+
+// f(a, b) assigns to a from b, first with b a copy of a and then with b being a itself
+template <typename Function>
+bool check(char const * name, math::dmatrix<double> a, Function f) {
+	auto expected = a;
+	auto const copy = a;
+	
+	f(expected, copy);
+	f(a, a);
+	
+	if (a.rows() != expected.rows() || a.cols() != expected.cols() || !std::equal(a.begin(), a.end(), expected.begin())) {
+		std::cout << name << ": wrong entries" << std::endl;
+		return false;
+	}
+	
+	return true;
+}
+
+int main(int argc, const char * argv[])
+{
+	bool ok = true;
+	
+	try {
+		typedef math::dmatrix<double> D;
+		
+		ok = check("A = A^T", numbered(4, 4), [](D & a, D const & b) { a = transpose_view(b); }) && ok;
+		ok = check("A = A^T, 3x5", numbered(3, 5), [](D & a, D const & b) { a = transpose_view(b); }) && ok;
+		ok = check("A = A^T, 300x300", numbered(300, 300), [](D & a, D const & b) { a = transpose_view(b); }) && ok;
+		ok = check("A = 2 A + A^T", numbered(5, 5), [](D & a, D const & b) { a = b * 2.0 + transpose_view(b); }) && ok;
+		ok = check("A += A^T", numbered(6, 6), [](D & a, D const & b) { a += transpose_view(b); }) && ok;
+		ok = check("A -= A^T, 200x200", numbered(200, 200), [](D & a, D const & b) { a -= transpose_view(b); }) && ok;
+		ok = check("view(A) = A^T", numbered(5, 5), [](D & a, D const & b) { view(a) = transpose_view(b); }) && ok;
+		ok = check("shifted blocks", numbered(5, 6), [](D & a, D const & b) { block(a, 1, 0, 4, 4) = block(b, 0, 1, 4, 4); }) && ok;
+		ok = check("block += its transpose", numbered(6, 6), [](D & a, D const & b) { block(a, 1, 1, 4, 4) += block(b, 1, 1, 4, 4).transpose(); }) && ok;
+		ok = check("diagonal = first row", numbered(4, 4), [](D & a, D const & b) { diagonal(a) = row_slice(b, 0, 1).transpose(); }) && ok;
+		ok = check("interleaved columns", numbered(4, 6), [](D & a, D const & b) { col_slice(a, 0, 3, 2) = col_slice(b, 1, 3, 2); }) && ok;
+		
+		// fixed size storage under the view
+		math::matrix<double,3,3> m{ 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+		
+		view(m) = transpose_view(m);
+		
+		if (m != math::matrix<double,3,3>{ 1, 4, 7, 2, 5, 8, 3, 6, 9 }) {
+			std::cout << "fixed size view(A) = A^T: wrong entries" << std::endl;
+			ok = false;
+		}
+	} catch (std::exception const & e) {
+		std::cout << e.what() << std::endl;
+		ok = false;
+	}
+	
+	return ok ? 0 : 1;
+}